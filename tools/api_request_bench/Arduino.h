@@ -0,0 +1,37 @@
+#ifndef API_REQUEST_BENCH_ARDUINO_H
+#define API_REQUEST_BENCH_ARDUINO_H
+
+// Just enough of the Arduino core to build api_request.cpp on the host
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+typedef uint8_t byte;
+
+#define PROGMEM
+#define pgm_read_word(address) (*(const uint16_t*)(address))
+
+class String
+{
+    public:
+        String(const char* text = "") : mText(text) {}
+
+        const char* c_str() const { return mText.c_str(); }
+        unsigned int length() const { return mText.size(); }
+
+        int indexOf(const char* text) const
+        {
+            std::string::size_type position = mText.find(text);
+            return (position == std::string::npos) ? -1 : (int)position;
+        }
+
+        String substring(unsigned int start) const { return String(mText.c_str() + ((start < mText.size()) ? start : mText.size())); }
+        long toInt() const { return atol(mText.c_str()); }
+
+    private:
+        std::string mText;
+};
+
+#endif
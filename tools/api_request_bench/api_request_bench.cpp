@@ -0,0 +1,301 @@
+/*
+**-----------------------------------------------------------------------------
+** Host tests and microbenchmark of ApiRequest (wled00/api_request.cpp), the
+** single pass parser of the HTTP API.  The tests check that every key of the
+** table is found with its value, so the key codes are still sorted, and the
+** parsing rules handleSet relies on.  The benchmark then compares the lookups
+** handleSet makes with ApiRequest against the indexOf scan per key (and the
+** substring per number) it used to make.
+**
+** Build and run with ./run.sh [iterations], it exits non-zero if a test fails.
+**-----------------------------------------------------------------------------
+*/
+
+#include "wled.h"
+
+#include <chrono>
+#include <stdio.h>
+
+namespace
+{
+    // Indexed by ApiKey
+    const char* KEY_NAMES[API_NUM_KEYS] =
+    {
+        "A",  "AX", "B",  "B2", "C2", "C3", "CL", "CT", "CY", "G",  "G2", "H2", "HU", "IN", "K",  "K2", "LO",
+        "LX", "LY", "M",  "NB", "ND", "NF", "NL", "NM", "NN", "NT", "OL", "P1", "P2", "PL", "PS", "PT", "R",
+        "R2", "RB", "RD", "RN", "SA", "SC", "SN", "SR", "ST", "T",  "TT", "U0", "U1", "W",  "W2"
+    };
+
+    // What handleSet searched for before ApiRequest, in its order.  Keys
+    // ending in '=' were read as numbers, the others only tested.
+    const char* OLD_SEARCH_KEYS[] =
+    {
+        "P1=", "P2=", "CY=", "PT=", "PS=", "PL=", "&A=", "&R=", "&G=", "&B=", "&W=", "R2=", "G2=", "B2=",
+        "W2=", "LX=", "LY=", "HU=", "SA=", "H2",  "&K=", "K2",  "CL=", "C2=", "C3=", "SR",  "SC",  "OL=",
+        "&M=", "SN=", "RN=", "RD=", "&T=", "&ND", "NL=", "NT=", "NF=", "AX=", "TT=", "ST=", "CT=", "LO=",
+        "RB",  "NM=", "NB=", "U0=", "U1=", "IN",  "&NN"
+    };
+    const size_t NUM_OLD_SEARCH_KEYS = sizeof(OLD_SEARCH_KEYS) / sizeof(OLD_SEARCH_KEYS[0]);
+
+    int sNumFailures = 0;
+
+    #define CHECK(condition) check((condition), #condition, __LINE__)
+
+    void check(bool condition, const char* text, int line)
+    {
+        if (!condition)
+        {
+            printf("FAILED line %d: %s\n", line, text);
+            ++sNumFailures;
+        }
+    }
+
+    int findKeyName(const char* name, size_t length)
+    {
+        for (int key = 0; key < API_NUM_KEYS; ++key)
+        {
+            if (strlen(KEY_NAMES[key]) == length && 0 == strncmp(KEY_NAMES[key], name, length))
+            {
+                return key;
+            }
+        }
+
+        return -1;
+    }
+
+    // A long macro URL: every key once and the first 23 keys again, which
+    // handleSet ignores, 72 parameters
+    std::string makeBenchRequest()
+    {
+        std::string request = "win";
+        for (int key = 0; key < API_NUM_KEYS; ++key)
+        {
+            request += "&";
+            request += KEY_NAMES[key];
+            request += "=";
+            request += std::to_string(100 + key);
+        }
+
+        for (int repeat = 0; repeat < 23; ++repeat)
+        {
+            request += "&";
+            request += KEY_NAMES[repeat];
+            request += "=1";
+        }
+
+        return request;
+    }
+}
+
+/*
+** ============================================================================
+** Every key of the table is found with its own value
+** ============================================================================
+*/
+void testEveryKey()
+{
+    std::string text = "win";
+    for (int key = 0; key < API_NUM_KEYS; ++key)
+    {
+        text += "&" + std::string(KEY_NAMES[key]) + "=" + std::to_string(key + 1);
+    }
+
+    String request(text.c_str());
+    ApiRequest api(request);
+    for (int key = 0; key < API_NUM_KEYS; ++key)
+    {
+        CHECK(api.has((ApiKey)key));
+        CHECK(api.getNumber((ApiKey)key) == key + 1);
+    }
+
+    String empty("win");
+    ApiRequest emptyApi(empty);
+    for (int key = 0; key < API_NUM_KEYS; ++key)
+    {
+        CHECK(!emptyApi.has((ApiKey)key));
+        CHECK(emptyApi.getNumber((ApiKey)key) == 0);
+    }
+}
+
+/*
+** ============================================================================
+** The parsing rules handleSet relies on
+** ============================================================================
+*/
+void testParsing()
+{
+    // The first occurrence counts
+    String repeated("win&A=1&A=2");
+    CHECK(ApiRequest(repeated).getNumber(API_KEY_A) == 1);
+
+    // Flags have no value
+    String flags("win&RB&SC&A=5");
+    ApiRequest flagsApi(flags);
+    CHECK(flagsApi.has(API_KEY_RB));
+    CHECK(flagsApi.getFirstChar(API_KEY_RB) == 0);
+    CHECK(flagsApi.has(API_KEY_SC));
+    CHECK(flagsApi.getNumber(API_KEY_A) == 5);
+
+    // Longer, lower case and empty keys are not keys
+    String unknown("win&AXX=5&a=3&=4&TTT");
+    ApiRequest unknownApi(unknown);
+    CHECK(!unknownApi.has(API_KEY_AX));
+    CHECK(!unknownApi.has(API_KEY_A));
+    CHECK(!unknownApi.has(API_KEY_TT));
+
+    // '?' separates too, an empty value reads as 0
+    String question("win?A=7&T=");
+    ApiRequest questionApi(question);
+    CHECK(questionApi.getNumber(API_KEY_A) == 7);
+    CHECK(questionApi.has(API_KEY_T));
+    CHECK(questionApi.getNumber(API_KEY_T) == 0);
+
+    // Values are cut at the next parameter and truncated to the buffer
+    String color("win&CL=h123456789ABCDEF&C2=hFF0000");
+    ApiRequest colorApi(color);
+    char value[8];
+    colorApi.getValue(API_KEY_CL, value, sizeof(value));
+    CHECK(0 == strcmp(value, "h123456"));
+    colorApi.getValue(API_KEY_C2, value, sizeof(value));
+    CHECK(0 == strcmp(value, "hFF0000"));
+    CHECK(colorApi.getFirstChar(API_KEY_CL) == 'h');
+}
+
+/*
+** ============================================================================
+** Setting, stepping and adding to a byte value
+** ============================================================================
+*/
+void testUpdateByte()
+{
+    byte value = 10;
+    String plain("win&A=200");
+    CHECK(ApiRequest(plain).updateByte(API_KEY_A, &value));
+    CHECK(value == 200);
+
+    value = 255;
+    String stepUp("win&A=~");
+    CHECK(ApiRequest(stepUp).updateByte(API_KEY_A, &value));
+    CHECK(value == 0);
+
+    value = 3;
+    String stepDown("win&PL=~-");
+    CHECK(ApiRequest(stepDown).updateByte(API_KEY_PL, &value, 3, 9));
+    CHECK(value == 9);
+
+    value = 250;
+    String add("win&A=~10");
+    CHECK(ApiRequest(add).updateByte(API_KEY_A, &value));
+    CHECK(value == 255);
+
+    value = 5;
+    String subtract("win&A=~-10");
+    CHECK(ApiRequest(subtract).updateByte(API_KEY_A, &value));
+    CHECK(value == 0);
+
+    value = 42;
+    String missing("win&B=1");
+    CHECK(!ApiRequest(missing).updateByte(API_KEY_A, &value));
+    CHECK(value == 42);
+}
+
+/*
+** ============================================================================
+** The old and the new lookups read the same numbers from the bench request
+** ============================================================================
+*/
+void testSameAsIndexOf(const String& request)
+{
+    ApiRequest api(request);
+    for (size_t i = 0; i < NUM_OLD_SEARCH_KEYS; ++i)
+    {
+        const char* searchKey = OLD_SEARCH_KEYS[i];
+        size_t length = strlen(searchKey);
+        if (searchKey[length - 1] != '=')
+        {
+            continue;
+        }
+
+        const char* name = (searchKey[0] == '&') ? searchKey + 1 : searchKey;
+        int key = findKeyName(name, strlen(name) - 1);
+        CHECK(key >= 0);
+
+        int position = request.indexOf(searchKey);
+        CHECK(position > 0);
+        CHECK(request.substring(position + 3).toInt() == api.getNumber((ApiKey)key));
+    }
+}
+
+/*
+** ============================================================================
+** Times both lookups over the bench request
+** ============================================================================
+*/
+void runBenchmark(const String& request, long iterations)
+{
+    typedef std::chrono::steady_clock Clock;
+    volatile long sink = 0;
+
+    Clock::time_point start = Clock::now();
+    for (long iteration = 0; iteration < iterations; ++iteration)
+    {
+        long sum = 0;
+        for (size_t i = 0; i < NUM_OLD_SEARCH_KEYS; ++i)
+        {
+            const char* searchKey = OLD_SEARCH_KEYS[i];
+            int position = request.indexOf(searchKey);
+            if (position > 0)
+            {
+                sum += (searchKey[strlen(searchKey) - 1] == '=') ? request.substring(position + 3).toInt() : 1;
+            }
+        }
+        sink = sink + sum;
+    }
+    double indexOfMicros = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / iterations;
+
+    start = Clock::now();
+    for (long iteration = 0; iteration < iterations; ++iteration)
+    {
+        long sum = 0;
+        ApiRequest api(request);
+        for (int key = 0; key < API_NUM_KEYS; ++key)
+        {
+            if (api.has((ApiKey)key))
+            {
+                sum += api.getNumber((ApiKey)key);
+            }
+        }
+        sink = sink + sum;
+    }
+    double apiRequestMicros = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / iterations;
+
+    printf("request of %u characters, %ld iterations\n", request.length(), iterations);
+    printf("  indexOf per key:  %8.3f us per request\n", indexOfMicros);
+    printf("  ApiRequest:       %8.3f us per request\n", apiRequestMicros);
+}
+
+int main(int argc, char** argv)
+{
+    long iterations = (argc > 1) ? atol(argv[1]) : 100000;
+    if (iterations < 1)
+    {
+        iterations = 1;
+    }
+
+    std::string benchText = makeBenchRequest();
+    String benchRequest(benchText.c_str());
+
+    testEveryKey();
+    testParsing();
+    testUpdateByte();
+    testSameAsIndexOf(benchRequest);
+    if (sNumFailures > 0)
+    {
+        printf("%d checks FAILED\n", sNumFailures);
+        return 1;
+    }
+    printf("all checks passed\n");
+
+    runBenchmark(benchRequest, iterations);
+    return 0;
+}
@@ -0,0 +1,13 @@
+#!/bin/sh
+# Builds and runs the ApiRequest tests and benchmark on the host.
+# api_request.cpp is copied next to the stand-in wled.h so its #include "wled.h" finds that one.
+set -e
+HERE=$(cd "$(dirname "$0")" && pwd)
+WLED00="$HERE/../../wled00"
+BUILD=$(mktemp -d)
+trap 'rm -rf "$BUILD"' EXIT
+
+cp "$WLED00/api_request.cpp" "$BUILD/"
+${CXX:-g++} -std=gnu++11 -O2 -Wall -I"$HERE" -I"$WLED00" \
+    "$BUILD/api_request.cpp" "$HERE/api_request_bench.cpp" -o "$BUILD/api_request_bench"
+"$BUILD/api_request_bench" "$@"
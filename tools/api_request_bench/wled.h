@@ -0,0 +1,9 @@
+#ifndef API_REQUEST_BENCH_WLED_H
+#define API_REQUEST_BENCH_WLED_H
+
+// Stands in for wled.h, api_request.cpp only needs its own header
+
+#include "Arduino.h"
+#include "api_request.h"
+
+#endif
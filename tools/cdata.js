@@ -21,6 +21,11 @@ const packageJson = require("../package.json");
 /**
  *
  */
+// Short hash of the content, the firmware sends it as the ETag of the array
+function buildHash(buffer) {
+  return crypto.createHash("sha1").update(buffer).digest("hex").substring(0, 8);
+}
+
 function hexdump(buffer) {
   let lines = [];
 
@@ -42,6 +47,7 @@ function hexdump(buffer) {
 
 const inliner = require("inliner");
 const zlib = require("zlib");
+const crypto = require("crypto");
 
 function strReplace(str, search, replacement) {
   return str.split(search).join(replacement);
@@ -84,6 +90,7 @@ function writeHtmlGzipped(sourceFile, resultFile) {
 
       console.info("Compressed " + result.length + " bytes");
       const array = hexdump(result);
+      const etag = buildHash(result);
       const src = `/*
  * Binary array for the Web UI.
  * gzip is used for smaller size and improved speeds.
@@ -94,6 +101,7 @@ function writeHtmlGzipped(sourceFile, resultFile) {
  
 // Autogenerated from ${sourceFile}, do not edit!!
 const uint16_t PAGE_index_L = ${result.length};
+const char PAGE_index_etag[] PROGMEM = "${etag}";
 const uint8_t PAGE_index[] PROGMEM = {
 ${array}
 };
@@ -147,6 +155,7 @@ const char ${s.name}[] PROGMEM = R"${s.prepend || ""}${filter(str, s.filter)}${
     const chunk = `
 // Autogenerated from ${srcDir}/${s.file}, do not edit!!
 const uint16_t ${s.name}_length = ${result.length};
+const char ${s.name}_etag[] PROGMEM = "${buildHash(buf)}";
 const uint8_t ${s.name}[] PROGMEM = {
 ${result}
 };
@@ -3820,77 +3820,13 @@ uint16_t WS2812FX::mode_mdr1(void) {
 
 uint16_t WS2812FX::mode_test_color_set()
 {
-  Serial.printf("MDR DEBUG: Testing color set %d\n", SEGMENT.colorset);
+  const ColorSet* colorSet = ColorSetStore::get().getColorSet(SEGMENT.colorset);
+  if (colorSet == nullptr) return mode_static(); //"Default" uses the segment color
+
+  uint16_t offset = SEGMENT.intensity;
   for (uint16_t i = 0; i < SEGLEN; i++)
   {
-    uint32_t color = 0;
-    if (SEGMENT.colorset == 1) // Philips
-    {
-      uint16_t colorIndex = i % 6;
-      switch (colorIndex)
-      {
-        case 0:
-        {
-          // color = RED;
-          color = 0x00FF0000;
-          break;
-        } 
-        case 1:
-        {
-          // color = ORANGE;
-          color = 0x00FF0F00;
-          break;
-        }
-        case 2: 
-        {
-          // color = YELLOW; // Too Green
-          color = 0x00FF4800;
-          break;
-        }
-        case 3: 
-        {
-          // color = GREEN;
-          color = 0x0003D000;
-          break;
-        }
-        case 4: 
-        {
-          // color = BLUE;
-          color = 0x000200FF;
-          break;
-        }
-        case 5:
-        {
-          // color = PURPLE;
-          color = 0x00FF0085;
-          break;
-        }
-      }
-    }
-    else if (SEGMENT.colorset == 2) // Christmas
-    {
-      if (i % 2 == 0)
-      {
-        color = GREEN;
-      }
-      else
-      {
-        color = RED;
-      }
-      
-    }
-    else if (SEGMENT.colorset == 3) // CandyCane
-    {
-      if (i % 2 == 0)
-      {
-        color = RED;
-      }
-      else
-      {
-        color = WHITE;
-      }
-    }
-    setPixelColor(i, color);
+    setPixelColor(i, colorSet->getColor(i, offset));
   }
   return FRAMETIME;
 }
\ No newline at end of file
@@ -782,8 +782,4 @@ const char JSON_palette_names[] PROGMEM = R"=====([
 "Aurora","Atlantica","C9 2","C9 New","Temperature","Philips 6 Lights"
 ])=====";
 
-const char JSON_colorset_names[] PROGMEM = R"=====([
-"Default","Philips 6 Colors","Christmas","Candy Cane"
-])=====";
-
 #endif
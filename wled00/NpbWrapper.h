@@ -173,6 +173,16 @@
  #define PIXELFEATURE4 NeoGrbwFeature
 #endif
 
+//number of separate data pins the LEDs can be driven on. On ESP32 every output gets its own RMT channel
+//so all outputs transmit at the same time. Clocked and analog LEDs only support a single output.
+#ifndef WLED_MAX_PIXEL_OUTPUTS
+ #if defined(ARDUINO_ARCH_ESP32) && !defined(USE_APA102) && !defined(USE_WS2801) && !defined(USE_LPD8806) && !defined(USE_TM1814) && !defined(USE_P9813) && !defined(WLED_USE_ANALOG_LEDS)
+  #define WLED_MAX_PIXEL_OUTPUTS 8
+ #else
+  #define WLED_MAX_PIXEL_OUTPUTS 1
+ #endif
+#endif
+
 
 #include <NeoPixelBrightnessBus.h>
 #include "const.h"
@@ -185,6 +195,74 @@ enum NeoPixelType
   NeoPixelType_End  = 3
 };
 
+#if WLED_MAX_PIXEL_OUTPUTS > 1
+// Outputs after the first need a different NeoPixelBus method type per RMT channel,
+// so their bus is kept behind this small interface
+class PixelOutputBus
+{
+public:
+  virtual ~PixelOutputBus() {}
+  virtual void Begin() = 0;
+  virtual void Show() = 0;
+  virtual bool CanShow() = 0;
+  virtual void SetPixelColor(uint16_t indexPixel, RgbwColor c) = 0;
+  virtual RgbwColor GetPixelColor(uint16_t indexPixel) const = 0;
+  virtual void SetBrightness(byte b) = 0;
+  virtual uint8_t* Pixels() = 0;
+};
+
+template<class T_METHOD> class RgbPixelOutputBus : public PixelOutputBus
+{
+public:
+  RgbPixelOutputBus(uint16_t countPixels, uint8_t pin) : _bus(countPixels, pin) {}
+  void Begin() { _bus.Begin(); }
+  void Show() { _bus.Show(); }
+  bool CanShow() { return _bus.CanShow(); }
+  void SetPixelColor(uint16_t indexPixel, RgbwColor c) { _bus.SetPixelColor(indexPixel, RgbColor(c.R,c.G,c.B)); }
+  RgbwColor GetPixelColor(uint16_t indexPixel) const { return _bus.GetPixelColor(indexPixel); }
+  void SetBrightness(byte b) { _bus.SetBrightness(b); }
+  uint8_t* Pixels() { return _bus.Pixels(); }
+private:
+  NeoPixelBrightnessBus<PIXELFEATURE3,T_METHOD> _bus;
+};
+
+template<class T_METHOD> class RgbwPixelOutputBus : public PixelOutputBus
+{
+public:
+  RgbwPixelOutputBus(uint16_t countPixels, uint8_t pin) : _bus(countPixels, pin) {}
+  void Begin() { _bus.Begin(); }
+  void Show() { _bus.Show(); }
+  bool CanShow() { return _bus.CanShow(); }
+  void SetPixelColor(uint16_t indexPixel, RgbwColor c) { _bus.SetPixelColor(indexPixel, c); }
+  RgbwColor GetPixelColor(uint16_t indexPixel) const { return _bus.GetPixelColor(indexPixel); }
+  void SetBrightness(byte b) { _bus.SetBrightness(b); }
+  uint8_t* Pixels() { return _bus.Pixels(); }
+private:
+  NeoPixelBrightnessBus<PIXELFEATURE4,T_METHOD> _bus;
+};
+
+template<class T_METHOD> PixelOutputBus* CreatePixelOutputBus(NeoPixelType type, uint16_t countPixels, uint8_t pin)
+{
+  if (type == NeoPixelType_Grbw) return new RgbwPixelOutputBus<T_METHOD>(countPixels, pin);
+  return new RgbPixelOutputBus<T_METHOD>(countPixels, pin);
+}
+
+inline PixelOutputBus* CreatePixelOutputBus(NeoPixelType type, uint16_t countPixels, uint8_t pin, uint8_t output)
+{
+  switch (output)
+  {
+    case 1: return CreatePixelOutputBus<NeoEsp32Rmt1Ws2812xMethod>(type, countPixels, pin);
+    case 2: return CreatePixelOutputBus<NeoEsp32Rmt2Ws2812xMethod>(type, countPixels, pin);
+    case 3: return CreatePixelOutputBus<NeoEsp32Rmt3Ws2812xMethod>(type, countPixels, pin);
+    case 4: return CreatePixelOutputBus<NeoEsp32Rmt4Ws2812xMethod>(type, countPixels, pin);
+    case 5: return CreatePixelOutputBus<NeoEsp32Rmt5Ws2812xMethod>(type, countPixels, pin);
+    case 6: return CreatePixelOutputBus<NeoEsp32Rmt6Ws2812xMethod>(type, countPixels, pin);
+    case 7: return CreatePixelOutputBus<NeoEsp32Rmt7Ws2812xMethod>(type, countPixels, pin);
+  }
+  return NULL;
+}
+#endif
+
 class NeoPixelWrapper
 {
 public:
@@ -192,6 +270,9 @@ public:
     // initialize each member to null
     _pGrb(NULL),
     _pGrbw(NULL),
+  #if WLED_MAX_PIXEL_OUTPUTS > 1
+    _pOutput(NULL),
+  #endif
     _type(NeoPixelType_None)
   {
 
@@ -202,18 +283,28 @@ public:
     cleanup();
   }
 
-  void Begin(NeoPixelType type, uint16_t countPixels)
+  // output selects the hardware channel used to drive the pin, each output must use a different one
+  void Begin(NeoPixelType type, uint16_t countPixels, uint8_t pin = LEDPIN, uint8_t output = 0)
   {
     cleanup();
     _type = type;
 
+    #if WLED_MAX_PIXEL_OUTPUTS > 1
+    if (output > 0)
+    {
+      _pOutput = CreatePixelOutputBus(type, countPixels, pin, output);
+      if (_pOutput != NULL) _pOutput->Begin();
+      return;
+    }
+    #endif
+
     switch (_type)
     {
       case NeoPixelType_Grb:
       #if defined(USE_APA102) || defined(USE_WS2801) || defined(USE_LPD8806) || defined(USE_P9813)
         _pGrb = new NeoPixelBrightnessBus<PIXELFEATURE3,PIXELMETHOD>(countPixels, CLKPIN, DATAPIN);
       #else
-        _pGrb = new NeoPixelBrightnessBus<PIXELFEATURE3,PIXELMETHOD>(countPixels, LEDPIN);
+        _pGrb = new NeoPixelBrightnessBus<PIXELFEATURE3,PIXELMETHOD>(countPixels, pin);
       #endif
         _pGrb->Begin();
       break;
@@ -222,7 +313,7 @@ public:
       #if defined(USE_APA102) || defined(USE_WS2801) || defined(USE_LPD8806) || defined(USE_P9813)
         _pGrbw = new NeoPixelBrightnessBus<PIXELFEATURE4,PIXELMETHOD>(countPixels, CLKPIN, DATAPIN);
       #else
-        _pGrbw = new NeoPixelBrightnessBus<PIXELFEATURE4,PIXELMETHOD>(countPixels, LEDPIN);
+        _pGrbw = new NeoPixelBrightnessBus<PIXELFEATURE4,PIXELMETHOD>(countPixels, pin);
       #endif
         _pGrbw->Begin();
       break;
@@ -296,6 +387,9 @@ public:
 
   void Show()
   {
+    #if WLED_MAX_PIXEL_OUTPUTS > 1
+    if (_pOutput != NULL) { _pOutput->Show(); return; }
+    #endif
     switch (_type)
     {
       case NeoPixelType_Grb:  _pGrb->Show();  break;
@@ -311,6 +405,9 @@ public:
    */
   bool CanShow()
   {
+    #if WLED_MAX_PIXEL_OUTPUTS > 1
+    if (_pOutput != NULL) return _pOutput->CanShow();
+    #endif
     switch (_type)
     {
       case NeoPixelType_Grb:  return _pGrb->CanShow();
@@ -340,6 +437,10 @@ public:
     }
     col.W = c.W;
 
+    #if WLED_MAX_PIXEL_OUTPUTS > 1
+    if (_pOutput != NULL) { _pOutput->SetPixelColor(indexPixel, col); return; }
+    #endif
+
     switch (_type) {
       case NeoPixelType_Grb: {
         _pGrb->SetPixelColor(indexPixel, RgbColor(col.R,col.G,col.B));
@@ -358,6 +459,9 @@ public:
 
   void SetBrightness(byte b)
   {
+    #if WLED_MAX_PIXEL_OUTPUTS > 1
+    if (_pOutput != NULL) { _pOutput->SetBrightness(b); return; }
+    #endif
     switch (_type) {
       case NeoPixelType_Grb: _pGrb->SetBrightness(b);   break;
       case NeoPixelType_Grbw:_pGrbw->SetBrightness(b);  break;
@@ -374,6 +478,9 @@ public:
 
   RgbwColor GetPixelColorRaw(uint16_t indexPixel) const
   {
+    #if WLED_MAX_PIXEL_OUTPUTS > 1
+    if (_pOutput != NULL) return _pOutput->GetPixelColor(indexPixel);
+    #endif
     switch (_type) {
       case NeoPixelType_Grb:  return _pGrb->GetPixelColor(indexPixel);  break;
       case NeoPixelType_Grbw: return _pGrbw->GetPixelColor(indexPixel); break;
@@ -385,11 +492,7 @@ public:
   // here needs to be unique, thus GetPixeColorRgbw
   uint32_t GetPixelColorRgbw(uint16_t indexPixel) const
   {
-    RgbwColor col(0,0,0,0);
-    switch (_type) {
-      case NeoPixelType_Grb:  col = _pGrb->GetPixelColor(indexPixel);  break;
-      case NeoPixelType_Grbw: col = _pGrbw->GetPixelColor(indexPixel); break;
-    }
+    RgbwColor col = GetPixelColorRaw(indexPixel);
 
     uint8_t co = _colorOrder;
     #ifdef COLOR_ORDER_OVERRIDE
@@ -411,6 +514,9 @@ public:
 
   uint8_t* GetPixels(void)
   {
+    #if WLED_MAX_PIXEL_OUTPUTS > 1
+    if (_pOutput != NULL) return _pOutput->Pixels();
+    #endif
     switch (_type) {
       case NeoPixelType_Grb:  return _pGrb->Pixels();  break;
       case NeoPixelType_Grbw: return _pGrbw->Pixels(); break;
@@ -425,11 +531,17 @@ private:
   // have a member for every possible type
   NeoPixelBrightnessBus<PIXELFEATURE3,PIXELMETHOD>*  _pGrb;
   NeoPixelBrightnessBus<PIXELFEATURE4,PIXELMETHOD>* _pGrbw;
+  #if WLED_MAX_PIXEL_OUTPUTS > 1
+  PixelOutputBus* _pOutput;
+  #endif
 
   byte _colorOrder = 0;
 
   void cleanup()
   {
+    #if WLED_MAX_PIXEL_OUTPUTS > 1
+    delete _pOutput; _pOutput = NULL;
+    #endif
     switch (_type) {
       case NeoPixelType_Grb:  delete _pGrb ; _pGrb  = NULL; break;
       case NeoPixelType_Grbw: delete _pGrbw; _pGrbw = NULL; break;
@@ -0,0 +1,213 @@
+#include "wled.h"
+
+namespace
+{
+    #define API_KEY_CODE(first, second) (((uint16_t)(first) << 8) | (uint8_t)(second))
+
+    // Indexed by ApiKey, so sorted
+    const uint16_t API_KEY_CODES[API_NUM_KEYS] PROGMEM =
+    {
+        API_KEY_CODE('A', 0),   API_KEY_CODE('A', 'X'), API_KEY_CODE('B', 0),   API_KEY_CODE('B', '2'),
+        API_KEY_CODE('C', '2'), API_KEY_CODE('C', '3'), API_KEY_CODE('C', 'L'), API_KEY_CODE('C', 'T'),
+        API_KEY_CODE('C', 'Y'), API_KEY_CODE('G', 0),   API_KEY_CODE('G', '2'), API_KEY_CODE('H', '2'),
+        API_KEY_CODE('H', 'U'), API_KEY_CODE('I', 'N'), API_KEY_CODE('K', 0),   API_KEY_CODE('K', '2'),
+        API_KEY_CODE('L', 'O'), API_KEY_CODE('L', 'X'), API_KEY_CODE('L', 'Y'), API_KEY_CODE('M', 0),
+        API_KEY_CODE('N', 'B'), API_KEY_CODE('N', 'D'), API_KEY_CODE('N', 'F'), API_KEY_CODE('N', 'L'),
+        API_KEY_CODE('N', 'M'), API_KEY_CODE('N', 'N'), API_KEY_CODE('N', 'T'), API_KEY_CODE('O', 'L'),
+        API_KEY_CODE('P', '1'), API_KEY_CODE('P', '2'), API_KEY_CODE('P', 'L'), API_KEY_CODE('P', 'S'),
+        API_KEY_CODE('P', 'T'), API_KEY_CODE('R', 0),   API_KEY_CODE('R', '2'), API_KEY_CODE('R', 'B'),
+        API_KEY_CODE('R', 'D'), API_KEY_CODE('R', 'N'), API_KEY_CODE('S', 'A'), API_KEY_CODE('S', 'C'),
+        API_KEY_CODE('S', 'N'), API_KEY_CODE('S', 'R'), API_KEY_CODE('S', 'T'), API_KEY_CODE('T', 0),
+        API_KEY_CODE('T', 'T'), API_KEY_CODE('U', '0'), API_KEY_CODE('U', '1'), API_KEY_CODE('W', 0),
+        API_KEY_CODE('W', '2')
+    };
+
+    // Long enough for any number and for a color like h12345678
+    const uint8_t MAX_VALUE_LENGTH = 16;
+
+    bool isSeparator(char character)
+    {
+        return character == '&' || character == '?';
+    }
+}
+
+/*
+** ============================================================================
+** Constructor - splits the request into its parameters.  The request has to
+** outlive this object, the values are read from it.
+** ============================================================================
+*/
+ApiRequest::ApiRequest(const String& request)
+    : mRequest( request )
+{
+    memset(mValueOffsets, 0, sizeof(mValueOffsets));
+
+    const char* text = request.c_str();
+    uint16_t length = request.length();
+    uint16_t position = 0;
+    while (position < length)
+    {
+        // Key up to '=' or the end of the parameter
+        uint16_t keyStart = position;
+        while (position < length && text[position] != '=' && !isSeparator(text[position]))
+        {
+            ++position;
+        }
+        uint16_t keyLength = position - keyStart;
+
+        uint16_t valueStart = position;
+        if (position < length && text[position] == '=')
+        {
+            valueStart = ++position;
+        }
+
+        // Skip the value
+        while (position < length && !isSeparator(text[position]))
+        {
+            ++position;
+        }
+
+        int8_t key = findKey(text + keyStart, keyLength);
+        if (key >= 0 && 0 == mValueOffsets[key])
+        {
+            mValueOffsets[key] = valueStart + 1;
+        }
+
+        ++position;
+    }
+}
+
+/*
+** ============================================================================
+** Returns the first character of the key's value, 0 if it has none
+** ============================================================================
+*/
+char ApiRequest::getFirstChar(ApiKey key) const
+{
+    if (!has(key))
+    {
+        return 0;
+    }
+
+    char character = mRequest.c_str()[mValueOffsets[key] - 1];
+    return isSeparator(character) ? 0 : character;
+}
+
+/*
+** ============================================================================
+** Returns the key's value as a number, parsed like String::toInt()
+** ============================================================================
+*/
+long ApiRequest::getNumber(ApiKey key) const
+{
+    char value[MAX_VALUE_LENGTH];
+    getValue(key, value, sizeof(value));
+    return atol(value);
+}
+
+/*
+** ============================================================================
+** Copies the key's value, up to the next parameter, as a C string
+** ============================================================================
+*/
+void ApiRequest::getValue(ApiKey key, char* value, size_t maxLength) const
+{
+    size_t length = 0;
+    if (has(key))
+    {
+        const char* source = mRequest.c_str() + mValueOffsets[key] - 1;
+        while (length + 1 < maxLength && source[length] != 0 && !isSeparator(source[length]))
+        {
+            value[length] = source[length];
+            ++length;
+        }
+    }
+
+    value[length] = 0;
+}
+
+/*
+** ============================================================================
+** Updates a byte value from the key.  A plain number sets it, ~ steps it up
+** (~- down) with wrap around and ~n adds n, clamped to the range.
+**
+**  returns false if the key is not in the request
+** ============================================================================
+*/
+bool ApiRequest::updateByte(ApiKey key, byte* value, byte minValue, byte maxValue) const
+{
+    if (!has(key))
+    {
+        return false;
+    }
+
+    char text[MAX_VALUE_LENGTH];
+    getValue(key, text, sizeof(text));
+
+    if (text[0] != '~')
+    {
+        *value = atol(text);
+        return true;
+    }
+
+    int out = atol(text + 1);
+    if (out == 0)
+    {
+        if (text[1] == '-')
+        {
+            *value = (*value <= minValue) ? maxValue : *value - 1;
+        }
+        else
+        {
+            *value = (*value >= maxValue) ? minValue : *value + 1;
+        }
+    }
+    else
+    {
+        out += *value;
+        if (out > maxValue) out = maxValue;
+        if (out < minValue) out = minValue;
+        *value = out;
+    }
+
+    return true;
+}
+
+/*
+** ============================================================================
+** Looks a key up in the sorted table of key codes
+**
+**  returns the ApiKey or -1 if it is not one
+** ============================================================================
+*/
+int8_t ApiRequest::findKey(const char* key, uint16_t length)
+{
+    if (length < 1 || length > 2)
+    {
+        return -1;
+    }
+
+    uint16_t code = API_KEY_CODE(key[0], (length == 2) ? key[1] : 0);
+    int8_t low = 0;
+    int8_t high = API_NUM_KEYS - 1;
+    while (low <= high)
+    {
+        int8_t middle = (low + high) / 2;
+        uint16_t middleCode = pgm_read_word(&API_KEY_CODES[middle]);
+        if (middleCode == code)
+        {
+            return middle;
+        }
+
+        if (middleCode < code)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle - 1;
+        }
+    }
+
+    return -1;
+}
@@ -0,0 +1,107 @@
+#ifndef API_REQUEST_H
+#define API_REQUEST_H
+
+#include "Arduino.h"
+
+/*
+** The keys of the HTTP API (/win&A=128&T=2...).  Each key is one or two
+** characters and its code is (first << 8) | second, the values here MUST stay
+** in the order of those codes so a key can be found with a binary search.
+*/
+enum ApiKey : uint8_t
+{
+    API_KEY_A = 0,  // brightness
+    API_KEY_AX,     // aux output time
+    API_KEY_B,      // primary blue
+    API_KEY_B2,     // secondary blue
+    API_KEY_C2,     // secondary color, hex or decimal
+    API_KEY_C3,     // third color, hex or decimal
+    API_KEY_CL,     // primary color, hex or decimal
+    API_KEY_CT,     // countdown goal
+    API_KEY_CY,     // preset cycle
+    API_KEY_G,      // primary green
+    API_KEY_G2,     // secondary green
+    API_KEY_H2,     // hue applies to the secondary color
+    API_KEY_HU,     // hue
+    API_KEY_IN,     // internal call, no XML response
+    API_KEY_K,      // white spectrum in kelvin
+    API_KEY_K2,     // kelvin applies to the secondary color
+    API_KEY_LO,     // realtime override
+    API_KEY_LX,     // Loxone primary color
+    API_KEY_LY,     // Loxone secondary color
+    API_KEY_M,      // macro (pre-0.11)
+    API_KEY_NB,     // cronixie backlight
+    API_KEY_ND,     // nightlight with default duration
+    API_KEY_NF,     // nightlight mode
+    API_KEY_NL,     // nightlight
+    API_KEY_NM,     // cronixie countdown mode
+    API_KEY_NN,     // no UDP notification
+    API_KEY_NT,     // nightlight target brightness
+    API_KEY_OL,     // overlay
+    API_KEY_P1,     // first preset of the cycle
+    API_KEY_P2,     // last preset of the cycle
+    API_KEY_PL,     // apply preset
+    API_KEY_PS,     // save preset
+    API_KEY_PT,     // preset cycle time
+    API_KEY_R,      // primary red
+    API_KEY_R2,     // secondary red
+    API_KEY_RB,     // reboot
+    API_KEY_RD,     // receive realtime data
+    API_KEY_RN,     // receive UDP notifications
+    API_KEY_SA,     // saturation
+    API_KEY_SC,     // swap primary and secondary colors
+    API_KEY_SN,     // send UDP notifications
+    API_KEY_SR,     // random color
+    API_KEY_ST,     // time
+    API_KEY_T,      // power
+    API_KEY_TT,     // transition time
+    API_KEY_U0,     // user variable 0
+    API_KEY_U1,     // user variable 1
+    API_KEY_W,      // primary white
+    API_KEY_W2,     // secondary white
+    API_NUM_KEYS
+};
+
+/*
+**-----------------------------------------------------------------------------
+** Splits an HTTP API request into its key/value pairs in one pass, so that
+** handleSet looks each key up in a table instead of searching the whole
+** request string for every key it knows.  A long macro URL is read once
+** rather than once per key.
+**
+** Parameters are separated by '&' (or '?').  A parameter is either KEY=VALUE
+** or just KEY for the flags (RB, SC, IN, NN...).  When a key is given more
+** than once the first one counts, as it always did.  Unknown keys are
+** ignored.
+**-----------------------------------------------------------------------------
+*/
+class ApiRequest
+{
+    public:
+        explicit ApiRequest(const String& request);
+
+        bool has(ApiKey key) const { return 0 != mValueOffsets[key]; }
+
+        // The first character of the value, 0 if there is no value
+        char getFirstChar(ApiKey key) const;
+
+        // The value as a number, 0 if it is not one
+        long getNumber(ApiKey key) const;
+
+        // Copies the value as a C string, truncated to fit
+        void getValue(ApiKey key, char* value, size_t maxLength) const;
+
+        // Sets, or with ~ steps or adds to, a byte value
+        bool updateByte(ApiKey key, byte* value, byte minValue = 0, byte maxValue = 255) const;
+
+    private:
+        static int8_t findKey(const char* key, uint16_t length);
+
+    private:
+        const String&   mRequest;
+
+        // Offset + 1 of each key's value in the request, 0 if the key is not given
+        uint16_t        mValueOffsets[API_NUM_KEYS];
+};
+
+#endif
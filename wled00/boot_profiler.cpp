@@ -0,0 +1,71 @@
+#include "wled.h"
+
+namespace
+{
+    const char* STAGE_NAMES[BOOT_NUM_STAGES] = {
+        "setup_start",
+        "fs_mount",
+        "config",
+        "light_display",
+        "first_light",
+        "usermods",
+        "setup_done",
+        "connected",
+        "interfaces",
+        "services"
+    };
+}
+
+/*
+** ============================================================================
+** Returns the one boot profiler
+** ============================================================================
+*/
+BootProfiler& BootProfiler::get()
+{
+    static BootProfiler sBootProfiler;
+    return sBootProfiler;
+}
+
+/*
+** ============================================================================
+** Constructor
+** ============================================================================
+*/
+BootProfiler::BootProfiler()
+    : mReachedStages( 0 )
+{
+    memset(mStageMillis, 0, sizeof(mStageMillis));
+}
+
+/*
+** ============================================================================
+** Records that the given stage was reached now, unless it was reached before
+** ============================================================================
+*/
+void BootProfiler::mark(BootStage stage)
+{
+    if (stage >= BOOT_NUM_STAGES || isReached(stage))
+    {
+        return;
+    }
+
+    mStageMillis[stage] = millis();
+    mReachedStages |= (1 << stage);
+}
+
+/*
+** ============================================================================
+** Writes when each stage that was reached so far was reached
+** ============================================================================
+*/
+void BootProfiler::serializeToJson(JsonObject root) const
+{
+    for (uint8_t stage = 0; stage < BOOT_NUM_STAGES; ++stage)
+    {
+        if (isReached((BootStage)stage))
+        {
+            root[STAGE_NAMES[stage]] = mStageMillis[stage];
+        }
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef BOOT_PROFILER_H
+#define BOOT_PROFILER_H
+
+#include "Arduino.h"
+
+/*
+** Stages of the boot that are timed by the boot profiler, in the order they are
+** reached.  New stages are added before BOOT_NUM_STAGES and given a name in
+** boot_profiler.cpp.
+*/
+enum BootStage : uint8_t
+{
+    BOOT_STAGE_SETUP_START = 0,
+    BOOT_STAGE_FS_MOUNT,
+    BOOT_STAGE_CONFIG,
+    BOOT_STAGE_LIGHT_DISPLAY,
+    BOOT_STAGE_FIRST_LIGHT,
+    BOOT_STAGE_USERMODS,
+    BOOT_STAGE_SETUP_DONE,
+    BOOT_STAGE_CONNECTED,
+    BOOT_STAGE_INTERFACES,
+    BOOT_STAGE_SERVICES,
+    BOOT_NUM_STAGES
+};
+
+/*
+**-----------------------------------------------------------------------------
+** Remembers when each stage of the boot was reached, in milliseconds since the
+** chip started, so the time from power on to the first frame on the LEDs (and
+** to being reachable on the network) can be read from /json/perf.
+**
+** Only the first time a stage is reached counts, reconnecting to WiFi later
+** does not move the connected and interfaces stages.
+**-----------------------------------------------------------------------------
+*/
+class BootProfiler
+{
+    public:
+        static BootProfiler& get();
+
+        void mark(BootStage stage);
+
+        bool isReached(BootStage stage) const { return 0 != (mReachedStages & (1 << stage)); }
+        uint32_t getStageMillis(BootStage stage) const { return mStageMillis[stage]; }
+
+        void serializeToJson(JsonObject root) const;
+
+    private:
+        BootProfiler();
+        BootProfiler(const BootProfiler&);
+        BootProfiler& operator=(const BootProfiler&);
+
+    private:
+        uint16_t    mReachedStages;
+        uint32_t    mStageMillis[BOOT_NUM_STAGES];
+};
+
+#endif
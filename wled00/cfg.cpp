@@ -20,7 +20,9 @@ void deserializeConfig() {
     fromeep = true;
   }
 
-  DynamicJsonDocument doc(JSON_BUFFER_SIZE);
+  JsonDocumentLease docLease;
+  if (!docLease.isValid()) return;
+  JsonDocument& doc = *docLease;
 
   DEBUG_PRINTLN(F("Reading settings from /cfg.json..."));
 
@@ -340,7 +342,9 @@ void serializeConfig() {
 
   DEBUG_PRINTLN(F("Writing settings to /cfg.json..."));
 
-  DynamicJsonDocument doc(JSON_BUFFER_SIZE);
+  JsonDocumentLease docLease;
+  if (!docLease.isValid()) return;
+  JsonDocument& doc = *docLease;
 
   //{ //scope this to reduce stack size
   JsonArray rev = doc.createNestedArray("rev");
@@ -636,7 +640,9 @@ void serializeConfig() {
 bool deserializeConfigSec() {
   DEBUG_PRINTLN(F("Reading settings from /wsec.json..."));
 
-  DynamicJsonDocument doc(JSON_BUFFER_SIZE);
+  JsonDocumentLease docLease;
+  if (!docLease.isValid()) return false;
+  JsonDocument& doc = *docLease;
 
   bool success = readObjectFromFile("/wsec.json", nullptr, &doc);
   if (!success) return false;
@@ -671,7 +677,9 @@ bool deserializeConfigSec() {
 void serializeConfigSec() {
   DEBUG_PRINTLN(F("Writing settings to /wsec.json..."));
 
-  DynamicJsonDocument doc(JSON_BUFFER_SIZE);
+  JsonDocumentLease docLease;
+  if (!docLease.isValid()) return;
+  JsonDocument& doc = *docLease;
 
   JsonObject nw = doc.createNestedObject("nw");
 
@@ -1 +1,269 @@
 #include "colorlist.h"
+
+#include "wled.h"
+
+const char* ColorSetStore::SAVE_FILE_NAME = "/colorsets.json";
+const char* ColorSetStore::DEFAULT_COLOR_SET_NAME = "Default";
+
+namespace
+{
+    struct DefaultColorSet
+    {
+        const char* name;
+        uint8_t     numColors;
+        uint32_t    colors[ColorSet::MAX_COLORS];
+    };
+
+    // Written to colorsets.json the first time the store is loaded
+    const DefaultColorSet DEFAULT_COLOR_SETS[] = {
+        { "Philips 6 Colors", 6, { 0x00FF0000, 0x00FF0F00, 0x00FF4800, 0x0003D000, 0x000200FF, 0x00FF0085 } },
+        { "Christmas",        2, { GREEN, RED } },
+        { "Candy Cane",       2, { RED, WHITE } },
+    };
+
+    const char* GAMMA_ELEMENT = "gamma";
+    const char* COLOR_SETS_ARRAY_ELEMENT = "colorSets";
+    const char* NAME_ELEMENT = "name";
+    const char* COLORS_ARRAY_ELEMENT = "colors";
+}
+
+/*
+** ============================================================================
+** Get the instance of this singleton
+** ============================================================================
+*/
+ColorSetStore& ColorSetStore::get()
+{
+    static ColorSetStore instance;
+    return instance;
+}
+
+/*
+** ============================================================================
+** Constructor
+** ============================================================================
+*/
+ColorSetStore::ColorSetStore()
+    : mNumColorSets( 0 )
+{
+}
+
+/*
+** ============================================================================
+** Destructor
+** ============================================================================
+*/
+ColorSetStore::~ColorSetStore()
+{
+}
+
+/*
+** ============================================================================
+** Loads the color sets from colorsets.json.  If the file does not exist it is
+** created with the default color sets.  When the file has "gamma" set to true
+** the colors are gamma corrected once here instead of for every pixel.
+** ============================================================================
+*/
+void ColorSetStore::load()
+{
+    mNumColorSets = 0;
+
+    if (!WLED_FS.exists(SAVE_FILE_NAME))
+    {
+        loadDefaults();
+        saveToFile();
+        return;
+    }
+
+    File fileHandle = WLED_FS.open(SAVE_FILE_NAME, "r");
+    if (!fileHandle)
+    {
+        loadDefaults();
+        return;
+    }
+
+    JsonDocumentLease docLease;
+    if (!docLease.isValid())
+    {
+        fileHandle.close();
+        loadDefaults();
+        return;
+    }
+
+    JsonDocument& doc = *docLease;
+    DeserializationError error = deserializeJson(doc, fileHandle);
+    fileHandle.close();
+
+    if (error)
+    {
+        DEBUGFS_PRINTLN(F("Failed to parse colorsets.json, using defaults"));
+        loadDefaults();
+        return;
+    }
+
+    bool applyGamma = doc[GAMMA_ELEMENT] | false;
+
+    JsonArray colorSetArray = doc[COLOR_SETS_ARRAY_ELEMENT];
+    for (JsonObject colorSetJson : colorSetArray)
+    {
+        if (mNumColorSets >= MAX_COLOR_SETS)
+        {
+            break;
+        }
+
+        ColorSet& colorSet = mColorSets[mNumColorSets];
+        strlcpy(colorSet.name, colorSetJson[NAME_ELEMENT] | "", ColorSet::MAX_NAME_LENGTH);
+
+        colorSet.numColors = 0;
+        JsonArray colorsArray = colorSetJson[COLORS_ARRAY_ELEMENT];
+        for (JsonVariant color : colorsArray)
+        {
+            if (colorSet.numColors >= ColorSet::MAX_COLORS)
+            {
+                break;
+            }
+
+            uint32_t colorValue = color.is<const char*>() ? parseColor(color.as<const char*>()) : color.as<uint32_t>();
+            colorSet.colors[colorSet.numColors++] = applyGamma ? gammaCorrect(colorValue) : colorValue;
+        }
+
+        // A set without colors can not be indexed, skip it
+        if (colorSet.numColors > 0)
+        {
+            ++mNumColorSets;
+        }
+    }
+}
+
+/*
+** ============================================================================
+** Returns the color set with the given id, or nullptr for the "Default" set
+** and any id that does not exist.
+** ============================================================================
+*/
+const ColorSet* ColorSetStore::getColorSet(uint8_t colorSetId) const
+{
+    if (colorSetId == DEFAULT_COLOR_SET_ID || colorSetId > mNumColorSets)
+    {
+        return nullptr;
+    }
+
+    return &mColorSets[colorSetId - 1];
+}
+
+/*
+** ============================================================================
+** Returns the display name of the color set with the given id
+** ============================================================================
+*/
+const char* ColorSetStore::getColorSetName(uint8_t colorSetId) const
+{
+    const ColorSet* colorSet = getColorSet(colorSetId);
+    return (nullptr != colorSet) ? colorSet->name : DEFAULT_COLOR_SET_NAME;
+}
+
+/*
+** ============================================================================
+** Fills the store with the built in color sets
+** ============================================================================
+*/
+void ColorSetStore::loadDefaults()
+{
+    mNumColorSets = 0;
+    for (const DefaultColorSet& defaultSet : DEFAULT_COLOR_SETS)
+    {
+        ColorSet& colorSet = mColorSets[mNumColorSets++];
+        strlcpy(colorSet.name, defaultSet.name, ColorSet::MAX_NAME_LENGTH);
+        colorSet.numColors = defaultSet.numColors;
+        memcpy(colorSet.colors, defaultSet.colors, sizeof(colorSet.colors));
+    }
+}
+
+/*
+** ============================================================================
+** Writes the color sets to colorsets.json.  Colors are written as hex strings
+** (RRGGBB, or WWRRGGBB when the white channel is used) so the file is easy to
+** edit by hand.
+** ============================================================================
+*/
+void ColorSetStore::saveToFile() const
+{
+    JsonDocumentLease docLease;
+    if (!docLease.isValid())
+    {
+        return;
+    }
+
+    File fileHandle = WLED_FS.open(SAVE_FILE_NAME, "w");
+    if (fileHandle)
+    {
+        JsonDocument& doc = *docLease;
+        doc[GAMMA_ELEMENT] = false;
+
+        JsonArray colorSetArray = doc.createNestedArray(COLOR_SETS_ARRAY_ELEMENT);
+        for (uint8_t setIndex = 0; setIndex < mNumColorSets; ++setIndex)
+        {
+            const ColorSet& colorSet = mColorSets[setIndex];
+            JsonObject colorSetJson = colorSetArray.createNestedObject();
+            colorSetJson[NAME_ELEMENT] = colorSet.name;
+
+            JsonArray colorsArray = colorSetJson.createNestedArray(COLORS_ARRAY_ELEMENT);
+            for (uint8_t colorIndex = 0; colorIndex < colorSet.numColors; ++colorIndex)
+            {
+                char colorString[9];
+                uint32_t color = colorSet.colors[colorIndex];
+                if (color >> 24)
+                {
+                    snprintf(colorString, sizeof(colorString), "%08X", color);
+                }
+                else
+                {
+                    snprintf(colorString, sizeof(colorString), "%06X", color);
+                }
+                colorsArray.add(colorString);
+            }
+        }
+
+        serializeJson(doc, fileHandle);
+        fileHandle.close();
+    }
+}
+
+/*
+** ============================================================================
+** Converts a hex color string (RRGGBB or WWRRGGBB, optional leading #) into
+** a WRGB color
+** ============================================================================
+*/
+uint32_t ColorSetStore::parseColor(const char* colorString) const
+{
+    if (nullptr == colorString)
+    {
+        return 0;
+    }
+
+    if (colorString[0] == '#')
+    {
+        ++colorString;
+    }
+
+    return strtoul(colorString, nullptr, 16);
+}
+
+/*
+** ============================================================================
+** Returns the given color with gamma 2.8 applied to every channel
+** ============================================================================
+*/
+uint32_t ColorSetStore::gammaCorrect(uint32_t color) const
+{
+    uint32_t correctColor = 0;
+    for (uint8_t shift = 0; shift < 32; shift += 8)
+    {
+        float channel = (float)((color >> shift) & 0xFF) / 255.0f;
+        uint32_t correctChannel = (uint32_t)(powf(channel, 2.8f) * 255.0f + 0.5f);
+        correctColor |= (correctChannel << shift);
+    }
+
+    return correctColor;
+}
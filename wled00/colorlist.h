@@ -1,4 +1,70 @@
 #ifndef COLORLIST_H
 #define COLORLIST_H
 
+#include <stdint.h>
+
+/*
+**-----------------------------------------------------------------------------
+** A color set is a small table of WRGB colors.  Effects apply a color set by
+** indexing into the table with (pixel + offset) % numColors.
+**-----------------------------------------------------------------------------
+*/
+struct ColorSet
+{
+    static const uint8_t MAX_NAME_LENGTH = 24;
+    static const uint8_t MAX_COLORS = 16;
+
+    char        name[MAX_NAME_LENGTH];
+    uint8_t     numColors;
+    uint32_t    colors[MAX_COLORS];
+
+    uint32_t getColor(uint16_t position, uint16_t offset) const { return colors[(position + offset) % numColors]; }
+};
+
+/*
+**-----------------------------------------------------------------------------
+** Holds every color set available to lighted objects and effects.  The sets
+** are read once from colorsets.json (which is created with the default sets
+** if it does not exist) into fixed size tables, so looking up a color in the
+** frame loop is a single array access.
+**
+** Color set id 0 is "Default", which means the object or effect should use its
+** own colors.  getColorSet returns nullptr for it.  Ids 1 and up refer to the
+** sets loaded from the file.
+**-----------------------------------------------------------------------------
+*/
+class ColorSetStore
+{
+    public:
+        static ColorSetStore& get();
+
+        static const uint8_t MAX_COLOR_SETS = 16;
+        static const uint8_t DEFAULT_COLOR_SET_ID = 0;
+
+        void load();
+
+        const ColorSet* getColorSet(uint8_t colorSetId) const;
+        const char* getColorSetName(uint8_t colorSetId) const;
+
+        // Includes the "Default" entry
+        uint8_t getNumberOfColorSets() const { return mNumColorSets + 1; }
+
+    private:
+        ColorSetStore();
+        ColorSetStore(const ColorSetStore&);
+        virtual ~ColorSetStore();
+
+        void loadDefaults();
+        void saveToFile() const;
+        uint32_t parseColor(const char* colorString) const;
+        uint32_t gammaCorrect(uint32_t color) const;
+
+    private:
+        static const char* SAVE_FILE_NAME;
+        static const char* DEFAULT_COLOR_SET_NAME;
+
+        ColorSet    mColorSets[MAX_COLOR_SETS];
+        uint8_t     mNumColorSets;
+};
+
 #endif
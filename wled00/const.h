@@ -148,6 +148,7 @@
 #define ERR_FS_BEGIN    10  // Could not init filesystem (no partition?)
 #define ERR_FS_QUOTA    11  // The FS is full or the maximum file size is reached
 #define ERR_FS_PLOAD    12  // It was attempted to load a preset that does not exist
+#define ERR_OBJECT_BATCH 13 // A batch of object actions was invalid, none of it was applied
 #define ERR_FS_GENERAL  19  // A general unspecified filesystem error occured
 
 //Timer mode types
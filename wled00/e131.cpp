@@ -48,6 +48,7 @@ void handleDDPPacket(e131_packet_t* p) {
 
 //E1.31 and Art-Net protocol support
 void handleE131Packet(e131_packet_t* p, IPAddress clientIP, byte protocol){
+  PROFILE_SCOPE(PROFILE_E131_PACKET);
 
   uint16_t uni = 0, dmxChannels = 0;
   uint8_t* e131_data = nullptr;
@@ -101,7 +101,12 @@ bool deserializeState(JsonObject root);
 //void serializeSegment(JsonObject& root, WS2812FX::Segment& seg, byte id, bool forPreset = false, bool segmentBounds = true);
 void serializeState(JsonObject root, bool forPreset = false, bool includeBri = true, bool segmentBounds = true);
 void serializeInfo(JsonObject root);
+void serializeLightDisplayStats(JsonObject root);
+void serializeColorSetNames(JsonArray root);
 void serveJson(AsyncWebServerRequest* request);
+void servePerf(AsyncWebServerRequest* request);
+void sendAndCacheJson(AsyncWebServerRequest* request, byte responseType, JsonDocument& doc);
+void serveLightDisplay(AsyncWebServerRequest* request);
 bool serveLiveLeds(AsyncWebServerRequest* request, uint32_t wsClient = 0);
 
 //led.cpp
@@ -124,6 +129,7 @@ void parseLxJson(int lxValue, byte segId, bool secondary);
 //mqtt.cpp
 bool initMqtt();
 void publishMqtt();
+void publishMqttTelemetry();
 
 //ntp.cpp
 void handleNetworkTime();
@@ -178,8 +184,6 @@ void _setRandomColor(bool _sec,bool fromButton=false);
 bool isAsterisksOnly(const char* str, byte maxLen);
 void handleSettingsSet(AsyncWebServerRequest *request, byte subPage);
 bool handleSet(AsyncWebServerRequest *request, const String& req, bool apply=true);
-int getNumVal(const String* req, uint16_t pos);
-bool updateVal(const String* req, const char* key, byte* val, byte minv=0, byte maxv=255);
 
 //udp.cpp
 void notify(byte callMode, bool followUp=false);
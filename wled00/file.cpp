@@ -31,6 +31,9 @@ uint16_t knownLargestSpace = UINT16_MAX;
 
 File f;
 
+//id of the preset being read or written if f is indexed by PresetIndex, -1 otherwise
+int32_t indexedId = -1;
+
 //wrapper to find out how long closing takes
 void closeFile() {
   DEBUGFS_PRINT(F("Close -> "));
@@ -79,6 +82,12 @@ bool bufferedFind(const char *target, bool fromStart = true) {
   return false;
 }
 
+//finds the object's key like bufferedFind(), but seeks straight to it if the file has a PresetIndex
+bool findObjectKey(const char *key) {
+  if (indexedId < 0) return bufferedFind(key);
+  return PresetIndex::get().seek(f, indexedId);
+}
+
 //find empty spots in file stream in 256-byte blocks.
 bool bufferedFindSpace(uint16_t targetLen, bool fromStart = true) {
 
@@ -190,6 +199,7 @@ bool appendObjectToFile(const char* key, JsonDocument* content, uint32_t s, uint
     char init[10];
     strcpy_P(init, PSTR("{\"0\":{}}"));
     f.print(init);
+    if (indexedId >= 0) PresetIndex::get().invalidate();
   }
 
   if (content->isNull()) {
@@ -198,9 +208,10 @@ bool appendObjectToFile(const char* key, JsonDocument* content, uint32_t s, uint
   }
   
   //if there is enough empty space in file, insert there instead of appending
+  //indexed files are a log, objects are only appended and PresetCompactor removes the holes
   if (!contentLen) contentLen = measureJson(*content);
   DEBUGFS_PRINTF("CLen %d\n", contentLen);
-  if (bufferedFindSpace(contentLen + strlen(key) + 1)) {
+  if (indexedId < 0 && bufferedFindSpace(contentLen + strlen(key) + 1)) {
     if (f.position() > 2) f.write(','); //add comma if not first object
     f.print(key);
     serializeJson(*content, f);
@@ -214,7 +225,9 @@ bool appendObjectToFile(const char* key, JsonDocument* content, uint32_t s, uint
   //permitted space for presets exceeded
   updateFSInfo();
   
-  if (f.size() + 9000 > (fsBytesTotal - fsBytesUsed)) { //make sure there is enough space to at least copy the file once
+  uint32_t quota = f.size() + 9000; //make sure there is enough space to at least copy the file once
+  if (indexedId >= 0 && PresetIndex::get().isBuilt()) quota = f.size() - PresetIndex::get().getDeadBytes() + contentLen + 1024; //compacted copy
+  if (quota > (fsBytesTotal - fsBytesUsed)) {
     errorFlag = ERR_FS_QUOTA;
     doCloseFile = true;
     return false;
@@ -243,13 +256,16 @@ bool appendObjectToFile(const char* key, JsonDocument* content, uint32_t s, uint
   } else { //file content is not valid JSON object
     f.seek(0, SeekSet);
     f.print('{'); //start JSON
+    if (indexedId >= 0) PresetIndex::get().invalidate();
   }
 
   f.print(key);
+  pos = f.position();
 
   //Append object
   serializeJson(*content, f);
   f.write('}');
+  if (indexedId >= 0) PresetIndex::get().add(indexedId, pos, f.size());
 
   doCloseFile = true;
   DEBUGFS_PRINTF("Appended, took %d ms (total %d)", millis() - s1, millis() - s);
@@ -260,11 +276,19 @@ bool writeObjectToFileUsingId(const char* file, uint16_t id, JsonDocument* conte
 {
   char objKey[10];
   sprintf(objKey, "\"%d\":", id);
-  return writeObjectToFile(file, objKey, content);
+  indexedId = PresetIndex::isIndexedFile(file) ? id : -1;
+  if (indexedId >= 0) {
+    PresetCompactor::get().onWrite(); //a compaction copying the file would miss this write
+    PresetCache::get().remove(id);
+  }
+  bool success = writeObjectToFile(file, objKey, content);
+  indexedId = -1;
+  return success;
 }
 
 bool writeObjectToFile(const char* file, const char* key, JsonDocument* content)
 {
+  PROFILE_SCOPE(PROFILE_FILE_WRITE);
   uint32_t s = 0; //timing
   #ifdef WLED_DEBUG_FS
     DEBUGFS_PRINTF("Write to %s with key %s >>>\n", file, (key==nullptr)?"nullptr":key);
@@ -287,7 +311,7 @@ bool writeObjectToFile(const char* file, const char* key, JsonDocument* content)
     return false;
   }
   
-  if (!bufferedFind(key)) //key does not exist in file
+  if (!findObjectKey(key)) //key does not exist in file
   {
     return appendObjectToFile(key, content, s);
   } 
@@ -306,6 +330,7 @@ bool writeObjectToFile(const char* file, const char* key, JsonDocument* content)
   //2. The new content is smaller than the old, overwrite and fill diff with spaces
   //3. The new content is larger than the old, but smaller than old + trailing spaces, overwrite with new
   //4. The new content is larger than old + trailing spaces, delete old and append
+  //Indexed files always take 1. or 4., so the new object is a sequential append
   
   uint32_t contentLen = 0;
   if (!content->isNull())
@@ -313,14 +338,14 @@ bool writeObjectToFile(const char* file, const char* key, JsonDocument* content)
     contentLen = measureJson(*content);
   }
 
-  if (contentLen && contentLen <= oldLen)
+  if (indexedId < 0 && contentLen && contentLen <= oldLen)
   { //replace and fill diff with spaces
     DEBUGFS_PRINTLN(F("replace"));
     f.seek(pos);
     serializeJson(*content, f);
     writeSpace(pos2 - f.position());
   } 
-  else if (contentLen && bufferedFindSpace(contentLen - oldLen, false)) 
+  else if (indexedId < 0 && contentLen && bufferedFindSpace(contentLen - oldLen, false)) 
   { //enough leading spaces to replace
     DEBUGFS_PRINTLN(F("replace (trailing)"));
     f.seek(pos);
@@ -336,6 +361,7 @@ bool writeObjectToFile(const char* file, const char* key, JsonDocument* content)
     }
     f.seek(pos);
     writeSpace(pos2 - pos);
+    if (indexedId >= 0) PresetIndex::get().remove(indexedId, pos2 - pos);
     if (contentLen)
     {
       return appendObjectToFile(key, content, s, contentLen);
@@ -351,12 +377,16 @@ bool readObjectFromFileUsingId(const char* file, uint16_t id, JsonDocument* dest
 {
   char objKey[10];
   sprintf(objKey, "\"%d\":", id);
-  return readObjectFromFile(file, objKey, dest);
+  indexedId = PresetIndex::isIndexedFile(file) ? id : -1;
+  bool success = readObjectFromFile(file, objKey, dest);
+  indexedId = -1;
+  return success;
 }
 
 //if the key is a nullptr, deserialize entire object
 bool readObjectFromFile(const char* file, const char* key, JsonDocument* dest)
 {
+  PROFILE_SCOPE(PROFILE_FILE_READ);
   if (doCloseFile) closeFile();
   #ifdef WLED_DEBUG_FS
     DEBUGFS_PRINTF("Read from %s with key %s >>>\n", file, (key==nullptr)?"nullptr":key);
@@ -365,7 +395,7 @@ bool readObjectFromFile(const char* file, const char* key, JsonDocument* dest)
   f = WLED_FS.open(file, "r");
   if (!f) return false;
 
-  if (key != nullptr && !bufferedFind(key)) //key does not exist in file
+  if (key != nullptr && !findObjectKey(key)) //key does not exist in file
   {
     f.close();
     dest->clear();
@@ -402,17 +432,18 @@ String getContentType(AsyncWebServerRequest* request, String filename){
   if(request->hasArg("download")) return "application/octet-stream";
   else if(filename.endsWith(".htm")) return "text/html";
   else if(filename.endsWith(".html")) return "text/html";
-//  else if(filename.endsWith(".css")) return "text/css";
-//  else if(filename.endsWith(".js")) return "application/javascript";
+  else if(filename.endsWith(".css")) return "text/css";
+  else if(filename.endsWith(".js")) return "application/javascript";
   else if(filename.endsWith(".json")) return "application/json";
   else if(filename.endsWith(".png")) return "image/png";
-//  else if(filename.endsWith(".gif")) return "image/gif";
+  else if(filename.endsWith(".gif")) return "image/gif";
   else if(filename.endsWith(".jpg")) return "image/jpeg";
   else if(filename.endsWith(".ico")) return "image/x-icon";
-//  else if(filename.endsWith(".xml")) return "text/xml";
+  else if(filename.endsWith(".svg")) return "image/svg+xml";
+  else if(filename.endsWith(".xml")) return "text/xml";
 //  else if(filename.endsWith(".pdf")) return "application/x-pdf";
 //  else if(filename.endsWith(".zip")) return "application/x-zip";
-//  else if(filename.endsWith(".gz")) return "application/x-gzip";
+  else if(filename.endsWith(".gz")) return "application/x-gzip";
   return "text/plain";
 }
 
@@ -421,14 +452,6 @@ bool handleFileRead(AsyncWebServerRequest* request, String path){
   if(path.endsWith("/")) path += "index.htm";
   if(path.indexOf("sec") > -1) return false;
   String contentType = getContentType(request, path);
-  /*String pathWithGz = path + ".gz";
-  if(WLED_FS.exists(pathWithGz)){
-    request->send(WLED_FS, pathWithGz, contentType);
-    return true;
-  }*/
-  if(WLED_FS.exists(path)) {
-    request->send(WLED_FS, path, contentType);
-    return true;
-  }
-  return false;
+  //sends path.gz instead if there is one, with ETag validation, see StaticAssetServer
+  return StaticAssetServer::get().sendFile(request, path, contentType);
 }
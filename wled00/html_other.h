@@ -92,6 +92,7 @@ src="data:image/png;base64,iVBORw0KGgoAAAANSUhEUgAAACAAAAAgCAYAAABzenr0AAAAAXNSR
 
 // Autogenerated from wled00/data/favicon.ico, do not edit!!
 const uint16_t favicon_length = 954;
+const char favicon_etag[] PROGMEM = "e7dd4960";
 const uint8_t favicon[] PROGMEM = {
   0x00, 0x00, 0x01, 0x00, 0x01, 0x00, 0x10, 0x10, 0x00, 0x00, 0x01, 0x00, 0x18, 0x00, 0x86, 0x00,
   0x00, 0x00, 0x16, 0x00, 0x00, 0x00, 0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a, 0x00, 0x00,
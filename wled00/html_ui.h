@@ -8,6 +8,7 @@
  
 // Autogenerated from wled00/data/index.htm, do not edit!!
 const uint16_t PAGE_index_L = 35632;
+const char PAGE_index_etag[] PROGMEM = "b10b6446";
 const uint8_t PAGE_index[] PROGMEM = {
   0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x0a, 0xdc, 0xbd, 0x69, 0x7b, 0xe2, 0xb8,
   0xd6, 0x28, 0xfa, 0xfd, 0xfc, 0x0a, 0x8a, 0xda, 0x5d, 0x8d, 0x0b, 0x03, 0x66, 0x0c, 0x21, 0x45,
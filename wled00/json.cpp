@@ -2,18 +2,209 @@
 #include "lighted_objects/LightedObjectFactory.h"
 #include "lighted_objects/ILightedObject.h"
 
+#include <algorithm>
+#include <memory>
 #include <string>
 
 /*
  * JSON API (De)serialization
  */
 
+//the object_action types, looked up once by name and then dispatched on
+enum ObjectActionType : uint8_t {
+  OBJECT_ACTION_CLEAR_ALL_OBJECTS = 0,
+  OBJECT_ACTION_CREATE_OBJECT,
+  OBJECT_ACTION_DELETE,
+  OBJECT_ACTION_MOVE_DOWN,
+  OBJECT_ACTION_MOVE_UP,
+  OBJECT_ACTION_SAVE_CHANGES,
+  OBJECT_ACTION_TOGGLE_POWER,
+  OBJECT_ACTION_BAKE,
+  OBJECT_ACTION_SAVE_SCENE,
+  OBJECT_ACTION_ACTIVATE_SCENE,
+  OBJECT_ACTION_DELETE_SCENE,
+  OBJECT_ACTION_SET_TARGET_FPS,
+  OBJECT_ACTION_RESET_FRAME_STATS,
+  OBJECT_ACTION_RESET_PERF_STATS,
+  OBJECT_ACTION_CLEAR_TRACE,
+  OBJECT_ACTION_SET_OUTPUTS,
+  OBJECT_ACTION_UNKNOWN
+};
+
+//only the actions on the list of lighted objects can be batched
+static const struct {
+  const char* name;
+  ObjectActionType type;
+  bool batchable;
+} objectActionTable[] = {
+  { "clear_all_objects", OBJECT_ACTION_CLEAR_ALL_OBJECTS, true  },
+  { "create_object",     OBJECT_ACTION_CREATE_OBJECT,     true  },
+  { "delete",            OBJECT_ACTION_DELETE,            true  },
+  { "move_down",         OBJECT_ACTION_MOVE_DOWN,         true  },
+  { "move_up",           OBJECT_ACTION_MOVE_UP,           true  },
+  { "save_changes",      OBJECT_ACTION_SAVE_CHANGES,      true  },
+  { "toggle_power",      OBJECT_ACTION_TOGGLE_POWER,      true  },
+  { "bake",              OBJECT_ACTION_BAKE,              true  },
+  { "save_scene",        OBJECT_ACTION_SAVE_SCENE,        false },
+  { "activate_scene",    OBJECT_ACTION_ACTIVATE_SCENE,    false },
+  { "delete_scene",      OBJECT_ACTION_DELETE_SCENE,      false },
+  { "set_target_fps",    OBJECT_ACTION_SET_TARGET_FPS,    false },
+  { "reset_frame_stats", OBJECT_ACTION_RESET_FRAME_STATS, false },
+#ifndef WLED_DISABLE_PROFILER
+  { "reset_perf_stats",  OBJECT_ACTION_RESET_PERF_STATS,  false },
+  { "clear_trace",       OBJECT_ACTION_CLEAR_TRACE,       false },
+#endif
+  { "set_outputs",       OBJECT_ACTION_SET_OUTPUTS,       false }
+};
+
+static uint8_t getObjectActionIndex(const char* actionName)
+{
+  for (uint8_t i = 0; i < sizeof(objectActionTable) / sizeof(objectActionTable[0]); i++) {
+    if (strcmp(actionName, objectActionTable[i].name) == 0) return i;
+  }
+  return 255;
+}
+
+static ObjectActionType getObjectActionType(const char* actionName)
+{
+  uint8_t i = getObjectActionIndex(actionName);
+  return (i == 255) ? OBJECT_ACTION_UNKNOWN : objectActionTable[i].type;
+}
+
+//checks a whole batch against the object count it will see before anything is applied,
+//so a batch is applied completely or not at all
+static bool isObjectActionBatchValid(JsonArray batch)
+{
+  StringList objectTypes = LightedObjectFactory::get().getListOfLightedObjectTypes();
+  int numObjects = lightDisplay.getNumberOfLightedObjects();
+
+  for (JsonObject objectAction : batch)
+  {
+    uint8_t i = getObjectActionIndex(objectAction["action"] | "");
+    if (i == 255 || !objectActionTable[i].batchable) return false;
+
+    int objectIndex = objectAction[F("object_index")] | -1;
+    switch (objectActionTable[i].type)
+    {
+      case OBJECT_ACTION_CLEAR_ALL_OBJECTS:
+        numObjects = 0;
+        break;
+      case OBJECT_ACTION_CREATE_OBJECT: {
+        std::string objectType = objectAction["object_type"] | "";
+        if (std::find(objectTypes.begin(), objectTypes.end(), objectType) == objectTypes.end()) return false;
+        numObjects++;
+        break;
+      }
+      case OBJECT_ACTION_DELETE:
+        if (objectIndex < 0 || objectIndex >= numObjects) return false;
+        numObjects--;
+        break;
+      case OBJECT_ACTION_MOVE_DOWN:
+        if (objectIndex < 0 || objectIndex >= numObjects -1) return false;
+        break;
+      case OBJECT_ACTION_MOVE_UP:
+        if (objectIndex < 1 || objectIndex >= numObjects) return false;
+        break;
+      default: //save_changes, toggle_power and bake
+        if (objectIndex < 0 || objectIndex >= numObjects) return false;
+        break;
+    }
+  }
+  return true;
+}
+
+static void applyObjectAction(JsonObject objectAction, ObjectActionType actionType)
+{
+  int objectIndex = objectAction[F("object_index")] | -1;
+
+  switch (actionType)
+  {
+    case OBJECT_ACTION_CLEAR_ALL_OBJECTS:
+      lightDisplay.clearAllObjects();
+      break;
+    case OBJECT_ACTION_CREATE_OBJECT: {
+      String objectType = objectAction["object_type"];
+      lightDisplay.createLightedObject(objectType.c_str());
+      break;
+    }
+    case OBJECT_ACTION_DELETE:
+      lightDisplay.deleteObject(objectIndex);
+      break;
+    case OBJECT_ACTION_MOVE_DOWN:
+      lightDisplay.moveObjectDown(objectIndex);
+      break;
+    case OBJECT_ACTION_MOVE_UP:
+      lightDisplay.moveObjectUp(objectIndex);
+      break;
+    case OBJECT_ACTION_SAVE_CHANGES: {
+      String userInputValues = objectAction["userInputs"];
+      lightDisplay.updateObject(objectIndex, userInputValues.c_str());
+      break;
+    }
+    case OBJECT_ACTION_TOGGLE_POWER:
+      lightDisplay.togglePower(objectIndex);
+      break;
+    case OBJECT_ACTION_BAKE: {
+      bool enabled = objectAction[F("enabled")] | true;
+      lightDisplay.setObjectBaking(objectIndex, enabled);
+      break;
+    }
+    case OBJECT_ACTION_SAVE_SCENE: {
+      const char* sceneName = objectAction[F("scene_name")] | "";
+      lightDisplay.saveScene(sceneName);
+      break;
+    }
+    case OBJECT_ACTION_ACTIVATE_SCENE: {
+      int sceneIndex = objectAction[F("scene_index")] | -1;
+      lightDisplay.activateScene(sceneIndex);
+      break;
+    }
+    case OBJECT_ACTION_DELETE_SCENE: {
+      int sceneIndex = objectAction[F("scene_index")] | -1;
+      lightDisplay.deleteScene(sceneIndex);
+      break;
+    }
+    case OBJECT_ACTION_SET_TARGET_FPS: {
+      uint8_t targetFps = objectAction[F("fps")] | lightDisplay.getTargetFps();
+      lightDisplay.setTargetFps(targetFps);
+      break;
+    }
+    case OBJECT_ACTION_RESET_FRAME_STATS:
+      lightDisplay.resetFrameStatistics();
+      break;
+#ifndef WLED_DISABLE_PROFILER
+    case OBJECT_ACTION_RESET_PERF_STATS:
+      Profiler::get().reset();
+      break;
+    case OBJECT_ACTION_CLEAR_TRACE:
+      FrameTracer::get().clear();
+      break;
+#endif
+    case OBJECT_ACTION_SET_OUTPUTS: {
+      LightDisplay::OutputConfigList outputConfig;
+      JsonArray outputsArray = objectAction[F("outputs")];
+      for (JsonObject outputJson : outputsArray)
+      {
+        LightDisplay::OutputConfig config;
+        config.pin = outputJson[F("pin")] | LEDPIN;
+        config.numPixels = outputJson[F("led_count")] | 0;
+        outputConfig.push_back(config);
+      }
+      lightDisplay.configureOutputs(outputConfig);
+      break;
+    }
+    default:
+      break;
+  }
+}
+
 bool deserializeState(JsonObject root)
 {
 #ifdef ENABLE_SET_EFFECTS // MDR TEMP - removing set effects functionality
   strip.applyToAllSelected = false;
 #endif // ENABLE_SET_EFFECTS
   bool stateResponse = root[F("v")] | false;
+  JsonResponseCache::get().invalidate();
   
   bri = root["bri"] | bri;
   lightDisplay.setBrightness(bri);
@@ -21,18 +212,18 @@ bool deserializeState(JsonObject root)
   bool on = root["on"] | (bri > 0);
   if (!on != !bri) toggleOnOff();
 
+  // Transitions are given in 100ms units but stored as 16 bit milliseconds
   int tr = root[F("transition")] | -1;
   if (tr >= 0)
   {
-    transitionDelay = tr;
-    transitionDelay *= 100;
+    transitionDelay = min(tr, 655) * 100;
+    lightDisplay.setTransitionDuration(transitionDelay);
   }
 
   tr = root[F("tt")] | -1;
   if (tr >= 0)
   {
-    transitionDelayTemp = tr;
-    transitionDelayTemp *= 100;
+    transitionDelayTemp = min(tr, 655) * 100;
     jsonTransitionOnce = true;
   }
   
@@ -73,48 +264,30 @@ bool deserializeState(JsonObject root)
     else    realtimeTimeout = 0; //cancel realtime mode immediately
   }
 
-  // Handle object actions
-  if (root.containsKey("object_action"))
+  // Handle object actions, an array of them is applied as one batch
+  JsonVariant objectActions = root["object_action"];
+  if (objectActions.is<JsonArray>())
   {
-    JsonObject objectAction = root["object_action"];
-    String actionType = objectAction["action"];
-
-    if (actionType.compareTo("clear_all_objects") == 0)
-    {
-      lightDisplay.clearAllObjects();
-    }
-    else if (actionType.compareTo("create_object") == 0)
-    {
-      String objectType = objectAction["object_type"];
-      lightDisplay.createLightedObject(objectType.c_str());
-    }
-    else if (actionType.compareTo("delete") == 0)
-    {
-      int objectIndex = objectAction[F("object_index")] | -1;
-      lightDisplay.deleteObject(objectIndex);
-    }
-    else if (actionType.compareTo("move_down") == 0)
-    {
-      int objectIndex = objectAction[F("object_index")] | -1;
-      lightDisplay.moveObjectDown(objectIndex);
-    }
-    else if (actionType.compareTo("move_up") == 0)
+    JsonArray batch = objectActions.as<JsonArray>();
+    if (isObjectActionBatchValid(batch))
     {
-      int objectIndex = objectAction[F("object_index")] | -1;
-      lightDisplay.moveObjectUp(objectIndex);
-    }
-    else if (actionType.compareTo("save_changes") == 0)
-    {
-      int objectIndex = objectAction[F("object_index")] | -1;
-      String userInputValues = objectAction["userInputs"];
-      lightDisplay.updateObject(objectIndex, userInputValues.c_str());
+      lightDisplay.beginBatch();
+      for (JsonObject objectAction : batch)
+      {
+        applyObjectAction(objectAction, getObjectActionType(objectAction["action"] | ""));
+      }
+      lightDisplay.endBatch();
     }
-    else if (actionType.compareTo("toggle_power") == 0)
+    else
     {
-      int objectIndex = objectAction[F("object_index")] | -1;
-      lightDisplay.togglePower(objectIndex);
+      errorFlag = ERR_OBJECT_BATCH;
     }
   }
+  else if (objectActions.is<JsonObject>())
+  {
+    JsonObject objectAction = objectActions.as<JsonObject>();
+    applyObjectAction(objectAction, getObjectActionType(objectAction["action"] | ""));
+  }
 
   usermods.readFromJsonState(root);
 
@@ -342,6 +515,120 @@ void serializeInfo(JsonObject root)
   root["mac"] = escapedMac;
 }
 
+//names of all color sets in the store, index in the array is the color set id
+void serializeColorSetNames(JsonArray root)
+{
+  ColorSetStore& colorSetStore = ColorSetStore::get();
+  for (uint8_t id = 0; id < colorSetStore.getNumberOfColorSets(); id++)
+  {
+    root.add(colorSetStore.getColorSetName(id));
+  }
+}
+
+//frame, output and scene statistics of the light display, these change with every frame so
+//they are only in /json/perf, the state stays the same (and cacheable) while nothing is changed
+void serializeLightDisplayStats(JsonObject root)
+{
+  JsonArray outputsArray = root.createNestedArray("outputs");
+  for (LightDisplayOutput* output : lightDisplay.getOutputs())
+  {
+    JsonObject currentOutput = outputsArray.createNestedObject();
+    currentOutput[F("pin")] = output->getPin();
+    currentOutput[F("shows")] = output->getShowCount();
+    currentOutput[F("skipped_shows")] = output->getSkippedShowCount();
+  }
+
+  const LightDisplayFramePacer& framePacer = lightDisplay.getFramePacer();
+  JsonObject frameStats = root.createNestedObject("frame_stats");
+  frameStats[F("target_fps")] = framePacer.getTargetFps();
+  frameStats[F("achieved_fps")] = framePacer.getAchievedFps();
+  frameStats[F("frame_interval_us")] = framePacer.getFrameInterval();
+  frameStats[F("show_us")] = framePacer.getShowTime();
+  frameStats[F("wire_us")] = framePacer.getWireTime();
+  frameStats[F("late_frames")] = framePacer.getLateFrames();
+  frameStats[F("skipped_frames")] = framePacer.getSkippedFrames();
+  frameStats[F("jitter_p50_us")] = framePacer.getJitterPercentile(50);
+  frameStats[F("jitter_p90_us")] = framePacer.getJitterPercentile(90);
+  frameStats[F("jitter_p99_us")] = framePacer.getJitterPercentile(99);
+
+  JsonArray scenesArray = root.createNestedArray("scenes");
+  for (LightDisplayScene* scene : lightDisplay.getScenes())
+  {
+    JsonObject currentScene = scenesArray.createNestedObject();
+    currentScene[F("name")] = String(scene->getName().c_str());
+    currentScene[F("ready")] = scene->isStandbyReady();
+  }
+
+  JsonArray lightedObjectArray = root.createNestedArray("lighted_objects");
+  for (ILightedObject* lightedObject : lightDisplay.getLightedObjects())
+  {
+    JsonObject currentLightedObject = lightedObjectArray.createNestedObject();
+    lightedObject->serializeStatisticsToJson(currentLightedObject);
+  }
+
+  JsonObject sceneStats = root.createNestedObject("scene_stats");
+  sceneStats[F("last_switch_us")] = lightDisplay.getLastSceneSwitchMicros();
+  sceneStats[F("max_switch_us")] = lightDisplay.getMaxSceneSwitchMicros();
+}
+
+//sections of /json/perf, the profiler and the statistics of the modules
+struct PerfSection {
+  const char* name;
+  void (*serialize)(JsonObject root);
+};
+
+static const PerfSection perfSections[] = {
+  #ifndef WLED_DISABLE_PROFILER
+  { "profiler",         [](JsonObject root) { Profiler::get().serializeToJson(root); } },
+  #endif
+  { "heap",             [](JsonObject root) { HeapTelemetry::get().serializeToJson(root); } },
+  { "json_pool",        [](JsonObject root) { JsonDocumentPool::get().serializeToJson(root); } },
+  { "json_cache",       [](JsonObject root) { JsonResponseCache::get().serializeToJson(root); } },
+  { "state_filter",     [](JsonObject root) { StateRequestFilter::get().serializeToJson(root); } },
+  { "static_assets",    [](JsonObject root) { StaticAssetServer::get().serializeToJson(root); } },
+  { "preset_index",     [](JsonObject root) { PresetIndex::get().serializeToJson(root); } },
+  { "preset_compactor", [](JsonObject root) { PresetCompactor::get().serializeToJson(root); } },
+  { "preset_cache",     [](JsonObject root) { PresetCache::get().serializeToJson(root); } },
+  { "boot",             [](JsonObject root) { BootProfiler::get().serializeToJson(root); } },
+  #ifdef WLED_ENABLE_WEBSOCKETS
+  { "ws_delta",         [](JsonObject root) { WsDeltaSync::get().serializeToJson(root); } },
+  { "live_stream",      [](JsonObject root) { LiveLedStream::get().serializeToJson(root); } },
+  { "ws_assembler",     [](JsonObject root) { WsMessageAssembler::get().serializeToJson(root); } },
+  #endif
+  { "display_stats",    serializeLightDisplayStats },
+};
+
+//the diagnostics are kept out of /json/info, together they do not fit in one document on the ESP8266.
+//each section is built in the pooled document on its own and streamed out, a section that does not
+//fit by itself is replaced by an error instead of being cut off silently
+void servePerf(AsyncWebServerRequest* request)
+{
+  JsonDocumentLease doc;
+  if (!doc.isValid()) {
+    request->send(503, "application/json", F("{\"error\":\"busy\"}"));
+    return;
+  }
+
+  AsyncResponseStream* response = request->beginResponseStream("application/json");
+  response->print('{');
+  for (size_t i = 0; i < sizeof(perfSections) / sizeof(perfSections[0]); i++) {
+    doc->clear();
+    perfSections[i].serialize(doc->to<JsonObject>());
+    if (doc->overflowed()) {
+      doc->clear();
+      (*doc)[F("error")] = F("too large");
+    }
+
+    if (i > 0) response->print(',');
+    response->print('"');
+    response->print(perfSections[i].name);
+    response->print(F("\":"));
+    serializeJson(*doc, *response);
+  }
+  response->print('}');
+  request->send(response);
+}
+
 void serveJson(AsyncWebServerRequest* request)
 {
   byte subJson = 0;
@@ -354,24 +641,56 @@ void serveJson(AsyncWebServerRequest* request)
     return;
   }
   else if (url.indexOf(F("eff"))   > 0) {
-    request->send_P(200, "application/json", JSON_mode_names);
+    JsonResponseCache::get().sendStatic(request, JSON_mode_names);
     return;
   }
   else if (url.indexOf(F("pal"))   > 0) {
-    request->send_P(200, "application/json", JSON_palette_names);
+    JsonResponseCache::get().sendStatic(request, JSON_palette_names);
     return;
   }
-  else if (url.indexOf(F("colorset")) > 0) {
-    request->send_P(200, "application/json", JSON_colorset_names);
+  else if (url.indexOf(F("perf")) > 0) {
+    servePerf(request);
+    return;
+  }
+#ifndef WLED_DISABLE_PROFILER
+  else if (url.indexOf(F("trace")) > 0) {
+    // Chrome trace event JSON, streamed in chunks from a copy of the trace
+    std::shared_ptr<TraceExport> traceExport = std::make_shared<TraceExport>();
+    AsyncWebServerResponse* response = request->beginChunkedResponse("application/json",
+      [traceExport](uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+        return traceExport->write(buffer, maxLen);
+      });
+    response->addHeader(F("Content-Disposition"), F("attachment; filename=\"wled_trace.json\""));
+    request->send(response);
     return;
   }
+#endif
+  else if (url.indexOf(F("colorset")) > 0) {
+    subJson = JSON_RESPONSE_COLOR_SETS;
+  }
   else if (url.length() > 6) { //not just /json
     request->send(  501, "application/json", F("{\"error\":\"Not implemented\"}"));
     return;
   }
   
-  AsyncJsonResponse* response = new AsyncJsonResponse(JSON_BUFFER_SIZE);
-  JsonObject doc = response->getRoot();
+  // An unchanged display is answered from the cache, often with just a 304
+  JsonResponseCache& responseCache = JsonResponseCache::get();
+  if (responseCache.sendCached(request, subJson)) return;
+
+  JsonDocumentLease jsonBuffer;
+  if (!jsonBuffer.isValid()) {
+    request->send(503, "application/json", F("{\"error\":\"busy\"}"));
+    return;
+  }
+
+  if (subJson == JSON_RESPONSE_COLOR_SETS) {
+    JsonArray colorSets = jsonBuffer->to<JsonArray>();
+    serializeColorSetNames(colorSets);
+    sendAndCacheJson(request, subJson, *jsonBuffer);
+    return;
+  }
+
+  JsonObject doc = jsonBuffer->to<JsonObject>();
 
   switch (subJson)
   {
@@ -388,7 +707,8 @@ void serveJson(AsyncWebServerRequest* request)
       {
         doc[F("effects")]  = serialized((const __FlashStringHelper*)JSON_mode_names);
         doc[F("palettes")] = serialized((const __FlashStringHelper*)JSON_palette_names);
-        doc[F("colorsets")] = serialized((const __FlashStringHelper*)JSON_colorset_names);
+        JsonArray colorSets = doc.createNestedArray(F("colorsets"));
+        serializeColorSetNames(colorSets);
 
         StringList supportedObjects = LightedObjectFactory::get().getListOfLightedObjectTypes();
         JsonArray lightedObjects = doc.createNestedArray("supportedObjectTypes");
@@ -410,7 +730,18 @@ void serveJson(AsyncWebServerRequest* request)
   powerStats[F("max_current")] = lightDisplay.getMaximumAllowedCurrent();
 
   JsonArray ledPinsArray = lightedDisplayObject.createNestedArray("led_pins");
-  ledPinsArray.add(LEDPIN);
+  JsonArray outputsArray = lightedDisplayObject.createNestedArray("outputs");
+  for (LightDisplayOutput* output : lightDisplay.getOutputs())
+  {
+    ledPinsArray.add(output->getPin());
+
+    JsonObject currentOutput = outputsArray.createNestedObject();
+    currentOutput[F("pin")] = output->getPin();
+    currentOutput[F("led_count")] = output->getNumberOfLEDs();
+    currentOutput[F("first_address")] = output->getFirstDisplayAddress();
+  }
+  lightedDisplayObject[F("max_outputs")] = WLED_MAX_PIXEL_OUTPUTS;
+  lightedDisplayObject[F("target_fps")] = lightDisplay.getTargetFps();
 
   JsonArray lightedObjectArray = lightedDisplayObject.createNestedArray("lighted_objects");
   for (ILightedObject* lightedObject : lightDisplay.getLightedObjects())
@@ -418,12 +749,53 @@ void serveJson(AsyncWebServerRequest* request)
     JsonObject currentLightedObject = lightedObjectArray.createNestedObject();
     lightedObject->serializeCurrentStateToJson(currentLightedObject);
   }
+
+  JsonArray scenesArray = lightedDisplayObject.createNestedArray("scenes");
+  for (LightDisplayScene* scene : lightDisplay.getScenes())
+  {
+    JsonObject currentScene = scenesArray.createNestedObject();
+    currentScene[F("name")] = String(scene->getName().c_str());
+    currentScene[F("num_objects")] = scene->getNumberOfLightedObjects();
+    currentScene[F("size")] = scene->getSnapshot().size();
+  }
+  lightedDisplayObject[F("active_scene")] = lightDisplay.getActiveSceneIndex();
   
   //Serial.printf("-----------------------------------------------------------------\nMDR DEBUG - Sending JSON Response:\n");
   //serializeJsonPretty(doc, Serial);
   //Serial.printf("-----------------------------------------------------------------\n");
 
-  response->setLength();
+  sendAndCacheJson(request, subJson, *jsonBuffer);
+}
+
+//serializes a freshly built response into the response cache and sends it from there
+void sendAndCacheJson(AsyncWebServerRequest* request, byte responseType, JsonDocument& doc)
+{
+  std::shared_ptr<String> body = std::make_shared<String>();
+  body->reserve(measureJson(doc) + 1);
+  serializeJson(doc, *body);
+
+  JsonResponseCache& responseCache = JsonResponseCache::get();
+  responseCache.store(responseType, body);
+  responseCache.sendCached(request, responseType);
+}
+
+//the light display is saved in a binary file, this exports it in the JSON form lightDisplay.json used to have
+void serveLightDisplay(AsyncWebServerRequest* request)
+{
+  String body;
+  { //scope JsonDocumentLease so it returns its document to the pool before sending
+    JsonDocumentLease jsonBuffer;
+    if (!jsonBuffer.isValid()) {
+      request->send(503, "application/json", F("{\"error\":\"busy\"}"));
+      return;
+    }
+    lightDisplay.serializeToJson(jsonBuffer->to<JsonObject>());
+    body.reserve(measureJson(*jsonBuffer) + 1);
+    serializeJson(*jsonBuffer, body);
+  }
+
+  AsyncWebServerResponse* response = request->beginResponse(200, "application/json", body);
+  response->addHeader(F("Content-Disposition"), F("attachment; filename=\"lightDisplay.json\""));
   request->send(response);
 }
 
@@ -0,0 +1,215 @@
+#include "wled.h"
+
+namespace
+{
+    const char* HITS_ELEMENT = "hits";
+    const char* MISSES_ELEMENT = "misses";
+    const char* NOT_MODIFIED_ELEMENT = "not_modified";
+    const char* GENERATION_ELEMENT = "generation";
+}
+
+/*
+** ============================================================================
+** Returns the one JSON response cache
+** ============================================================================
+*/
+JsonResponseCache& JsonResponseCache::get()
+{
+    static JsonResponseCache sJsonResponseCache;
+    return sJsonResponseCache;
+}
+
+/*
+** ============================================================================
+** Constructor
+** ============================================================================
+*/
+JsonResponseCache::JsonResponseCache()
+    : mGeneration( 0 )
+    , mNextBodyId( 0 )
+    , mNumHits( 0 )
+    , mNumMisses( 0 )
+    , mNumNotModified( 0 )
+{
+#ifdef ARDUINO_ARCH_ESP32
+    mBootId = esp_random();
+#else
+    mBootId = ESP.random();
+#endif
+
+    for (CacheEntry& entry : mEntries)
+    {
+        entry.responseType = JSON_NUM_RESPONSE_TYPES;
+        entry.generation = 0;
+        entry.buildTimestamp = 0;
+        entry.bodyId = 0;
+    }
+}
+
+/*
+** ============================================================================
+** Answers the request with 304 if the client already has the current body, or
+** with the cached body if there is one
+**
+**  returns false if the response has to be built and stored first
+** ============================================================================
+*/
+bool JsonResponseCache::sendCached(AsyncWebServerRequest* request, uint8_t responseType)
+{
+    const CacheEntry* entry = findValidEntry(responseType);
+    if (nullptr == entry)
+    {
+        return false;
+    }
+
+    String etag = getEtag(entry->bodyId);
+    if (isEtagMatch(request, etag))
+    {
+        ++mNumNotModified;
+        AsyncWebServerResponse* response = request->beginResponse(304);
+        response->addHeader(F("ETag"), etag);
+        request->send(response);
+        return true;
+    }
+
+    ++mNumHits;
+
+    // The response keeps its own reference so the body outlives an eviction
+    std::shared_ptr<String> body = entry->body;
+    AsyncWebServerResponse* response = request->beginResponse("application/json", body->length(),
+        [body](uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+            size_t length = body->length() - index;
+            if (length > maxLen) length = maxLen;
+            memcpy(buffer, body->c_str() + index, length);
+            return length;
+        });
+    response->addHeader(F("ETag"), etag);
+    response->addHeader(F("Cache-Control"), F("no-cache"));
+    request->send(response);
+    return true;
+}
+
+/*
+** ============================================================================
+** Stores a freshly built body for the current generation.  Replaces the entry
+** of the same type, or the oldest entry if there is none.
+** ============================================================================
+*/
+void JsonResponseCache::store(uint8_t responseType, std::shared_ptr<String> body)
+{
+    ++mNumMisses;
+
+    CacheEntry* target = &mEntries[0];
+    for (CacheEntry& entry : mEntries)
+    {
+        if (entry.responseType == responseType)
+        {
+            target = &entry;
+            break;
+        }
+
+        if ((int32_t)(entry.buildTimestamp - target->buildTimestamp) < 0)
+        {
+            target = &entry;
+        }
+    }
+
+    target->responseType = responseType;
+    target->generation = mGeneration;
+    target->buildTimestamp = millis();
+    target->bodyId = ++mNextBodyId;
+    target->body = body;
+}
+
+/*
+** ============================================================================
+** Sends a body stored in flash, which only changes with the firmware, with an
+** ETag made from the build number
+** ============================================================================
+*/
+void JsonResponseCache::sendStatic(AsyncWebServerRequest* request, const char* progmemBody)
+{
+    String etag = String(F("\"b")) + String(VERSION) + "\"";
+    if (isEtagMatch(request, etag))
+    {
+        ++mNumNotModified;
+        AsyncWebServerResponse* response = request->beginResponse(304);
+        response->addHeader(F("ETag"), etag);
+        request->send(response);
+        return;
+    }
+
+    AsyncWebServerResponse* response = request->beginResponse_P(200, "application/json", progmemBody);
+    response->addHeader(F("ETag"), etag);
+    response->addHeader(F("Cache-Control"), F("no-cache"));
+    request->send(response);
+}
+
+/*
+** ============================================================================
+** Writes the cache statistics
+** ============================================================================
+*/
+void JsonResponseCache::serializeToJson(JsonObject root) const
+{
+    root[GENERATION_ELEMENT] = mGeneration;
+    root[HITS_ELEMENT] = mNumHits;
+    root[MISSES_ELEMENT] = mNumMisses;
+    root[NOT_MODIFIED_ELEMENT] = mNumNotModified;
+}
+
+/*
+** ============================================================================
+** Returns the entry of the given type if it can still be used, that is if it
+** was built for the current generation and its statistics are recent enough
+** ============================================================================
+*/
+const JsonResponseCache::CacheEntry* JsonResponseCache::findValidEntry(uint8_t responseType) const
+{
+    for (const CacheEntry& entry : mEntries)
+    {
+        if (entry.responseType != responseType || !entry.body || entry.generation != mGeneration)
+        {
+            continue;
+        }
+
+        // The state only changes with the generation, apart from the remaining nightlight
+        // time.  The info carries live statistics, color sets none.
+        bool hasStatistics = (JSON_RESPONSE_STATE == responseType) ? nightlightActive : (JSON_RESPONSE_COLOR_SETS != responseType);
+        if (hasStatistics && millis() - entry.buildTimestamp > MAX_STATS_AGE_MS)
+        {
+            return nullptr;
+        }
+
+        return &entry;
+    }
+
+    return nullptr;
+}
+
+/*
+** ============================================================================
+** Returns the (quoted) ETag of the given body
+** ============================================================================
+*/
+String JsonResponseCache::getEtag(uint32_t bodyId) const
+{
+    char etag[20];
+    snprintf(etag, sizeof(etag), "\"%08x-%x\"", (unsigned)mBootId, (unsigned)bodyId);
+    return String(etag);
+}
+
+/*
+** ============================================================================
+** Returns true if the request's If-None-Match header contains the given ETag
+** ============================================================================
+*/
+bool JsonResponseCache::isEtagMatch(AsyncWebServerRequest* request, const String& etag) const
+{
+    if (!request->hasHeader(F("If-None-Match")))
+    {
+        return false;
+    }
+
+    return request->getHeader(F("If-None-Match"))->value().indexOf(etag) >= 0;
+}
@@ -0,0 +1,100 @@
+#ifndef JSON_CACHE_H
+#define JSON_CACHE_H
+
+#include "Arduino.h"
+
+#include <memory>
+
+/*
+** The /json responses that can be cached.  Values match the subJson selector
+** used by serveJson.
+*/
+enum JsonResponseType : uint8_t
+{
+    JSON_RESPONSE_ALL = 0,
+    JSON_RESPONSE_STATE,
+    JSON_RESPONSE_INFO,
+    JSON_RESPONSE_STATE_INFO,
+    JSON_RESPONSE_COLOR_SETS,
+    JSON_NUM_RESPONSE_TYPES
+};
+
+/*
+**-----------------------------------------------------------------------------
+** Keeps the serialized /json responses so that clients polling an unchanged
+** display do not rebuild the state, info and every lighted object's UI
+** elements each time.
+**
+** Anything that changes the state (JSON API, HTTP API, settings, colorUpdated)
+** calls invalidate(), which bumps the generation.  A cached response is reused
+** while it was built for the current generation.  Responses that carry live
+** statistics (the info with uptime, free heap and WiFi signal) are
+** also rebuilt once they are older than MAX_STATS_AGE_MS so those numbers do
+** not go stale.  The state only depends on the generation, so a client polling
+** /json/state gets 304 for as long as nothing changes (except while a
+** nightlight counts down its remaining time).
+**
+** Every body gets an ETag.  A request whose If-None-Match matches the current
+** body is answered with 304 and no body.  The ETag includes a random boot id
+** so a tag from before a reboot never matches.
+**
+** The ESP8266 keeps a single response (the most recently built one) to save
+** memory, the ESP32 keeps one of each type.
+**-----------------------------------------------------------------------------
+*/
+class JsonResponseCache
+{
+    public:
+#ifdef ESP8266
+        static const uint8_t NUM_ENTRIES = 1;
+#else
+        static const uint8_t NUM_ENTRIES = JSON_NUM_RESPONSE_TYPES;
+#endif
+        static const uint16_t MAX_STATS_AGE_MS = 2000;
+
+        static JsonResponseCache& get();
+
+        void invalidate() { ++mGeneration; }
+        uint32_t getGeneration() const { return mGeneration; }
+
+        // Answers the request from the cache (304 or the cached body), returns false
+        // if the response has to be built and stored first
+        bool sendCached(AsyncWebServerRequest* request, uint8_t responseType);
+        void store(uint8_t responseType, std::shared_ptr<String> body);
+
+        // For bodies that only change with the firmware (effect and palette names)
+        void sendStatic(AsyncWebServerRequest* request, const char* progmemBody);
+
+        void serializeToJson(JsonObject root) const;
+
+    private:
+        JsonResponseCache();
+        JsonResponseCache(const JsonResponseCache&);
+        JsonResponseCache& operator=(const JsonResponseCache&);
+
+        struct CacheEntry
+        {
+            uint8_t                 responseType;
+            uint32_t                generation;
+            uint32_t                buildTimestamp;
+            uint32_t                bodyId;
+            std::shared_ptr<String> body;
+        };
+
+        const CacheEntry* findValidEntry(uint8_t responseType) const;
+        String getEtag(uint32_t bodyId) const;
+        bool isEtagMatch(AsyncWebServerRequest* request, const String& etag) const;
+
+    private:
+        CacheEntry  mEntries[NUM_ENTRIES];
+        uint32_t    mGeneration;
+        uint32_t    mNextBodyId;
+        uint32_t    mBootId;
+
+        // Statistics
+        uint32_t    mNumHits;
+        uint32_t    mNumMisses;
+        uint32_t    mNumNotModified;
+};
+
+#endif
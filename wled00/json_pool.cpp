@@ -0,0 +1,258 @@
+#include "wled.h"
+
+#ifdef ARDUINO_ARCH_ESP32
+  // The web server callbacks run in the async TCP task, the loop in its own task
+  static portMUX_TYPE sPoolMux = portMUX_INITIALIZER_UNLOCKED;
+  #define POOL_LOCK()   portENTER_CRITICAL(&sPoolMux)
+  #define POOL_UNLOCK() portEXIT_CRITICAL(&sPoolMux)
+#else
+  // Everything runs in the same context on the ESP8266
+  #define POOL_LOCK()
+  #define POOL_UNLOCK()
+#endif
+
+namespace
+{
+    const char* SIZE_ELEMENT = "size";
+    const char* IN_USE_ELEMENT = "in_use";
+    const char* PEAK_ELEMENT = "peak";
+    const char* BORROWS_ELEMENT = "borrows";
+    const char* WAITS_ELEMENT = "waits";
+    const char* TRANSIENTS_ELEMENT = "transients";
+    const char* FAILURES_ELEMENT = "failures";
+    const char* TOTAL_WAIT_ELEMENT = "wait_total_ms";
+    const char* MAX_WAIT_ELEMENT = "wait_max_ms";
+}
+
+/*
+** ============================================================================
+** Returns the one JSON document pool
+** ============================================================================
+*/
+JsonDocumentPool& JsonDocumentPool::get()
+{
+    static JsonDocumentPool sJsonDocumentPool;
+    return sJsonDocumentPool;
+}
+
+/*
+** ============================================================================
+** Constructor
+** ============================================================================
+*/
+JsonDocumentPool::JsonDocumentPool()
+    : mNumDocuments( 0 )
+    , mNumInUse( 0 )
+    , mPeakInUse( 0 )
+    , mNumBorrows( 0 )
+    , mNumWaits( 0 )
+    , mNumTransients( 0 )
+    , mNumFailures( 0 )
+    , mTotalWaitMs( 0 )
+    , mMaxWaitMs( 0 )
+{
+    for (uint8_t index = 0; index < NUM_DOCUMENTS; ++index)
+    {
+        mDocuments[index] = nullptr;
+        mInUse[index] = false;
+    }
+}
+
+/*
+** ============================================================================
+** Allocates the arenas.  Called once early in setup so the arenas are taken
+** from the heap before it is fragmented.  If the heap runs out the pool simply
+** has fewer documents.
+** ============================================================================
+*/
+void JsonDocumentPool::begin()
+{
+    while (mNumDocuments < NUM_DOCUMENTS)
+    {
+        uint8_t* arena = (uint8_t*)malloc(JSON_BUFFER_SIZE);
+        if (nullptr == arena)
+        {
+            DEBUG_PRINTLN(F("JSON pool: out of memory"));
+            break;
+        }
+
+        mDocuments[mNumDocuments] = new PooledJsonDocument(JSON_BUFFER_SIZE, JsonArenaAllocator(arena, JSON_BUFFER_SIZE));
+        ++mNumDocuments;
+    }
+}
+
+/*
+** ============================================================================
+** Lends out a free document.  If they are all in use a transient document is
+** allocated instead, if even that fails it waits up to the given time for one
+** to come back (only on the ESP32).
+**
+**  returns the empty document or nullptr if none could be had
+** ============================================================================
+*/
+JsonDocument* JsonDocumentPool::borrow(uint32_t maxWaitMs)
+{
+    JsonDocument* document = tryBorrow();
+    if (nullptr == document)
+    {
+        document = allocateTransient();
+    }
+
+#ifdef ARDUINO_ARCH_ESP32
+    if (nullptr == document && maxWaitMs > 0)
+    {
+        uint32_t waitStart = millis();
+        uint32_t waitMs = 0;
+        while (nullptr == document && waitMs < maxWaitMs)
+        {
+            delay(1);
+            document = tryBorrow();
+            waitMs = millis() - waitStart;
+        }
+
+        POOL_LOCK();
+        ++mNumWaits;
+        mTotalWaitMs += waitMs;
+        if (waitMs > mMaxWaitMs)
+        {
+            mMaxWaitMs = waitMs;
+        }
+        POOL_UNLOCK();
+    }
+#endif
+
+    if (nullptr == document)
+    {
+        POOL_LOCK();
+        ++mNumFailures;
+        POOL_UNLOCK();
+        DEBUG_PRINTLN(F("JSON pool: exhausted"));
+    }
+
+    return document;
+}
+
+/*
+** ============================================================================
+** Takes the first free document, if any
+** ============================================================================
+*/
+JsonDocument* JsonDocumentPool::tryBorrow()
+{
+    JsonDocument* document = nullptr;
+
+    POOL_LOCK();
+    for (uint8_t index = 0; index < mNumDocuments; ++index)
+    {
+        if (!mInUse[index])
+        {
+            mInUse[index] = true;
+            document = mDocuments[index];
+
+            ++mNumBorrows;
+            ++mNumInUse;
+            if (mNumInUse > mPeakInUse)
+            {
+                mPeakInUse = mNumInUse;
+            }
+            break;
+        }
+    }
+    POOL_UNLOCK();
+
+    return document;
+}
+
+/*
+** ============================================================================
+** Allocates a document outside the pool for a borrower that found the pool
+** empty
+**
+**  returns the document or nullptr if the heap has no JSON_BUFFER_SIZE block
+** ============================================================================
+*/
+JsonDocument* JsonDocumentPool::allocateTransient()
+{
+    DynamicJsonDocument* document = new DynamicJsonDocument(JSON_BUFFER_SIZE);
+    HEAP_COUNT_ALLOCATION(HEAP_SITE_JSON_DOCUMENT);
+    if (0 == document->capacity())
+    {
+        delete document;
+        return nullptr;
+    }
+
+    POOL_LOCK();
+    ++mNumTransients;
+    POOL_UNLOCK();
+    return document;
+}
+
+/*
+** ============================================================================
+** Returns true if the document is one of the pool's own documents
+** ============================================================================
+*/
+bool JsonDocumentPool::isPooled(const JsonDocument* document) const
+{
+    for (uint8_t index = 0; index < mNumDocuments; ++index)
+    {
+        if (mDocuments[index] == document)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+** ============================================================================
+** Empties a borrowed document and makes it available again, a transient
+** document is freed
+** ============================================================================
+*/
+void JsonDocumentPool::giveBack(JsonDocument* document)
+{
+    if (nullptr == document)
+    {
+        return;
+    }
+
+    if (!isPooled(document))
+    {
+        // Only allocateTransient hands out documents that are not in the pool
+        delete static_cast<DynamicJsonDocument*>(document);
+        return;
+    }
+
+    document->clear();
+
+    POOL_LOCK();
+    for (uint8_t index = 0; index < mNumDocuments; ++index)
+    {
+        if (mDocuments[index] == document && mInUse[index])
+        {
+            mInUse[index] = false;
+            --mNumInUse;
+            break;
+        }
+    }
+    POOL_UNLOCK();
+}
+
+/*
+** ============================================================================
+** Writes the usage statistics of the pool
+** ============================================================================
+*/
+void JsonDocumentPool::serializeToJson(JsonObject root) const
+{
+    root[SIZE_ELEMENT] = mNumDocuments;
+    root[IN_USE_ELEMENT] = mNumInUse;
+    root[PEAK_ELEMENT] = mPeakInUse;
+    root[BORROWS_ELEMENT] = mNumBorrows;
+    root[WAITS_ELEMENT] = mNumWaits;
+    root[TRANSIENTS_ELEMENT] = mNumTransients;
+    root[FAILURES_ELEMENT] = mNumFailures;
+    root[TOTAL_WAIT_ELEMENT] = mTotalWaitMs;
+    root[MAX_WAIT_ELEMENT] = mMaxWaitMs;
+}
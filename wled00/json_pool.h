@@ -0,0 +1,121 @@
+#ifndef JSON_POOL_H
+#define JSON_POOL_H
+
+#include "Arduino.h"
+
+/*
+**-----------------------------------------------------------------------------
+** ArduinoJson allocator that hands out one fixed arena.  The arena belongs to
+** the pool so nothing is freed when the document lets go of it.
+**-----------------------------------------------------------------------------
+*/
+struct JsonArenaAllocator
+{
+    JsonArenaAllocator(uint8_t* arena = nullptr, size_t arenaSize = 0) : mArena(arena), mArenaSize(arenaSize) {}
+
+    void* allocate(size_t size) { return (size <= mArenaSize) ? mArena : nullptr; }
+    void deallocate(void* pointer) {}
+    void* reallocate(void* pointer, size_t newSize) { return (newSize <= mArenaSize) ? pointer : nullptr; }
+
+    uint8_t*    mArena;
+    size_t      mArenaSize;
+};
+
+typedef BasicJsonDocument<JsonArenaAllocator> PooledJsonDocument;
+
+/*
+**-----------------------------------------------------------------------------
+** A fixed number of JSON_BUFFER_SIZE documents allocated once at boot, while
+** the heap is still in one piece, and then lent out to the web, WebSocket,
+** preset and light display save paths instead of each of them allocating its
+** own DynamicJsonDocument.  Two requests being handled at the same time can no
+** longer need two fresh 9-16KB blocks, they share the arenas.
+**
+** The pool covers the usual case, a nested path such as a state request that
+** applies a preset which saves a preset can hold more documents than the pool
+** has.  When every document is lent out the borrower gets a transient
+** DynamicJsonDocument instead, as it did before the pool, and only if that
+** allocation fails does a borrower on the ESP32 (where the web server runs in
+** its own task) wait up to its timeout for a document to come back.  The
+** ESP8266 can not wait inside a callback so the borrow then fails; the caller
+** answers with 503 (or skips the work) instead.
+**
+** udp.cpp (a small 2KB document) and wled_eeprom.cpp (a one time migration
+** that needs twice JSON_BUFFER_SIZE) still allocate their own documents.
+**
+** Documents are borrowed through JsonDocumentLease, which returns them when it
+** goes out of scope.
+**-----------------------------------------------------------------------------
+*/
+class JsonDocumentPool
+{
+    public:
+#ifdef ESP8266
+        static const uint8_t NUM_DOCUMENTS = 2;
+#else
+        static const uint8_t NUM_DOCUMENTS = 3;
+#endif
+        static const uint16_t DEFAULT_WAIT_MS = 50;
+
+        static JsonDocumentPool& get();
+
+        void begin();
+
+        JsonDocument* borrow(uint32_t maxWaitMs);
+        void giveBack(JsonDocument* document);
+
+        void serializeToJson(JsonObject root) const;
+
+    private:
+        JsonDocumentPool();
+        JsonDocumentPool(const JsonDocumentPool&);
+        JsonDocumentPool& operator=(const JsonDocumentPool&);
+
+        JsonDocument* tryBorrow();
+        JsonDocument* allocateTransient();
+        bool isPooled(const JsonDocument* document) const;
+
+    private:
+        PooledJsonDocument* mDocuments[NUM_DOCUMENTS];
+        bool                mInUse[NUM_DOCUMENTS];
+        uint8_t             mNumDocuments;
+        uint8_t             mNumInUse;
+
+        // Statistics
+        uint8_t             mPeakInUse;
+        uint32_t            mNumBorrows;
+        uint32_t            mNumWaits;
+        uint32_t            mNumTransients;
+        uint32_t            mNumFailures;
+        uint32_t            mTotalWaitMs;
+        uint32_t            mMaxWaitMs;
+};
+
+/*
+**-----------------------------------------------------------------------------
+** Borrows a document from the pool for the lifetime of the lease.  Check
+** isValid() before using the document, the pool may be exhausted.
+**-----------------------------------------------------------------------------
+*/
+class JsonDocumentLease
+{
+    public:
+        explicit JsonDocumentLease(uint32_t maxWaitMs = JsonDocumentPool::DEFAULT_WAIT_MS)
+            : mDocument(JsonDocumentPool::get().borrow(maxWaitMs)) {}
+        ~JsonDocumentLease() { JsonDocumentPool::get().giveBack(mDocument); }
+
+        bool isValid() const { return nullptr != mDocument; }
+
+        JsonDocument& operator*() { return *mDocument; }
+        JsonDocument* operator->() { return mDocument; }
+        JsonDocument* get() { return mDocument; }
+
+    private:
+        JsonDocumentLease(const JsonDocumentLease&);
+        JsonDocumentLease& operator=(const JsonDocumentLease&);
+
+    private:
+        JsonDocument*   mDocument;
+};
+
+#endif
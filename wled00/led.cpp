@@ -98,6 +98,7 @@ bool colorChanged()
 
 void colorUpdated(int callMode)
 {
+  JsonResponseCache::get().invalidate();
 #ifdef ENABLE_SET_EFFECTS // MDR TEMP - removing the set effects feature
   //call for notifier -> 0: init 1: direct change 2: button 3: notification 4: nightlight 5: other (No notification)
   //                     6: fx changed 7: hue 8: preset cycle 9: blynk 10: alexa
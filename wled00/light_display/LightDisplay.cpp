@@ -6,6 +6,9 @@
 #include "lighted_objects/ILightedObject.h"
 
 #include "const.h"
+#include "profiler.h"
+
+#include <algorithm>
 
 #define FASTLED_INTERNAL //remove annoying pragma messages
 #define USE_GET_MILLISECOND_TIMER
@@ -30,7 +33,11 @@ const byte LightDisplay::sGammaTable[] = {
   177,180,182,184,186,189,191,193,196,198,200,203,205,208,210,213,
   215,218,220,223,225,228,231,233,236,239,241,244,247,249,252,255 };
 
-const char* LightDisplay::SAVE_FILE_NAME = "/lightDisplay.json";
+const char* LightDisplay::SAVE_FILE_NAME = "/lightDisplay.bin";
+const char* LightDisplay::TEMP_SAVE_FILE_NAME = "/lightDisplay.bin.tmp";
+const char* LightDisplay::JSON_FILE_NAME = "/lightDisplay.json";
+const char* LightDisplay::SCENES_FILE_NAME = "/scenes.bin";
+const char* LightDisplay::TEMP_SCENES_FILE_NAME = "/scenes.bin.tmp";
 const char* LightDisplay::LIGHT_DISPLAY_ROOT_ELEMENT = "lightDisplay";
 const char* LightDisplay::CURRENT_BRIGHTNESS_ELEMENT = "currentBrightness";
 const char* LightDisplay::SUPPORTS_WHITE_ELEMENT = "supportsWhite";
@@ -39,6 +46,11 @@ const char* LightDisplay::RGBW_MODE_ELEMENT = "rgbwMode";
 const char* LightDisplay::GAMMA_CORRECT_BRIGHTNESS_ELEMENT = "gammaCorrectBrightness";
 const char* LightDisplay::GAMMA_CORRECT_COLOR_ELEMENT = "gammaCorrectColor";
 const char* LightDisplay::MAX_MILLIAMPS_ELEMENT = "maxMilliamps";
+const char* LightDisplay::TRANSITION_DURATION_ELEMENT = "transitionDuration";
+const char* LightDisplay::TARGET_FPS_ELEMENT = "targetFps";
+const char* LightDisplay::OUTPUTS_ARRAY_ELEMENT = "outputs";
+const char* LightDisplay::OUTPUT_PIN_ELEMENT = "pin";
+const char* LightDisplay::OUTPUT_NUM_LEDS_ELEMENT = "numLEDs";
 const char* LightDisplay::LIGHTED_OBJECTS_ARRAY_ELEMENT = "lightedObjects";
 
 /*
@@ -58,9 +70,16 @@ LightDisplay::LightDisplay()
     , mMaxMilliamps( DEFAULT_MAX_MILLIAMPS )
     , mMilliampsPerLed( DEFAULT_MILLIAMP_PER_LED )
     , mCurrentMilliamps( 0 )
-    , mNeoPixelWrapper( nullptr )
+    , mDefaultOutputNumPixels( 0 )
     , mCurrentTimestamp( 0 )
     , mLastShowTimestamp( 0 )
+    , mBatchDepth( 0 )
+    , mBatchHasChanges( false )
+    , mBatchLayoutChanged( false )
+    , mTransitionDuration( DEFAULT_TRANSITION_DURATION_IN_MS )
+    , mActiveSceneIndex( -1 )
+    , mLastSceneSwitchMicros( 0 )
+    , mMaxSceneSwitchMicros( 0 )
 {
 }
 
@@ -71,62 +90,83 @@ LightDisplay::LightDisplay()
 */
 LightDisplay::~LightDisplay()
 {
-    if (mNeoPixelWrapper != nullptr)
+    for (LightDisplayScene* scene : mScenes)
     {
-        delete mNeoPixelWrapper;
-        mNeoPixelWrapper = nullptr;
+        delete scene;
     }
+    mScenes.clear();
+
+    releaseOutputs();
 }
 
 /*
 ** ============================================================================
-** Initializes the light display
+** Initializes the light display.  totalPixels is only used when no outputs
+** are configured in the save file, all LEDs are then on one output on LEDPIN.
 ** ============================================================================
 */
 void LightDisplay::init(bool supportsWhite, uint16_t totalPixels)
 {
-    mNeoPixelWrapper = new NeoPixelWrapper();
     mLastShowTimestamp = mCurrentTimestamp = 0;
-    mMaxPixelsInDisplay = totalPixels;
+    mMaxPixelsInDisplay = mDefaultOutputNumPixels = totalPixels;
     mSupportsWhiteChannel = supportsWhite;
 
     loadFromFile();
+    loadScenesFromFile();
 
-    // Make sure that the pixel wrapper has the desired color order set
-    if (getColorOrder() != mColorOrder)
-    {
-        mNeoPixelWrapper->SetColorOrder(mColorOrder);
-    }
-
-    const NeoPixelType pixelType = mSupportsWhiteChannel ? NeoPixelType_Grbw : NeoPixelType_Grb;
-    mNeoPixelWrapper->Begin(pixelType, mMaxPixelsInDisplay);
+    // Starting the outputs also lays out the lighted objects on them
+    beginOutputs();
 }
 
 /*
 ** ============================================================================
-** Sets up and displays the next 'frame' for each lighted object
+** Sets up and displays the next 'frame' for each lighted object.  The frame
+** pacer decides when the next frame is due.
 ** ============================================================================
 */
 void LightDisplay::runEffect()
 {
-    mCurrentTimestamp = millis(); // Be aware, millis() rolls over every 49 days
-    uint32_t delta = mCurrentTimestamp - mLastShowTimestamp;
+    uint32_t currentMicros = micros();
 
     // Early exit if it is too soon to setup the next frame
-    if (delta < MIN_FRAME_TIME_IN_MS)
+    if (!mFramePacer.isFrameDue(currentMicros))
     {
         return;
     }
 
-    // Go through all lighted objects and setup the next frame.  If one or more are active 
-    // then set isShowRequired to true.
-    bool isShowRequired = false;
+    mFramePacer.startFrame(currentMicros);
+    mCurrentTimestamp = millis(); // Be aware, millis() rolls over every 49 days
+
+    // Go through all lighted objects and setup the frame for the current time.  Effects only
+    // depend on the timestamp so a late frame simply skips ahead.  The output of every object
+    // whose frame changed has to be sent again.
     for (ILightedObject* lightedObject : mLightedObjects)
     {
-        if (nullptr != lightedObject)
+        if (nullptr == lightedObject)
+        {
+            continue;
+        }
+
+        bool isFrameChanged = false;
+        PROFILE_CALL(PROFILE_RENDER_OBJECT, isFrameChanged = lightedObject->runEffect(mCurrentTimestamp));
+        if (isFrameChanged)
+        {
+            markOutputDirty(lightedObject->getOutput());
+        }
+    }
+
+    // Fade from the frame shown before the last change to the frame that was just rendered
+    bool isShowRequired = false;
+    for (LightDisplayOutput* output : mOutputs)
+    {
+        LightDisplayTransition& transition = output->getTransition();
+        if (transition.isActive())
         {
-            isShowRequired |= lightedObject->runEffect(delta);
+            PROFILE_CALL(PROFILE_TRANSITION_BLEND, transition.blendFrame(output->getPixelWrapper(), mCurrentTimestamp, output->getNumberOfObjectLEDs()));
+            output->markDirty();
         }
+
+        isShowRequired |= output->isDirty();
     }
 
     if (isShowRequired)
@@ -134,6 +174,9 @@ void LightDisplay::runEffect()
         yield();
         setBrightnessAndShow();
     }
+
+    // Now that the frame is out, rebuild a scene that is not ready to be switched to
+    PROFILE_CALL(PROFILE_PREPARE_SCENES, prepareStandbyScenes());
 }
 
 /*
@@ -146,11 +189,77 @@ void LightDisplay::runEffect()
 */
 void LightDisplay::createLightedObject(std::string objectType)
 {
-    ILightedObject* newObject = LightedObjectFactory::get().createLightedObject(objectType, mNeoPixelWrapper);
+    ILightedObject* newObject = LightedObjectFactory::get().createLightedObject(objectType, getPrimaryPixelWrapper());
+    if (nullptr == newObject)
+    {
+        return;
+    }
+
+    beginBatch();
     mLightedObjects.push_back(newObject);
-    resetLightedObjectAddresses();
-    saveToFile();
-    resetAllLeds();
+    markObjectsChanged(newObject, true);
+    endBatch();
+}
+
+/*
+** ============================================================================
+** Starts a batch of changes to the lighted objects.  Until the matching
+** endBatch the objects are not laid out again, the display is not saved and
+** no transition starts, so a script creating a whole display causes one save
+** and one transition instead of one per object.  Batches can be nested, only
+** the outermost endBatch applies the changes.
+** ============================================================================
+*/
+void LightDisplay::beginBatch()
+{
+    if (0 == mBatchDepth)
+    {
+        mBatchHasChanges = false;
+        mBatchLayoutChanged = false;
+        mBatchLayout = captureLayout();
+        mBatchChangedObjects.clear();
+    }
+
+    ++mBatchDepth;
+}
+
+/*
+** ============================================================================
+** Ends a batch of changes.  If anything changed the objects are laid out, the
+** display is saved and one transition covers everything that moved or
+** changed.  Objects deleted in the batch are only freed now, so a new object
+** can not take the place of a deleted one in the layout captured at the start.
+** ============================================================================
+*/
+void LightDisplay::endBatch()
+{
+    if (0 == mBatchDepth || --mBatchDepth > 0)
+    {
+        return;
+    }
+
+    if (mBatchHasChanges)
+    {
+        if (mBatchLayoutChanged)
+        {
+            resetLightedObjectAddresses();
+        }
+
+        saveToFile();
+
+        if (mBatchLayoutChanged)
+        {
+            startTransition(mBatchLayout, mBatchChangedObjects);
+        }
+    }
+
+    for (ILightedObject* object : mBatchDeletedObjects)
+    {
+        delete object;
+    }
+    mBatchDeletedObjects.clear();
+    mBatchChangedObjects.clear();
+    mBatchLayout.clear();
 }
 
 /*
@@ -160,15 +269,18 @@ void LightDisplay::createLightedObject(std::string objectType)
 */
 void LightDisplay::clearAllObjects()
 {
-    // Unallocate memory for all objects
+    beginBatch();
+
+    // The objects are freed at the end of the batch
     for (ILightedObject* object : mLightedObjects)
     {
-        delete object;
+        mBatchDeletedObjects.push_back(object);
     }
 
     // Clear vector of lighted objects
     mLightedObjects.clear();
-    saveToFile();
+    markObjectsChanged(nullptr, true);
+    endBatch();
 }
 
 /*
@@ -182,12 +294,13 @@ void LightDisplay::deleteObject(int objectIndex)
 {
     if (objectIndex >= 0 && objectIndex < mLightedObjects.size())
     {
-        ILightedObject* objectToDelete = mLightedObjects[objectIndex];
-        delete objectToDelete;
+        beginBatch();
+
+        // The object is freed at the end of the batch
+        mBatchDeletedObjects.push_back(mLightedObjects[objectIndex]);
         mLightedObjects.erase(mLightedObjects.begin() + objectIndex);
-        resetLightedObjectAddresses();
-        saveToFile();
-        resetAllLeds();
+        markObjectsChanged(nullptr, true);
+        endBatch();
     }
 }
 
@@ -200,11 +313,12 @@ void LightDisplay::deleteObject(int objectIndex)
 */
 void LightDisplay::moveObjectDown(int originalIndex)
 {
+    beginBatch();
+
     int newIndex = originalIndex + 1;
     swapLightedObjects(originalIndex, newIndex);
-    resetLightedObjectAddresses();
-    saveToFile();
-    resetAllLeds();
+    markObjectsChanged(nullptr, true);
+    endBatch();
 }
 
 /*
@@ -216,11 +330,12 @@ void LightDisplay::moveObjectDown(int originalIndex)
 */
 void LightDisplay::moveObjectUp(int originalIndex)
 {
+    beginBatch();
+
     int newIndex = originalIndex - 1;
     swapLightedObjects(originalIndex, newIndex);
-    resetLightedObjectAddresses();
-    saveToFile();
-    resetAllLeds();
+    markObjectsChanged(nullptr, true);
+    endBatch();
 }
 
 /*
@@ -234,12 +349,37 @@ void LightDisplay::togglePower(int objectIndex)
 {
     if (objectIndex >= 0 && objectIndex < mLightedObjects.size())
     {
+        beginBatch();
         ILightedObject* objectToToggle = mLightedObjects[objectIndex];
         if (nullptr != objectToToggle)
         {
             objectToToggle->togglePower();
         }
-        saveToFile();
+        markObjectsChanged(nullptr, false);
+        endBatch();
+    }
+}
+
+/*
+** ============================================================================
+** Enables or disables baking of the effect for the object with the given index
+**
+**  param   objectIndex - index of the object to bake
+**  param   enabled - true to bake the effect, false to render it every frame
+** ============================================================================
+*/
+void LightDisplay::setObjectBaking(int objectIndex, bool enabled)
+{
+    if (objectIndex >= 0 && objectIndex < mLightedObjects.size())
+    {
+        beginBatch();
+        ILightedObject* objectToBake = mLightedObjects[objectIndex];
+        if (nullptr != objectToBake)
+        {
+            objectToBake->enableBaking(enabled);
+        }
+        markObjectsChanged(nullptr, false);
+        endBatch();
     }
 }
 
@@ -257,13 +397,17 @@ void LightDisplay::updateObject(int objectIndex, const char* userInputValues)
 {
     if (objectIndex >= 0 && objectIndex < mLightedObjects.size())
     {
+        beginBatch();
+
         ILightedObject* objectToUpdate = mLightedObjects[objectIndex];
         if (nullptr != objectToUpdate)
         {
             objectToUpdate->update(userInputValues);
         }
-        saveToFile();
-        resetAllLeds();
+
+        // The update may have changed the number of LEDs in the object
+        markObjectsChanged(objectToUpdate, true);
+        endBatch();
     }
 }
 
@@ -285,6 +429,145 @@ ILightedObject* LightDisplay::getLightedObject(int objectIndex)
     return nullptr;
 }
 
+/*
+** ============================================================================
+** Replaces the outputs of the display.  The buses are restarted and the lighted
+** objects are laid out on the new outputs, objects on an output that no longer
+** exists stay dark until they are moved to an existing output.  An empty list
+** goes back to a single output on LEDPIN using the LED count from the settings.
+**
+**  param   outputConfig - pin and number of LEDs of every output
+** ============================================================================
+*/
+void LightDisplay::configureOutputs(const OutputConfigList& outputConfig)
+{
+    mOutputConfig.clear();
+    for (const OutputConfig& config : outputConfig)
+    {
+        if (config.numPixels > 0 && mOutputConfig.size() < MAX_NUM_OUTPUTS)
+        {
+            mOutputConfig.push_back(config);
+        }
+    }
+
+    beginOutputs();
+    saveToFile();
+    setBrightnessAndShow();
+}
+
+/*
+** ============================================================================
+** Saves the current lighted objects as a scene with the given name.  If there
+** already is a scene with that name it is replaced, otherwise a new scene is
+** added (as long as we are below MAX_NUM_SCENES).  The standby objects for the
+** scene are prepared after the next frame so saving stays quick.
+**
+**  param   sceneName - name of the scene to save
+** ============================================================================
+*/
+void LightDisplay::saveScene(const char* sceneName)
+{
+    std::string name = (nullptr != sceneName) ? sceneName : "";
+    if (name.empty())
+    {
+        char defaultName[16];
+        snprintf(defaultName, sizeof(defaultName), "Scene %d", (int)mScenes.size() + 1);
+        name = defaultName;
+    }
+
+    LightDisplayScene* sceneToSave = nullptr;
+    for (uint8_t sceneIndex = 0; sceneIndex < mScenes.size(); ++sceneIndex)
+    {
+        if (mScenes[sceneIndex]->getName() == name)
+        {
+            sceneToSave = mScenes[sceneIndex];
+            mActiveSceneIndex = sceneIndex;
+            break;
+        }
+    }
+
+    if (nullptr == sceneToSave)
+    {
+        if (mScenes.size() >= MAX_NUM_SCENES)
+        {
+            DEBUG_PRINTLN(F("Unable to save scene, too many scenes"));
+            return;
+        }
+
+        sceneToSave = new LightDisplayScene(name);
+        mScenes.push_back(sceneToSave);
+        mActiveSceneIndex = mScenes.size() - 1;
+    }
+
+    sceneToSave->capture(mLightedObjects);
+    saveScenesToFile();
+}
+
+/*
+** ============================================================================
+** Switches the display to the scene at the given index.  The scene keeps its
+** lighted objects instantiated so the switch is a swap of the object lists and
+** a re-layout of the addresses, the display crossfades to the new objects.  The
+** time this takes is measured and can be queried with getLastSceneSwitchMicros.
+**
+**  param   sceneIndex - index of the scene to activate
+** ============================================================================
+*/
+void LightDisplay::activateScene(int sceneIndex)
+{
+    if (sceneIndex < 0 || sceneIndex >= mScenes.size())
+    {
+        return;
+    }
+
+    uint32_t switchStartTime = micros();
+
+    // Normally this was already done in the background, if not it is part of the switch
+    LightDisplayScene* scene = mScenes[sceneIndex];
+    scene->prepareStandbyObjects(getPrimaryPixelWrapper());
+
+    LayoutList oldLayout = captureLayout();
+    scene->swapStandbyObjects(mLightedObjects);
+    resetLightedObjectAddresses();
+    startTransition(oldLayout, ChangedObjectList());
+
+    mLastSceneSwitchMicros = micros() - switchStartTime;
+    mMaxSceneSwitchMicros = max(mMaxSceneSwitchMicros, mLastSceneSwitchMicros);
+    mActiveSceneIndex = sceneIndex;
+
+    DEBUG_PRINT(F("Scene switch took (us): "));
+    DEBUG_PRINTLN(mLastSceneSwitchMicros);
+
+    saveToFile();
+}
+
+/*
+** ============================================================================
+** Deletes the scene at the given index
+**
+**  param   sceneIndex - index of the scene to delete
+** ============================================================================
+*/
+void LightDisplay::deleteScene(int sceneIndex)
+{
+    if (sceneIndex >= 0 && sceneIndex < mScenes.size())
+    {
+        delete mScenes[sceneIndex];
+        mScenes.erase(mScenes.begin() + sceneIndex);
+
+        if (mActiveSceneIndex == sceneIndex)
+        {
+            mActiveSceneIndex = -1;
+        }
+        else if (mActiveSceneIndex > sceneIndex)
+        {
+            --mActiveSceneIndex;
+        }
+
+        saveScenesToFile();
+    }
+}
+
 #if 0
 /*
 ** ============================================================================
@@ -346,8 +629,8 @@ void LightDisplay::serializeCurrentStateToJson(JsonObject &currentState) const
 */
 void LightDisplay::setBrightness(uint8_t newBrightness)
 {
-    // Early exit if neo pixel wrapper is not yet setup
-    if (nullptr == mNeoPixelWrapper)
+    // Early exit if the outputs are not yet setup
+    if (mOutputs.empty())
     {
         return;
     }
@@ -378,8 +661,10 @@ void LightDisplay::setBrightness(uint8_t newBrightness)
                 {
                     sShouldStartBus = false;
 
-                    const NeoPixelType pixelType = mSupportsWhiteChannel ? NeoPixelType_Grbw : NeoPixelType_Grb;
-                    mNeoPixelWrapper->Begin(pixelType, mMaxPixelsInDisplay);
+                    for (LightDisplayOutput* output : mOutputs)
+                    {
+                        output->begin(mSupportsWhiteChannel, mColorOrder);
+                    }
                 }
             #endif
         }
@@ -388,7 +673,7 @@ void LightDisplay::setBrightness(uint8_t newBrightness)
 
     // Apply the brightness change immediately if we have not just updated the LEDs
     uint32_t currentTime = millis();
-    if (currentTime - mLastShowTimestamp > MIN_FRAME_TIME_IN_MS)
+    if (currentTime - mLastShowTimestamp > mFramePacer.getFrameInterval() / 1000)
     {
         setBrightnessAndShow();
     }
@@ -398,20 +683,29 @@ void LightDisplay::setBrightness(uint8_t newBrightness)
 
 /*
 ** ============================================================================
-** Sets the RGB color order for the NeoPixelWrapper
+** Sets the number of frames per second the display tries to render
+** ============================================================================
+*/
+void LightDisplay::setTargetFps(uint8_t targetFps)
+{
+    mFramePacer.setTargetFps(targetFps);
+    mFramePacer.resetStatistics();
+    saveToFile();
+}
+
+/*
+** ============================================================================
+** Sets the RGB color order for the pixel wrapper of every output
 ** ============================================================================
 */
 void LightDisplay::setColorOrder(uint8_t newColorOrder)
 {
     mColorOrder = newColorOrder;
 
-    // Early exit if neo pixel wrapper is not yet setup
-    if (nullptr == mNeoPixelWrapper)
+    for (LightDisplayOutput* output : mOutputs)
     {
-        return;
+        output->getPixelWrapper()->SetColorOrder(newColorOrder);
     }
-
-    mNeoPixelWrapper->SetColorOrder(newColorOrder);
 }
 
 /*
@@ -421,34 +715,32 @@ void LightDisplay::setColorOrder(uint8_t newColorOrder)
 */
 uint8_t LightDisplay::getColorOrder()
 {
-    // Early exit if neo pixel wrapper is not yet setup
-    if (nullptr == mNeoPixelWrapper)
+    // Early exit if the outputs are not yet setup
+    if (mOutputs.empty())
     {
         return 0;
     }
 
-    return mNeoPixelWrapper->GetColorOrder();
+    return mOutputs[0]->getPixelWrapper()->GetColorOrder();
 }
 
 /*
 ** ============================================================================
-** Gets the color being displayed at a specific address
+** Gets the color being displayed at a specific display address.  The outputs
+** follow each other in the display addresses in the order of the outputs.
 ** ============================================================================
 */
 uint32_t LightDisplay::getPixelColor(uint16_t address) const
 {
-    // Early exit if neo pixel wrapper is not yet setup
-    if (nullptr == mNeoPixelWrapper)
-    {
-        return 0;
-    }
-
-    if (address > getNumberOfLEDs())
+    for (const LightDisplayOutput* output : mOutputs)
     {
-        return 0;
+        if (output->containsDisplayAddress(address))
+        {
+            return output->getPixelWrapper()->GetPixelColorRgbw(address - output->getFirstDisplayAddress());
+        }
     }
 
-    return mNeoPixelWrapper->GetPixelColorRgbw(address);
+    return 0;
 }
 
 /*
@@ -466,8 +758,8 @@ uint32_t LightDisplay::getPixelColor(uint16_t address) const
 */
 void LightDisplay::setBrightnessAndShow()
 {
-    // Early exit if neo pixel wrapper is not yet setup
-    if (nullptr == mNeoPixelWrapper)
+    // Early exit if the outputs are not yet setup
+    if (mOutputs.empty())
     {
         return;
     }
@@ -480,14 +772,18 @@ void LightDisplay::setBrightnessAndShow()
     {
         uint32_t puPerMilliamp = POWER_UNITS_PER_LED / actualMilliampsPerLed;
         uint32_t powerBudget = calculatePowerBudget(puPerMilliamp);
-        uint32_t basePowerConsumption = calculatePowerConsumption();
+        uint32_t basePowerConsumption = 0;
+        PROFILE_CALL(PROFILE_POWER_CALC, basePowerConsumption = calculatePowerConsumption());
     
         // This will either be the current brightness selected, or a downscaled
         // brightness that remains within the power budget
         uint8_t brightness = getPowerBudgetAllowedBrightness(powerBudget, basePowerConsumption);
 
         // Set the new brightness and calculate the current milliamps being used
-        mNeoPixelWrapper->SetBrightness(brightness);
+        for (LightDisplayOutput* output : mOutputs)
+        {
+            output->setBrightness(brightness);
+        }
 
         mCurrentMilliamps = (basePowerConsumption * brightness) / puPerMilliamp;
         mCurrentMilliamps += MILLIAMP_PER_MICROCONTROLLER; // add power of ESP back to estimate
@@ -496,14 +792,34 @@ void LightDisplay::setBrightnessAndShow()
     else
     {
         mCurrentMilliamps = 0;
-        mNeoPixelWrapper->SetBrightness(mCurrentBrightness);
+        for (LightDisplayOutput* output : mOutputs)
+        {
+            output->setBrightness(mCurrentBrightness);
+        }
     }
   
     // some buses send asynchronously and this method will return before
-    // all of the data has been sent.
+    // all of the data has been sent, so every output is started before we
+    // wait on any of them and the outputs transmit at the same time.  Outputs
+    // that did not change since they were last sent are skipped.
     // See https://github.com/Makuna/NeoPixelBus/wiki/ESP32-NeoMethods#neoesp32rmt-methods
-    mNeoPixelWrapper->Show();
+    uint16_t longestOutputPixels = 0;
+    uint32_t showStartTime = micros();
+    for (LightDisplayOutput* output : mOutputs)
+    {
+        if (output->isDirty() && output->getNumberOfLEDs() > longestOutputPixels)
+        {
+            longestOutputPixels = output->getNumberOfLEDs();
+        }
+        output->show();
+    }
     mLastShowTimestamp = mCurrentTimestamp;
+
+    // The time to send the LEDs limits how fast the frames can be paced
+    if (longestOutputPixels > 0)
+    {
+        mFramePacer.recordShow(micros() - showStartTime, longestOutputPixels, mSupportsWhiteChannel);
+    }
 }
 
 /*
@@ -576,25 +892,23 @@ uint32_t LightDisplay::calculatePowerBudget(uint8_t puPerMilliamp)
 */
 uint32_t LightDisplay::calculatePowerConsumption()
 {
-    // Early exit if neo pixel wrapper is not yet setup
-    if (nullptr == mNeoPixelWrapper)
-    {
-        return 0;
-    }
-
-    //sum up the usage of each LED
+    //sum up the usage of each LED on every output
     uint32_t powerSum = 0;
-    for (uint16_t i = 0; i < mMaxPixelsInDisplay; i++) 
+    for (LightDisplayOutput* output : mOutputs)
     {
-        RgbwColor color = mNeoPixelWrapper->GetPixelColorRaw(i);
-        if(useWS2815PowerModel())
-        {
-            // ignore white component on WS2815 power calculation
-            powerSum += (max(max(color.R,color.G),color.B)) * 3;
-        }
-        else 
+        NeoPixelWrapper* pixelWrapper = output->getPixelWrapper();
+        for (uint16_t i = 0; i < output->getNumberOfLEDs(); i++) 
         {
-            powerSum += (color.R + color.G + color.B + color.W);
+            RgbwColor color = pixelWrapper->GetPixelColorRaw(i);
+            if(useWS2815PowerModel())
+            {
+                // ignore white component on WS2815 power calculation
+                powerSum += (max(max(color.R,color.G),color.B)) * 3;
+            }
+            else 
+            {
+                powerSum += (color.R + color.G + color.B + color.W);
+            }
         }
     }
 
@@ -671,6 +985,78 @@ uint16_t LightDisplay::getNumberOfLEDs() const
     return mMaxPixelsInDisplay;
 }
 
+/*
+** ============================================================================
+** Creates and starts an output for every entry of the output configuration.
+** Without a configuration all LEDs are on a single output on LEDPIN.  Outputs
+** that would go past MAX_LEDS are ignored.  The display addresses of the outputs
+** follow each other and the lighted objects are laid out on the new outputs.
+** ============================================================================
+*/
+void LightDisplay::beginOutputs()
+{
+    releaseOutputs();
+
+    OutputConfigList outputConfig = mOutputConfig;
+    if (outputConfig.empty())
+    {
+        OutputConfig defaultOutput;
+        defaultOutput.pin = LEDPIN;
+        defaultOutput.numPixels = mDefaultOutputNumPixels;
+        outputConfig.push_back(defaultOutput);
+    }
+
+    uint32_t firstDisplayAddress = 0;
+    for (const OutputConfig& config : outputConfig)
+    {
+        if (firstDisplayAddress + config.numPixels > MAX_LEDS)
+        {
+            DEBUG_PRINTLN(F("Ignoring output, too many LEDs"));
+            break;
+        }
+
+        LightDisplayOutput* output = new LightDisplayOutput(mOutputs.size(), config.pin, config.numPixels, firstDisplayAddress);
+        output->begin(mSupportsWhiteChannel, mColorOrder);
+        mOutputs.push_back(output);
+        firstDisplayAddress += config.numPixels;
+    }
+    mMaxPixelsInDisplay = firstDisplayAddress;
+
+    // Standby objects of the scenes still refer to the old pixel wrappers
+    for (LightDisplayScene* scene : mScenes)
+    {
+        scene->releaseStandbyObjects();
+    }
+
+    resetLightedObjectAddresses();
+}
+
+/*
+** ============================================================================
+** Stops and deletes every output
+** ============================================================================
+*/
+void LightDisplay::releaseOutputs()
+{
+    for (LightDisplayOutput* output : mOutputs)
+    {
+        delete output;
+    }
+
+    mOutputs.clear();
+}
+
+/*
+** ============================================================================
+** Returns the pixel wrapper of the first output.  This is handed to new lighted
+** objects, they get the wrapper of their own output when they are laid out.
+** ============================================================================
+*/
+NeoPixelWrapper* LightDisplay::getPrimaryPixelWrapper() const
+{
+    return mOutputs.empty() ? nullptr : mOutputs[0]->getPixelWrapper();
+}
+
 /*
 ** ============================================================================
 ** Updates the mLightedObjects list to swap the objects in the two given indices
@@ -693,130 +1079,696 @@ void LightDisplay::swapLightedObjects(int firstIndex, int otherIndex)
 
 /*
 ** ============================================================================
-** This will iterate over the list of lighted objects and reset their addresses
-** so that the object addresses are in the order of the objects in our list.
+** Records a change to the lighted objects for the batch in progress
+**
+**  param   changedObject - object whose parameters changed (or nullptr)
+**  param   layoutChanged - true if objects were added, removed, moved or resized
 ** ============================================================================
 */
-void LightDisplay::resetLightedObjectAddresses()
+void LightDisplay::markObjectsChanged(const ILightedObject* changedObject, bool layoutChanged)
 {
-    int newStartingAddress = 0;
-    for (ILightedObject* lightedObject : mLightedObjects)
+    mBatchHasChanges = true;
+    mBatchLayoutChanged = mBatchLayoutChanged || layoutChanged;
+    if (nullptr != changedObject)
     {
-        lightedObject->setStartingLEDNumber(newStartingAddress);
-        newStartingAddress += lightedObject->getNumberOfLEDs();
+        mBatchChangedObjects.push_back(changedObject);
     }
 }
 
 /*
 ** ============================================================================
-** Sets all LEDs in the display to black and forces the update to reset everything.
-** This can be called any time we update the lighted objects that make up the
-** display.
+** This will iterate over the list of lighted objects and reset their addresses
+** so that the object addresses are in the order of the objects in our list.
+** Every output is addressed from 0, so an object is placed after the objects
+** before it in the list that are on the same output.  Objects on an output
+** that does not exist are kept but are not drawn.
 ** ============================================================================
 */
-void LightDisplay::resetAllLeds()
+void LightDisplay::resetLightedObjectAddresses()
 {
-    // Early exit if we don't have a valid neo pixel wrapper
-    if (nullptr == mNeoPixelWrapper)
+    uint32_t newStartingAddress[MAX_NUM_OUTPUTS] = { 0 };
+    for (ILightedObject* lightedObject : mLightedObjects)
     {
-        return;
+        uint8_t outputIndex = lightedObject->getOutput();
+        if (outputIndex < mOutputs.size())
+        {
+            lightedObject->setNeoPixelWrapper(mOutputs[outputIndex]->getPixelWrapper());
+            lightedObject->setStartingLEDNumber(newStartingAddress[outputIndex]);
+            newStartingAddress[outputIndex] += lightedObject->getNumberOfLEDs();
+        }
+        else
+        {
+            lightedObject->setNeoPixelWrapper(nullptr);
+            lightedObject->setStartingLEDNumber(0);
+        }
     }
 
-    // Set all LEDs to black
-    RgbwColor noColor = 0x00000000; // Black
-    for (int address = 0; address < mMaxPixelsInDisplay; ++address)
+    for (LightDisplayOutput* output : mOutputs)
     {
-        mNeoPixelWrapper->SetPixelColor(address, noColor);
+        output->setNumberOfObjectLEDs(min(newStartingAddress[output->getOutputIndex()], output->getNumberOfLEDs()));
     }
-
-    // Force the update
-    setBrightnessAndShow();
 }
 
 /*
 ** ============================================================================
-** Writes all of the light display details to a save file so that it can be
-** reloaded in future sessions.
+** Records where each lighted object currently sits in the display so that the
+** layout can be compared after the list of objects has been modified.
 ** ============================================================================
 */
-void LightDisplay::saveToFile() const
+LightDisplay::LayoutList LightDisplay::captureLayout() const
 {
-    File fileHandle = WLED_FS.open(SAVE_FILE_NAME, "w");
-    if (fileHandle)
+    LayoutList layout;
+    layout.reserve(mLightedObjects.size());
+
+    for (ILightedObject* lightedObject : mLightedObjects)
+    {
+        ObjectLayout objectLayout;
+        objectLayout.object = lightedObject;
+        objectLayout.output = lightedObject->getOutput();
+        objectLayout.startingAddress = lightedObject->getStartingLEDNumber();
+        objectLayout.numPixels = lightedObject->getNumberOfLEDs();
+        layout.push_back(objectLayout);
+    }
+
+    return layout;
+}
+
+/*
+** ============================================================================
+** Starts a crossfade from the frame currently on the LEDs to the frames that
+** will be rendered with the new list of lighted objects.  Only the address
+** ranges that actually changed are faded, objects that kept their place keep
+** running their effect untouched.  An address range has changed if:
+**  - an object was added, moved, resized or is the changedObject
+**  - an object was removed (its old range fades to black)
+**
+** Every output runs its own transition.  If transitions are disabled (duration
+** of 0) or there is not enough memory for the snapshot of an output the changed
+** ranges of that output are blanked immediately instead.
+**
+**  param   oldLayout - layout captured before the lighted objects changed
+**  param   changedObjects - objects whose parameters changed
+** ============================================================================
+*/
+void LightDisplay::startTransition(const LayoutList& oldLayout, const ChangedObjectList& changedObjects)
+{
+    mCurrentTimestamp = millis();
+    for (LightDisplayOutput* output : mOutputs)
     {
-        // Create JSON Document to store all the details of the light display
-        DynamicJsonDocument doc(JSON_BUFFER_SIZE);
+        output->getTransition().begin(output->getPixelWrapper(), output->getNumberOfLEDs(), mSupportsWhiteChannel, mCurrentTimestamp, mTransitionDuration);
+    }
 
-        // Save info specific to the Light Display itself
-        JsonObject rootObject = doc.createNestedObject(LIGHT_DISPLAY_ROOT_ELEMENT);
-        rootObject[CURRENT_BRIGHTNESS_ELEMENT] = mCurrentBrightness;
-        rootObject[SUPPORTS_WHITE_ELEMENT] = mSupportsWhiteChannel;
-        rootObject[REVERSE_MODE_ELEMENT] = mReverseModeEnabled;
-        rootObject[RGBW_MODE_ELEMENT] = mRgbwMode;
-        rootObject[GAMMA_CORRECT_BRIGHTNESS_ELEMENT] = mGammaCorrectBrightness;
-        rootObject[GAMMA_CORRECT_COLOR_ELEMENT] = mGammaCorrectColor;
-        rootObject[MAX_MILLIAMPS_ELEMENT] = mMaxMilliamps;
+    // Objects in the new layout that were added or changed place
+    for (ILightedObject* lightedObject : mLightedObjects)
+    {
+        uint8_t outputIndex = lightedObject->getOutput();
+        uint16_t startingAddress = lightedObject->getStartingLEDNumber();
+        uint16_t numPixels = lightedObject->getNumberOfLEDs();
 
-        // Iterate over every lighted object and store the details for those objects
-        JsonArray lightedObjectArray = rootObject.createNestedArray(LIGHTED_OBJECTS_ARRAY_ELEMENT);
+        bool isUnchanged = false;
+        for (const ObjectLayout& oldObject : oldLayout)
+        {
+            if (oldObject.object == lightedObject)
+            {
+                isUnchanged = (std::find(changedObjects.begin(), changedObjects.end(), lightedObject) == changedObjects.end() &&
+                               oldObject.output == outputIndex &&
+                               oldObject.startingAddress == startingAddress &&
+                               oldObject.numPixels == numPixels);
+                if (!isUnchanged)
+                {
+                    addAffectedRange(oldObject.output, oldObject.startingAddress, oldObject.numPixels);
+                }
+                break;
+            }
+        }
+
+        if (!isUnchanged)
+        {
+            addAffectedRange(outputIndex, startingAddress, numPixels);
+        }
+    }
+
+    // Objects that are no longer part of the display
+    for (const ObjectLayout& oldObject : oldLayout)
+    {
+        bool isRemoved = true;
         for (ILightedObject* lightedObject : mLightedObjects)
         {
-            if (nullptr != lightedObject)
+            if (oldObject.object == lightedObject)
             {
-                JsonObject lightedObjectJson = lightedObjectArray.createNestedObject();
-                lightedObject->serializeCurrentStateToJson(lightedObjectJson);
+                isRemoved = false;
+                break;
             }
         }
 
-        // Write the JSON document to our save file
-        serializeJson(doc, fileHandle);
-        fileHandle.close();
+        if (isRemoved)
+        {
+            addAffectedRange(oldObject.output, oldObject.startingAddress, oldObject.numPixels);
+        }
+    }
+
+    bool isShowRequired = false;
+    for (LightDisplayOutput* output : mOutputs)
+    {
+        LightDisplayTransition& transition = output->getTransition();
+        if (transition.isActive())
+        {
+            // The first blended frame is shown by the next runEffect
+            if (!transition.hasAffectedRanges())
+            {
+                transition.end();
+            }
+        }
+        else if (transition.hasAffectedRanges())
+        {
+            // No fade, blank every changed address and force the update
+            transition.blankAffectedRanges(output->getPixelWrapper(), output->getNumberOfLEDs());
+            output->markDirty();
+            isShowRequired = true;
+        }
+    }
+
+    if (isShowRequired)
+    {
+        setBrightnessAndShow();
+    }
+}
+
+/*
+** ============================================================================
+** Adds an address range to the transition of the given output
+**
+**  param   output - index of the output the addresses belong to
+**  param   startingAddress - first address of the range on that output
+**  param   numPixels - number of addresses in the range
+** ============================================================================
+*/
+void LightDisplay::addAffectedRange(uint8_t output, uint16_t startingAddress, uint16_t numPixels)
+{
+    if (output < mOutputs.size())
+    {
+        mOutputs[output]->getTransition().addAffectedRange(startingAddress, numPixels);
+    }
+}
+
+/*
+** ============================================================================
+** Marks the output with the given index as changed so it is sent on the next
+** show.  Objects on an output that does not exist are ignored.
+** ============================================================================
+*/
+void LightDisplay::markOutputDirty(uint8_t output)
+{
+    if (output < mOutputs.size())
+    {
+        mOutputs[output]->markDirty();
+    }
+}
+
+/*
+** ============================================================================
+** Prepares the standby objects for the first scene that needs them.  Only one
+** scene is prepared per call so that a single frame is never delayed by more
+** than one scene worth of object construction.
+** ============================================================================
+*/
+void LightDisplay::prepareStandbyScenes()
+{
+    for (LightDisplayScene* scene : mScenes)
+    {
+        if (!scene->isStandbyReady())
+        {
+            scene->prepareStandbyObjects(getPrimaryPixelWrapper());
+            return;
+        }
+    }
+}
+
+/*
+** ============================================================================
+** Writes the light display and its lighted objects into the given JSON object
+** in the same form lightDisplay.json used to have.  This is only used to
+** export the display over HTTP, it is saved in the binary save file.
+**
+**  param   root - JSON object to add the light display element to
+** ============================================================================
+*/
+void LightDisplay::serializeToJson(JsonObject root) const
+{
+    // Save info specific to the Light Display itself
+    JsonObject rootObject = root.createNestedObject(LIGHT_DISPLAY_ROOT_ELEMENT);
+    rootObject[CURRENT_BRIGHTNESS_ELEMENT] = mCurrentBrightness;
+    rootObject[SUPPORTS_WHITE_ELEMENT] = mSupportsWhiteChannel;
+    rootObject[REVERSE_MODE_ELEMENT] = mReverseModeEnabled;
+    rootObject[RGBW_MODE_ELEMENT] = mRgbwMode;
+    rootObject[GAMMA_CORRECT_BRIGHTNESS_ELEMENT] = mGammaCorrectBrightness;
+    rootObject[GAMMA_CORRECT_COLOR_ELEMENT] = mGammaCorrectColor;
+    rootObject[MAX_MILLIAMPS_ELEMENT] = mMaxMilliamps;
+    rootObject[TRANSITION_DURATION_ELEMENT] = mTransitionDuration;
+    rootObject[TARGET_FPS_ELEMENT] = mFramePacer.getTargetFps();
+
+    // Without configured outputs the display uses LEDPIN and the LED count from the settings
+    if (!mOutputConfig.empty())
+    {
+        JsonArray outputsArray = rootObject.createNestedArray(OUTPUTS_ARRAY_ELEMENT);
+        for (const OutputConfig& outputConfig : mOutputConfig)
+        {
+            JsonObject outputJson = outputsArray.createNestedObject();
+            outputJson[OUTPUT_PIN_ELEMENT] = outputConfig.pin;
+            outputJson[OUTPUT_NUM_LEDS_ELEMENT] = outputConfig.numPixels;
+        }
+    }
+
+    // Iterate over every lighted object and store the details for those objects
+    JsonArray lightedObjectArray = rootObject.createNestedArray(LIGHTED_OBJECTS_ARRAY_ELEMENT);
+    for (ILightedObject* lightedObject : mLightedObjects)
+    {
+        if (nullptr != lightedObject)
+        {
+            JsonObject lightedObjectJson = lightedObjectArray.createNestedObject();
+            lightedObject->serializeCurrentStateToJson(lightedObjectJson);
+        }
+    }
+}
+
+/*
+** ============================================================================
+** Replaces the whole light display with one exported by serializeToJson.  The
+** outputs are restarted, the display is saved and shown straight away.
+**
+**  param   root - JSON object holding the light display element
+** ============================================================================
+*/
+void LightDisplay::importFromJson(JsonObject root)
+{
+    for (ILightedObject* lightedObject : mLightedObjects)
+    {
+        delete lightedObject;
+    }
+    mLightedObjects.clear();
+
+    // The display no longer matches any scene
+    mActiveSceneIndex = -1;
+
+    readFromJson(root);
+
+    beginOutputs();
+    saveToFile();
+    setBrightnessAndShow();
+}
+
+/*
+** ============================================================================
+** Reads the light display settings, outputs and lighted objects from the JSON
+** form written by serializeToJson.  The lighted objects are appended to the
+** current list and still have to be laid out.
+**
+**  param   root - JSON object holding the light display element
+** ============================================================================
+*/
+void LightDisplay::readFromJson(JsonObject root)
+{
+    JsonObject rootObject = root[LIGHT_DISPLAY_ROOT_ELEMENT];
+    POPULATE_FROM_JSON(mCurrentBrightness, rootObject[CURRENT_BRIGHTNESS_ELEMENT]);
+    POPULATE_FROM_JSON(mSupportsWhiteChannel, rootObject[SUPPORTS_WHITE_ELEMENT]);
+    POPULATE_FROM_JSON(mReverseModeEnabled, rootObject[REVERSE_MODE_ELEMENT]);
+    POPULATE_FROM_JSON(mRgbwMode, rootObject[RGBW_MODE_ELEMENT]);
+    POPULATE_FROM_JSON(mGammaCorrectBrightness, rootObject[GAMMA_CORRECT_BRIGHTNESS_ELEMENT]);
+    POPULATE_FROM_JSON(mGammaCorrectColor, rootObject[GAMMA_CORRECT_COLOR_ELEMENT]);
+    POPULATE_FROM_JSON(mMaxMilliamps, rootObject[MAX_MILLIAMPS_ELEMENT]);
+    POPULATE_FROM_JSON(mTransitionDuration, rootObject[TRANSITION_DURATION_ELEMENT]);
+    mFramePacer.setTargetFps(rootObject[TARGET_FPS_ELEMENT] | mFramePacer.getTargetFps());
+
+    mOutputConfig.clear();
+    JsonArray outputsArray = rootObject[OUTPUTS_ARRAY_ELEMENT];
+    for (JsonObject outputJson : outputsArray)
+    {
+        OutputConfig outputConfig;
+        outputConfig.pin = outputJson[OUTPUT_PIN_ELEMENT] | LEDPIN;
+        outputConfig.numPixels = outputJson[OUTPUT_NUM_LEDS_ELEMENT] | 0;
+        if (outputConfig.numPixels > 0 && mOutputConfig.size() < MAX_NUM_OUTPUTS)
+        {
+            mOutputConfig.push_back(outputConfig);
+        }
+    }
+
+    // Recreate each lighted object in the JSON document
+    JsonArray lightedObjectArray = rootObject[LIGHTED_OBJECTS_ARRAY_ELEMENT];
+    for (JsonObject lightedObjectJson : lightedObjectArray)
+    {
+        String objectType = lightedObjectJson[ILightedObject::TYPE_ELEMENT];
+        ILightedObject* newObject = LightedObjectFactory::get().createLightedObject(objectType.c_str(), getPrimaryPixelWrapper());
+        if (nullptr != newObject)
+        {
+            newObject->deserializeAndApplyStateFromJson(lightedObjectJson);
+            mLightedObjects.push_back(newObject);
+        }
+    }
+}
+
+/*
+** ============================================================================
+** Writes all of the light display details to a save file so that it can be
+** reloaded in future sessions.  The file starts with a small header (magic
+** bytes and version) followed by the display settings, the outputs and, for
+** each lighted object, its type and its binary state (length prefixed so
+** unknown object types can be skipped).  The UI elements of the objects are
+** not saved, they are rebuilt from the object's values.
+**
+** The file is written to a temporary file that is then renamed over the save
+** file, so a failed write or a power cut leaves the previous save as it was.
+**
+**  returns true if the save file was written
+** ============================================================================
+*/
+bool LightDisplay::saveToFile() const
+{
+    PROFILE_SCOPE(PROFILE_SAVE_DISPLAY);
+
+    // The whole file is built in memory before the save file is truncated
+    BinaryWriter writer;
+    writer.writeUInt8('L');
+    writer.writeUInt8('D');
+    writer.writeUInt8('D');
+    writer.writeUInt8(SAVE_FILE_VERSION);
+
+    uint8_t flags = (mSupportsWhiteChannel ? 0x01 : 0x00)
+                  | (mReverseModeEnabled ? 0x02 : 0x00)
+                  | (mGammaCorrectBrightness ? 0x04 : 0x00)
+                  | (mGammaCorrectColor ? 0x08 : 0x00);
+    writer.writeUInt8(flags);
+    writer.writeUInt8(mCurrentBrightness);
+    writer.writeUInt8(mRgbwMode);
+    writer.writeVarUInt(mMaxMilliamps);
+    writer.writeVarUInt(mTransitionDuration);
+    writer.writeUInt8(mFramePacer.getTargetFps());
+
+    // Without configured outputs the display uses LEDPIN and the LED count from the settings
+    writer.writeVarUInt(mOutputConfig.size());
+    for (const OutputConfig& outputConfig : mOutputConfig)
+    {
+        writer.writeUInt8(outputConfig.pin);
+        writer.writeVarUInt(outputConfig.numPixels);
+    }
+
+    uint32_t numLightedObjects = 0;
+    for (ILightedObject* lightedObject : mLightedObjects)
+    {
+        if (nullptr != lightedObject)
+        {
+            ++numLightedObjects;
+        }
     }
+
+    BinaryWriter objectWriter;
+    writer.writeVarUInt(numLightedObjects);
+    for (ILightedObject* lightedObject : mLightedObjects)
+    {
+        if (nullptr != lightedObject)
+        {
+            objectWriter.clear();
+            lightedObject->serializeBinary(objectWriter);
+
+            writer.writeString(lightedObject->getObjectType());
+            writer.writeVarUInt(objectWriter.getBuffer().size());
+            writer.writeBytes(objectWriter.getBuffer().data(), objectWriter.getBuffer().size());
+        }
+    }
+
+    File fileHandle = WLED_FS.open(TEMP_SAVE_FILE_NAME, "w");
+    if (!fileHandle)
+    {
+        return false;
+    }
+
+    size_t bytesWritten = fileHandle.write(writer.getBuffer().data(), writer.getBuffer().size());
+    fileHandle.close();
+
+    if (bytesWritten != writer.getBuffer().size() || !WLED_FS.rename(TEMP_SAVE_FILE_NAME, SAVE_FILE_NAME))
+    {
+        DEBUG_PRINTLN(F("Failed to save light display"));
+        WLED_FS.remove(TEMP_SAVE_FILE_NAME);
+        return false;
+    }
+
+    return true;
 }
 
 /*
 ** ============================================================================
 ** Reads the save file to load the light display from the previous session.
+** A lightDisplay.json, saved by an older version or uploaded with the editor,
+** takes precedence.  It is imported once, saved in the binary save file and
+** only removed once that save succeeded.  A JSON file that can not be read is
+** left where it is and the binary save file is loaded instead.
 ** ============================================================================
 */
 void LightDisplay::loadFromFile()
 {
-    if (WLED_FS.exists(SAVE_FILE_NAME))
-    {
-        File fileHandle = WLED_FS.open(SAVE_FILE_NAME, "r");
-        if (fileHandle)
-        {
-            // Create a JSON document for our light display and deserialize the
-            // contents of the save file into that document
-            DynamicJsonDocument doc(JSON_BUFFER_SIZE);
-            deserializeJson(doc, fileHandle);
-
-            // Use the JSON document to reconstruct our light display
-            JsonObject rootObject = doc[LIGHT_DISPLAY_ROOT_ELEMENT];
-            POPULATE_FROM_JSON(mCurrentBrightness, rootObject[CURRENT_BRIGHTNESS_ELEMENT]);
-            POPULATE_FROM_JSON(mSupportsWhiteChannel, rootObject[SUPPORTS_WHITE_ELEMENT]);
-            POPULATE_FROM_JSON(mReverseModeEnabled, rootObject[REVERSE_MODE_ELEMENT]);
-            POPULATE_FROM_JSON(mRgbwMode, rootObject[RGBW_MODE_ELEMENT]);
-            POPULATE_FROM_JSON(mGammaCorrectBrightness, rootObject[GAMMA_CORRECT_BRIGHTNESS_ELEMENT]);
-            POPULATE_FROM_JSON(mGammaCorrectColor, rootObject[GAMMA_CORRECT_COLOR_ELEMENT]);
-            POPULATE_FROM_JSON(mMaxMilliamps, rootObject[MAX_MILLIAMPS_ELEMENT]);
-
-            // Recreate each lighted object in the JSON document
-            JsonArray lightedObjectArray = rootObject[LIGHTED_OBJECTS_ARRAY_ELEMENT];
-            for (JsonObject lightedObjectJson : lightedObjectArray)
+    if (WLED_FS.exists(JSON_FILE_NAME))
+    {
+        if (loadFromJsonFile())
+        {
+            if (saveToFile())
             {
-                String objectType = lightedObjectJson[ILightedObject::TYPE_ELEMENT];
-                ILightedObject* newObject = LightedObjectFactory::get().createLightedObject(objectType.c_str(), mNeoPixelWrapper);
-                if (nullptr != newObject)
-                {
-                    newObject->deserializeAndApplyStateFromJson(lightedObjectJson);
-                    mLightedObjects.push_back(newObject);
-                }
+                WLED_FS.remove(JSON_FILE_NAME);
             }
+            return;
+        }
 
-            // Now that we have all of the objects created, reset the object addresses
-            resetLightedObjectAddresses();
-            fileHandle.close();
+        DEBUG_PRINTLN(F("Failed to read lightDisplay.json, loading the save file"));
+    }
+
+    if (!WLED_FS.exists(SAVE_FILE_NAME))
+    {
+        return;
+    }
+
+    File fileHandle = WLED_FS.open(SAVE_FILE_NAME, "r");
+    if (!fileHandle)
+    {
+        return;
+    }
+
+    std::vector<uint8_t> fileData(fileHandle.size());
+    size_t bytesRead = fileHandle.read(fileData.data(), fileData.size());
+    fileHandle.close();
+
+    BinaryReader reader(fileData.data(), bytesRead);
+
+    uint8_t header[4] = { 0 };
+    reader.readBytes(header, sizeof(header));
+    if (header[0] != 'L' || header[1] != 'D' || header[2] != 'D' || header[3] != SAVE_FILE_VERSION)
+    {
+        DEBUG_PRINTLN(F("Ignoring light display file with unknown format"));
+        return;
+    }
+
+    uint8_t flags = 0;
+    uint8_t targetFps = mFramePacer.getTargetFps();
+    uint32_t maxMilliamps = mMaxMilliamps;
+    uint32_t transitionDuration = mTransitionDuration;
+    reader.readUInt8(flags);
+    reader.readUInt8(mCurrentBrightness);
+    reader.readUInt8(mRgbwMode);
+    reader.readVarUInt(maxMilliamps);
+    reader.readVarUInt(transitionDuration);
+    reader.readUInt8(targetFps);
+    if (!reader.isValid())
+    {
+        return;
+    }
+
+    mSupportsWhiteChannel = (flags & 0x01) != 0;
+    mReverseModeEnabled = (flags & 0x02) != 0;
+    mGammaCorrectBrightness = (flags & 0x04) != 0;
+    mGammaCorrectColor = (flags & 0x08) != 0;
+    mMaxMilliamps = maxMilliamps;
+    mTransitionDuration = transitionDuration;
+    mFramePacer.setTargetFps(targetFps);
+
+    mOutputConfig.clear();
+    uint32_t numOutputs = 0;
+    reader.readVarUInt(numOutputs);
+    for (uint32_t outputIndex = 0; outputIndex < numOutputs && reader.isValid(); ++outputIndex)
+    {
+        OutputConfig outputConfig;
+        uint32_t numPixels = 0;
+        if (reader.readUInt8(outputConfig.pin) && reader.readVarUInt(numPixels))
+        {
+            outputConfig.numPixels = numPixels;
+            if (outputConfig.numPixels > 0 && mOutputConfig.size() < MAX_NUM_OUTPUTS)
+            {
+                mOutputConfig.push_back(outputConfig);
+            }
+        }
+    }
+
+    // Recreate each lighted object, an object type this build does not know is skipped
+    uint32_t numLightedObjects = 0;
+    reader.readVarUInt(numLightedObjects);
+    for (uint32_t objectIndex = 0; objectIndex < numLightedObjects && reader.isValid(); ++objectIndex)
+    {
+        std::string objectType;
+        uint32_t objectLength = 0;
+        if (!reader.readString(objectType) || !reader.readVarUInt(objectLength))
+        {
+            break;
+        }
+
+        const uint8_t* objectData = reader.getCurrentPosition();
+        if (!reader.skip(objectLength))
+        {
+            break;
+        }
+        BinaryReader objectReader(objectData, objectLength);
+
+        ILightedObject* newObject = LightedObjectFactory::get().createLightedObject(objectType, getPrimaryPixelWrapper());
+        if (nullptr != newObject)
+        {
+            newObject->deserializeBinary(objectReader);
+            mLightedObjects.push_back(newObject);
         }
     }
+
+    // Now that we have all of the objects created, reset the object addresses
+    resetLightedObjectAddresses();
+}
+
+/*
+** ============================================================================
+** Reads lightDisplay.json into the light display
+**
+**  returns false if the file could not be read
+** ============================================================================
+*/
+bool LightDisplay::loadFromJsonFile()
+{
+    File fileHandle = WLED_FS.open(JSON_FILE_NAME, "r");
+    if (!fileHandle)
+    {
+        return false;
+    }
+
+    // Create a JSON document for our light display and deserialize the
+    // contents of the file into that document
+    JsonDocumentLease doc;
+    if (!doc.isValid())
+    {
+        fileHandle.close();
+        return false;
+    }
+
+    DeserializationError error = deserializeJson(*doc, fileHandle);
+    fileHandle.close();
+    if (error)
+    {
+        return false;
+    }
+
+    // Use the JSON document to reconstruct our light display
+    readFromJson(doc->as<JsonObject>());
+
+    // Now that we have all of the objects created, reset the object addresses
+    resetLightedObjectAddresses();
+    return true;
+}
+
+/*
+** ============================================================================
+** Writes all scenes to the scenes save file.  The file starts with a small
+** header (magic bytes and version) followed by the number of scenes and, for
+** each scene, its name and its binary snapshot.  Like the display's save file
+** it is written to a temporary file that is renamed over the previous one.
+** ============================================================================
+*/
+void LightDisplay::saveScenesToFile() const
+{
+    PROFILE_SCOPE(PROFILE_SAVE_DISPLAY);
+    BinaryWriter writer;
+    writer.writeUInt8('L');
+    writer.writeUInt8('D');
+    writer.writeUInt8('S');
+    writer.writeUInt8(SCENES_FILE_VERSION);
+
+    writer.writeVarUInt(mScenes.size());
+    for (LightDisplayScene* scene : mScenes)
+    {
+        const LightDisplayScene::SnapshotData& snapshot = scene->getSnapshot();
+        writer.writeString(scene->getName());
+        writer.writeVarUInt(snapshot.size());
+        writer.writeBytes(snapshot.data(), snapshot.size());
+    }
+
+    File fileHandle = WLED_FS.open(TEMP_SCENES_FILE_NAME, "w");
+    if (!fileHandle)
+    {
+        return;
+    }
+
+    size_t bytesWritten = fileHandle.write(writer.getBuffer().data(), writer.getBuffer().size());
+    fileHandle.close();
+
+    if (bytesWritten != writer.getBuffer().size() || !WLED_FS.rename(TEMP_SCENES_FILE_NAME, SCENES_FILE_NAME))
+    {
+        DEBUG_PRINTLN(F("Failed to save scenes"));
+        WLED_FS.remove(TEMP_SCENES_FILE_NAME);
+    }
+}
+
+/*
+** ============================================================================
+** Reads the scenes save file and preloads every scene so that it can be
+** activated without touching the file system.
+** ============================================================================
+*/
+void LightDisplay::loadScenesFromFile()
+{
+    if (!WLED_FS.exists(SCENES_FILE_NAME))
+    {
+        return;
+    }
+
+    File fileHandle = WLED_FS.open(SCENES_FILE_NAME, "r");
+    if (!fileHandle)
+    {
+        return;
+    }
+
+    std::vector<uint8_t> fileData(fileHandle.size());
+    size_t bytesRead = fileHandle.read(fileData.data(), fileData.size());
+    fileHandle.close();
+
+    BinaryReader reader(fileData.data(), bytesRead);
+
+    uint8_t header[4] = { 0 };
+    reader.readBytes(header, sizeof(header));
+    if (header[0] != 'L' || header[1] != 'D' || header[2] != 'S' || header[3] != SCENES_FILE_VERSION)
+    {
+        DEBUG_PRINTLN(F("Ignoring scenes file with unknown format"));
+        return;
+    }
+
+    uint32_t numScenes = 0;
+    reader.readVarUInt(numScenes);
+    for (uint32_t sceneIndex = 0; sceneIndex < numScenes && mScenes.size() < MAX_NUM_SCENES; ++sceneIndex)
+    {
+        std::string sceneName;
+        uint32_t snapshotLength = 0;
+        if (!reader.readString(sceneName) || !reader.readVarUInt(snapshotLength))
+        {
+            break;
+        }
+
+        const uint8_t* snapshotData = reader.getCurrentPosition();
+        if (!reader.skip(snapshotLength))
+        {
+            break;
+        }
+
+        LightDisplayScene* scene = new LightDisplayScene(sceneName);
+        scene->setSnapshot(snapshotData, snapshotLength);
+        scene->prepareStandbyObjects(getPrimaryPixelWrapper());
+        mScenes.push_back(scene);
+    }
 }
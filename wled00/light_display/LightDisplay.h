@@ -3,6 +3,10 @@
 
 #include "Arduino.h"
 #include "NpbWrapper.h"
+#include "LightDisplayFramePacer.h"
+#include "LightDisplayOutput.h"
+#include "LightDisplayScene.h"
+#include "LightDisplayTransition.h"
 
 #include <string>
 #include <vector>
@@ -17,12 +21,27 @@ class ILightedObject;
 ** owns all of those lighted objects and can add/remove them and tell each object
 ** what its starting address is.  This also contains some configuration settings
 ** for the display as a whole.
+**
+** The LEDs can be split over several outputs (data pins).  Each lighted object
+** says which output it is connected to and its addresses are relative to that
+** output.  All outputs are shown back to back so, with hardware that transmits
+** asynchronously, a frame takes as long as the longest output instead of the
+** sum of all of them.
 **-----------------------------------------------------------------------------
 */ 
 class LightDisplay
 {
     public:
         typedef std::vector<ILightedObject*> LightedObjectList;
+        typedef std::vector<LightDisplayScene*> SceneList;
+        typedef std::vector<LightDisplayOutput*> OutputList;
+
+        struct OutputConfig
+        {
+            uint8_t     pin;
+            uint16_t    numPixels;
+        };
+        typedef std::vector<OutputConfig> OutputConfigList;
 
         LightDisplay();
         virtual ~LightDisplay();
@@ -32,6 +51,11 @@ class LightDisplay
 
         void createLightedObject(std::string objectType);
 
+        // Changes to the lighted objects between beginBatch and endBatch are laid out,
+        // saved and shown once, at endBatch
+        void beginBatch();
+        void endBatch();
+
         const LightedObjectList getLightedObjects() const { return mLightedObjects; }
 
         void clearAllObjects();
@@ -39,10 +63,29 @@ class LightDisplay
         void moveObjectDown(int originalIndex);
         void moveObjectUp(int originalIndex);
         void togglePower(int objectIndex);
+        void setObjectBaking(int objectIndex, bool enabled);
         void updateObject(int objectIndex, const char* userInputValues);
 
         ILightedObject* getLightedObject(int objectIndex);
 
+        // Output management
+        void configureOutputs(const OutputConfigList& outputConfig);
+        const OutputList& getOutputs() const { return mOutputs; }
+
+        // Scene management
+        void saveScene(const char* sceneName);
+        void activateScene(int sceneIndex);
+        void deleteScene(int sceneIndex);
+
+        const SceneList& getScenes() const { return mScenes; }
+        int8_t getActiveSceneIndex() const { return mActiveSceneIndex; }
+        uint32_t getLastSceneSwitchMicros() const { return mLastSceneSwitchMicros; }
+        uint32_t getMaxSceneSwitchMicros() const { return mMaxSceneSwitchMicros; }
+
+        // The display is saved in a binary file, JSON is only used to export and import it
+        void serializeToJson(JsonObject root) const;
+        void importFromJson(JsonObject root);
+
     // Accessors / Modfiiers
     public:
         void setBrightness(uint8_t newBrightness);
@@ -83,8 +126,31 @@ class LightDisplay
         void enableReverseMode(bool enabled) { mReverseModeEnabled = enabled; }
         bool isReverseModeEnabled() const { return mReverseModeEnabled; }
 
+        void setTransitionDuration(uint16_t newDuration) { mTransitionDuration = newDuration; }
+        uint16_t getTransitionDuration() const { return mTransitionDuration; }
+
+        void setTargetFps(uint8_t targetFps);
+        uint8_t getTargetFps() const { return mFramePacer.getTargetFps(); }
+
+        const LightDisplayFramePacer& getFramePacer() const { return mFramePacer; }
+        void resetFrameStatistics() { mFramePacer.resetStatistics(); }
+
         bool useWhiteChannel() const; // MDR DEBUG - TODO - this was private
 
+    // Private types
+    private:
+        // Where a lighted object was located in the display, used to work out which
+        // addresses changed when the list of lighted objects is modified
+        struct ObjectLayout
+        {
+            const ILightedObject*   object;
+            uint8_t                 output;
+            uint16_t                startingAddress;
+            uint16_t                numPixels;
+        };
+        typedef std::vector<ObjectLayout> LayoutList;
+        typedef std::vector<const ILightedObject*> ChangedObjectList;
+
     // Private functions
     private:
         void setBrightnessAndShow();
@@ -97,14 +163,33 @@ class LightDisplay
         uint8_t getPowerBudgetAllowedBrightness(uint32_t powerBudget, uint32_t basePowerConsumption);
         bool useWS2815PowerModel() const;
 
+        // Output management
+        void beginOutputs();
+        void releaseOutputs();
+        NeoPixelWrapper* getPrimaryPixelWrapper() const;
+
         // Lighted object management
         void swapLightedObjects(int firstIndex, int otherIndex);
         void resetLightedObjectAddresses();
-        void resetAllLeds();
+        void markObjectsChanged(const ILightedObject* changedObject, bool layoutChanged);
+
+        // Crossfade transitions
+        LayoutList captureLayout() const;
+        void startTransition(const LayoutList& oldLayout, const ChangedObjectList& changedObjects);
+        void addAffectedRange(uint8_t output, uint16_t startingAddress, uint16_t numPixels);
+
+        void markOutputDirty(uint8_t output);
+
+        // Scene management
+        void prepareStandbyScenes();
 
         // Save/Load functionality
-        void saveToFile() const;
+        bool saveToFile() const;
         void loadFromFile();
+        bool loadFromJsonFile();
+        void readFromJson(JsonObject root);
+        void saveScenesToFile() const;
+        void loadScenesFromFile();
 
         uint32_t max(uint32_t value1, uint32_t value2) const { return value1 > value2 ? value1 : value2; }
         uint32_t min(uint32_t value1, uint32_t value2) const { return value1 < value2 ? value1 : value2; }
@@ -112,10 +197,18 @@ class LightDisplay
     // Private constants
     private:
         static const char* SAVE_FILE_NAME;
+        static const char* TEMP_SAVE_FILE_NAME;
+        static const char* JSON_FILE_NAME;
+        static const char* SCENES_FILE_NAME;
+        static const char* TEMP_SCENES_FILE_NAME;
         static const int MAX_NUM_LIGHTED_OBJECTS = 12;
+        static const int MAX_NUM_SCENES = 8;
+        static const uint8_t SAVE_FILE_VERSION = 1;
+        static const uint8_t SCENES_FILE_VERSION = 1;
         static const int MAX_LIGHTED_OBJECT_DATA = 2048;
+        static const int MAX_NUM_OUTPUTS = WLED_MAX_PIXEL_OUTPUTS;
 
-        static const int MIN_FRAME_TIME_IN_MS = 15;
+        static const int DEFAULT_TRANSITION_DURATION_IN_MS = 750;
 
         static const int POWER_UNITS_PER_LED = 195075; // each LED can draw up 195075 "power units" (approx. 53mA)
         static const int DEFAULT_MILLIAMP_PER_LED = 55;
@@ -144,7 +237,7 @@ class LightDisplay
         bool                mReverseModeEnabled;
         uint8_t             mRgbwMode;
 
-        // NOTE: This is not saved in lightDisplay.json because we get it from the Cfg that
+        // NOTE: This is not saved with the light display because we get it from the Cfg that
         // is setup for the application as a whole.
         uint8_t             mColorOrder;
 
@@ -155,13 +248,34 @@ class LightDisplay
         uint8_t             mMilliampsPerLed;
         uint16_t            mCurrentMilliamps;
 
-        NeoPixelWrapper*    mNeoPixelWrapper;
+        // Outputs are rebuilt from mOutputConfig whenever the configuration changes.  Without
+        // a configuration there is one output on LEDPIN with the LED count from the settings.
+        OutputConfigList    mOutputConfig;
+        OutputList          mOutputs;
+        uint16_t            mDefaultOutputNumPixels;
 
         uint32_t            mCurrentTimestamp;
         uint32_t            mLastShowTimestamp;
 
+        LightDisplayFramePacer  mFramePacer;
+
         LightedObjectList   mLightedObjects;
 
+        // The batch of changes in progress, see beginBatch
+        uint8_t             mBatchDepth;
+        bool                mBatchHasChanges;
+        bool                mBatchLayoutChanged;
+        LayoutList          mBatchLayout;
+        ChangedObjectList   mBatchChangedObjects;
+        LightedObjectList   mBatchDeletedObjects;
+
+        uint16_t            mTransitionDuration;
+
+        SceneList           mScenes;
+        int8_t              mActiveSceneIndex;
+        uint32_t            mLastSceneSwitchMicros;
+        uint32_t            mMaxSceneSwitchMicros;
+
         static const char* LIGHT_DISPLAY_ROOT_ELEMENT;
         static const char* CURRENT_BRIGHTNESS_ELEMENT;
         static const char* SUPPORTS_WHITE_ELEMENT;
@@ -170,6 +284,11 @@ class LightDisplay
         static const char* GAMMA_CORRECT_BRIGHTNESS_ELEMENT;
         static const char* GAMMA_CORRECT_COLOR_ELEMENT;
         static const char* MAX_MILLIAMPS_ELEMENT;
+        static const char* TRANSITION_DURATION_ELEMENT;
+        static const char* TARGET_FPS_ELEMENT;
+        static const char* OUTPUTS_ARRAY_ELEMENT;
+        static const char* OUTPUT_PIN_ELEMENT;
+        static const char* OUTPUT_NUM_LEDS_ELEMENT;
         static const char* LIGHTED_OBJECTS_ARRAY_ELEMENT;
 };
 
@@ -0,0 +1,213 @@
+#include "LightDisplayFramePacer.h"
+
+#include <algorithm>
+
+/*
+** ============================================================================
+** Constructor
+** ============================================================================
+*/
+LightDisplayFramePacer::LightDisplayFramePacer()
+    : mTargetFps( DEFAULT_TARGET_FPS )
+    , mIsScheduled( false )
+    , mNextDeadline( 0 )
+    , mLastFrameStart( 0 )
+    , mAverageShowMicros( 0 )
+    , mWireMicros( 0 )
+{
+    resetStatistics();
+}
+
+/*
+** ============================================================================
+** Destructor
+** ============================================================================
+*/
+LightDisplayFramePacer::~LightDisplayFramePacer()
+{
+}
+
+/*
+** ============================================================================
+** Sets the number of frames per second the display should try to render
+** ============================================================================
+*/
+void LightDisplayFramePacer::setTargetFps(uint8_t targetFps)
+{
+    if (targetFps < MIN_TARGET_FPS)
+    {
+        targetFps = MIN_TARGET_FPS;
+    }
+    else if (targetFps > MAX_TARGET_FPS)
+    {
+        targetFps = MAX_TARGET_FPS;
+    }
+
+    mTargetFps = targetFps;
+}
+
+/*
+** ============================================================================
+** Returns true once the deadline of the next frame has been reached
+** ============================================================================
+*/
+bool LightDisplayFramePacer::isFrameDue(uint32_t currentMicros) const
+{
+    // Signed difference so micros() rolling over is handled
+    return !mIsScheduled || (int32_t)(currentMicros - mNextDeadline) >= 0;
+}
+
+/*
+** ============================================================================
+** Called when a frame starts rendering.  Records how late the frame is and
+** schedules the deadline of the next frame.
+**
+**  param   currentMicros - time (us) the frame started
+** ============================================================================
+*/
+void LightDisplayFramePacer::startFrame(uint32_t currentMicros)
+{
+    const uint32_t frameInterval = getFrameInterval();
+
+    if (!mIsScheduled)
+    {
+        mIsScheduled = true;
+        mNextDeadline = currentMicros;
+        mLastFrameStart = currentMicros - frameInterval;
+        mFpsWindowStart = currentMicros;
+    }
+
+    int32_t lateness = (int32_t)(currentMicros - mNextDeadline);
+    if (lateness < 0)
+    {
+        lateness = 0;
+    }
+
+    // Jitter is how far the actual frame interval was from the scheduled one
+    uint32_t actualInterval = currentMicros - mLastFrameStart;
+    uint32_t jitter = (actualInterval > frameInterval) ? actualInterval - frameInterval : frameInterval - actualInterval;
+    mJitterSamples[mNextJitterSample] = (jitter > 0xFFFF) ? 0xFFFF : jitter;
+    mNextJitterSample = (mNextJitterSample + 1) % NUM_JITTER_SAMPLES;
+    if (mNumJitterSamples < NUM_JITTER_SAMPLES)
+    {
+        ++mNumJitterSamples;
+    }
+    mLastFrameStart = currentMicros;
+
+    if ((uint32_t)lateness >= frameInterval)
+    {
+        // Whole frames were missed, drop them and restart the schedule from now
+        mSkippedFrames += (uint32_t)lateness / frameInterval;
+        ++mLateFrames;
+        mNextDeadline = currentMicros + frameInterval;
+    }
+    else
+    {
+        // Polling from the main loop always starts a little late, only count real delays
+        if ((uint32_t)lateness > frameInterval / 4)
+        {
+            ++mLateFrames;
+        }
+        mNextDeadline += frameInterval;
+    }
+
+    // Achieved frame rate over the last second
+    ++mFrameCount;
+    uint32_t windowLength = currentMicros - mFpsWindowStart;
+    if (windowLength >= 1000000UL)
+    {
+        mAchievedFps = ((uint32_t)mFrameCount * 1000UL) / (windowLength / 1000UL);
+        mFrameCount = 0;
+        mFpsWindowStart = currentMicros;
+    }
+}
+
+/*
+** ============================================================================
+** Records how long it took to show a frame.  The wire time of the longest
+** output (the outputs are sent at the same time) and a moving average of the
+** time spent in Show() both limit how short the frame interval can be.
+**
+**  param   showMicros - time (us) spent starting the transmission
+**  param   longestOutputPixels - number of LEDs on the longest output sent
+**  param   supportsWhite - true if the LEDs have a white channel
+** ============================================================================
+*/
+void LightDisplayFramePacer::recordShow(uint32_t showMicros, uint16_t longestOutputPixels, bool supportsWhite)
+{
+    uint32_t microsPerPixel = supportsWhite ? MICROS_PER_RGBW_PIXEL : MICROS_PER_RGB_PIXEL;
+    mWireMicros = (uint32_t)longestOutputPixels * microsPerPixel + LATCH_MICROS;
+
+    // Each new measurement has a weight of 1/8
+    if (0 == mAverageShowMicros)
+    {
+        mAverageShowMicros = showMicros;
+    }
+    else
+    {
+        mAverageShowMicros = (mAverageShowMicros * 7 + showMicros) / 8;
+    }
+}
+
+/*
+** ============================================================================
+** Clears the frame statistics, the frame schedule is kept
+** ============================================================================
+*/
+void LightDisplayFramePacer::resetStatistics()
+{
+    mLateFrames = 0;
+    mSkippedFrames = 0;
+    mFrameCount = 0;
+    mAchievedFps = 0;
+    mFpsWindowStart = micros();
+    mNextJitterSample = 0;
+    mNumJitterSamples = 0;
+}
+
+/*
+** ============================================================================
+** Returns the time (us) between frames.  This is the interval for the target
+** FPS unless sending the LEDs takes longer than that.
+** ============================================================================
+*/
+uint32_t LightDisplayFramePacer::getFrameInterval() const
+{
+    uint32_t frameInterval = getTargetFrameInterval();
+
+    if (mWireMicros > frameInterval)
+    {
+        frameInterval = mWireMicros;
+    }
+
+    if (mAverageShowMicros > frameInterval)
+    {
+        frameInterval = mAverageShowMicros;
+    }
+
+    return frameInterval;
+}
+
+/*
+** ============================================================================
+** Returns the given percentile (0 - 100) of the jitter (us) of the last frames
+** ============================================================================
+*/
+uint32_t LightDisplayFramePacer::getJitterPercentile(uint8_t percentile) const
+{
+    if (0 == mNumJitterSamples)
+    {
+        return 0;
+    }
+
+    uint16_t sortedSamples[NUM_JITTER_SAMPLES];
+    std::copy(mJitterSamples, mJitterSamples + mNumJitterSamples, sortedSamples);
+    std::sort(sortedSamples, sortedSamples + mNumJitterSamples);
+
+    if (percentile > 100)
+    {
+        percentile = 100;
+    }
+
+    return sortedSamples[((mNumJitterSamples - 1) * percentile) / 100];
+}
@@ -0,0 +1,84 @@
+#ifndef __LIGHT_DISPLAY_FRAME_PACER_H
+#define __LIGHT_DISPLAY_FRAME_PACER_H
+
+#include "Arduino.h"
+
+/*
+**-----------------------------------------------------------------------------
+** Decides when the light display renders its next frame.  Frames are scheduled
+** against a deadline that advances by one frame interval per frame (rather than
+** "interval after the last frame") so a slow frame does not push every later
+** frame back.  A frame that starts after its deadline is counted as late, and
+** if one or more whole intervals were missed they are counted as skipped and
+** the schedule restarts from the current time.
+**
+** The frame interval comes from the target FPS, but it is stretched when the
+** LEDs can not be sent that quickly: the estimated wire time of the longest
+** output and the measured time spent in Show() both put a floor on it.
+**
+** Achieved FPS is measured over one second windows and the jitter (difference
+** between the actual and the scheduled frame interval) of the last frames is
+** kept to report percentiles.
+**-----------------------------------------------------------------------------
+*/
+class LightDisplayFramePacer
+{
+    public:
+        LightDisplayFramePacer();
+        virtual ~LightDisplayFramePacer();
+
+        static const uint8_t MIN_TARGET_FPS = 1;
+        static const uint8_t MAX_TARGET_FPS = 120;
+        static const uint8_t DEFAULT_TARGET_FPS = 60;
+
+        void setTargetFps(uint8_t targetFps);
+        uint8_t getTargetFps() const { return mTargetFps; }
+
+        // Scheduling
+        bool isFrameDue(uint32_t currentMicros) const;
+        void startFrame(uint32_t currentMicros);
+        void recordShow(uint32_t showMicros, uint16_t longestOutputPixels, bool supportsWhite);
+
+        void resetStatistics();
+
+        // Statistics
+        uint32_t getFrameInterval() const;
+        uint32_t getTargetFrameInterval() const { return 1000000UL / mTargetFps; }
+        uint32_t getShowTime() const { return mAverageShowMicros; }
+        uint32_t getWireTime() const { return mWireMicros; }
+        uint16_t getAchievedFps() const { return mAchievedFps; }
+        uint32_t getLateFrames() const { return mLateFrames; }
+        uint32_t getSkippedFrames() const { return mSkippedFrames; }
+        uint32_t getJitterPercentile(uint8_t percentile) const;
+
+    private:
+        static const uint8_t NUM_JITTER_SAMPLES = 64;
+
+        // WS281x: 24 (or 32) bits of 1.25us each per pixel plus the latch time
+        static const uint16_t MICROS_PER_RGB_PIXEL = 30;
+        static const uint16_t MICROS_PER_RGBW_PIXEL = 40;
+        static const uint16_t LATCH_MICROS = 300;
+
+    private:
+        uint8_t     mTargetFps;
+
+        bool        mIsScheduled;
+        uint32_t    mNextDeadline;
+        uint32_t    mLastFrameStart;
+
+        uint32_t    mAverageShowMicros;
+        uint32_t    mWireMicros;
+
+        // Statistics
+        uint32_t    mLateFrames;
+        uint32_t    mSkippedFrames;
+        uint16_t    mFrameCount;
+        uint16_t    mAchievedFps;
+        uint32_t    mFpsWindowStart;
+
+        uint16_t    mJitterSamples[NUM_JITTER_SAMPLES];
+        uint8_t     mNextJitterSample;
+        uint8_t     mNumJitterSamples;
+};
+
+#endif
@@ -0,0 +1,109 @@
+#include "LightDisplayOutput.h"
+
+#include "wled.h"
+
+/*
+** ============================================================================
+** Constructor
+**
+**  param   outputIndex - index of the output, selects the hardware channel
+**  param   pin - GPIO the LED data line is connected to
+**  param   numPixels - number of LEDs connected to this output
+**  param   firstDisplayAddress - display address of the first LED of this output
+** ============================================================================
+*/
+LightDisplayOutput::LightDisplayOutput(uint8_t outputIndex, uint8_t pin, uint16_t numPixels, uint16_t firstDisplayAddress)
+    : mOutputIndex( outputIndex )
+    , mPin( pin )
+    , mNumPixels( numPixels )
+    , mFirstDisplayAddress( firstDisplayAddress )
+    , mNumObjectPixels( 0 )
+    , mBrightness( 255 )
+    , mIsDirty( true )
+    , mShowCount( 0 )
+    , mSkippedShowCount( 0 )
+    , mNeoPixelWrapper( new NeoPixelWrapper() )
+{
+}
+
+/*
+** ============================================================================
+** Destructor
+** ============================================================================
+*/
+LightDisplayOutput::~LightDisplayOutput()
+{
+    // The snapshot of a running transition refers to this output's pixels
+    mTransition.end();
+
+    delete mNeoPixelWrapper;
+    mNeoPixelWrapper = nullptr;
+}
+
+/*
+** ============================================================================
+** Starts (or restarts) the bus that drives this output.  The new bus starts at
+** full brightness with all pixels off and must be sent on the next show.
+**
+**  param   supportsWhite - true if the LEDs have a white channel
+**  param   colorOrder - color order of the LEDs
+** ============================================================================
+*/
+void LightDisplayOutput::begin(bool supportsWhite, uint8_t colorOrder)
+{
+    const NeoPixelType pixelType = supportsWhite ? NeoPixelType_Grbw : NeoPixelType_Grb;
+
+    mNeoPixelWrapper->SetColorOrder(colorOrder);
+    mNeoPixelWrapper->Begin(pixelType, mNumPixels, mPin, mOutputIndex);
+    mBrightness = 255;
+    mIsDirty = true;
+}
+
+/*
+** ============================================================================
+** Returns true if the given display address is one of the LEDs of this output
+** ============================================================================
+*/
+bool LightDisplayOutput::containsDisplayAddress(uint16_t displayAddress) const
+{
+    return displayAddress >= mFirstDisplayAddress &&
+           displayAddress < (uint32_t)mFirstDisplayAddress + mNumPixels;
+}
+
+/*
+** ============================================================================
+** Sets the brightness of this output.  Changing the brightness rescales every
+** pixel so the output is marked dirty.
+** ============================================================================
+*/
+void LightDisplayOutput::setBrightness(uint8_t brightness)
+{
+    if (brightness != mBrightness)
+    {
+        mNeoPixelWrapper->SetBrightness(brightness);
+        mBrightness = brightness;
+        mIsDirty = true;
+    }
+}
+
+/*
+** ============================================================================
+** Starts transmitting the pixels of this output if anything changed since the
+** last time it was sent.  Some buses send asynchronously so this can return
+** before all of the data has been sent.
+** ============================================================================
+*/
+void LightDisplayOutput::show()
+{
+    if (!mIsDirty)
+    {
+        ++mSkippedShowCount;
+        return;
+    }
+
+    // The trace tells the outputs apart by their index
+    PROFILE_SCOPE_ARG(PROFILE_SHOW, mOutputIndex);
+    mNeoPixelWrapper->Show();
+    mIsDirty = false;
+    ++mShowCount;
+}
@@ -0,0 +1,77 @@
+#ifndef __LIGHT_DISPLAY_OUTPUT_H
+#define __LIGHT_DISPLAY_OUTPUT_H
+
+#include "Arduino.h"
+#include "NpbWrapper.h"
+#include "LightDisplayTransition.h"
+
+/*
+**-----------------------------------------------------------------------------
+** One LED data pin of a light display.  Each output has its own pixel wrapper
+** (and on the ESP32 its own RMT channel) so every output can be transmitting at
+** the same time.  Lighted objects are assigned to an output and their addresses
+** are relative to the first LED of that output.
+**
+** The outputs of a display are also given consecutive ranges of "display
+** addresses" so that the display as a whole can still be read as one long list
+** of pixels (live view, DMX).
+**
+** An output is only transmitted when it is dirty, that is when one of its
+** lighted objects rendered a different frame, a transition is fading on it or
+** its brightness changed.  Outputs with only static objects cost no wire time.
+**-----------------------------------------------------------------------------
+*/
+class LightDisplayOutput
+{
+    public:
+        LightDisplayOutput(uint8_t outputIndex, uint8_t pin, uint16_t numPixels, uint16_t firstDisplayAddress);
+        virtual ~LightDisplayOutput();
+
+        void begin(bool supportsWhite, uint8_t colorOrder);
+
+        NeoPixelWrapper* getPixelWrapper() const { return mNeoPixelWrapper; }
+        LightDisplayTransition& getTransition() { return mTransition; }
+
+        uint8_t getOutputIndex() const { return mOutputIndex; }
+        uint8_t getPin() const { return mPin; }
+        uint16_t getNumberOfLEDs() const { return mNumPixels; }
+        uint16_t getFirstDisplayAddress() const { return mFirstDisplayAddress; }
+
+        bool containsDisplayAddress(uint16_t displayAddress) const;
+
+        void setBrightness(uint8_t brightness);
+
+        // Change tracking, show() only transmits the output if it is dirty
+        void markDirty() { mIsDirty = true; }
+        bool isDirty() const { return mIsDirty; }
+        void show();
+
+        uint32_t getShowCount() const { return mShowCount; }
+        uint32_t getSkippedShowCount() const { return mSkippedShowCount; }
+
+        // Number of LEDs covered by the lighted objects on this output, set when the
+        // objects are laid out.  Addresses at or above this value are not rendered.
+        void setNumberOfObjectLEDs(uint16_t numberOfLEDs) { mNumObjectPixels = numberOfLEDs; }
+        uint16_t getNumberOfObjectLEDs() const { return mNumObjectPixels; }
+
+    private:
+        LightDisplayOutput(const LightDisplayOutput&);
+        LightDisplayOutput& operator=(const LightDisplayOutput&);
+
+    private:
+        uint8_t                 mOutputIndex;
+        uint8_t                 mPin;
+        uint16_t                mNumPixels;
+        uint16_t                mFirstDisplayAddress;
+        uint16_t                mNumObjectPixels;
+        uint8_t                 mBrightness;
+
+        bool                    mIsDirty;
+        uint32_t                mShowCount;
+        uint32_t                mSkippedShowCount;
+
+        NeoPixelWrapper*        mNeoPixelWrapper;
+        LightDisplayTransition  mTransition;
+};
+
+#endif
@@ -0,0 +1,175 @@
+#include "LightDisplayScene.h"
+
+#include "lighted_objects/LightedObjectFactory.h"
+#include "lighted_objects/ILightedObject.h"
+
+/*
+** ============================================================================
+** Constructor
+** ============================================================================
+*/
+LightDisplayScene::LightDisplayScene(const std::string& name)
+    : mName( name )
+    , mNumLightedObjects( 0 )
+    , mIsStandbyReady( false )
+{
+}
+
+/*
+** ============================================================================
+** Destructor
+** ============================================================================
+*/
+LightDisplayScene::~LightDisplayScene()
+{
+    releaseStandbyObjects();
+}
+
+/*
+** ============================================================================
+** Takes a snapshot of the given lighted objects.  The snapshot is made up of
+** the number of objects followed by, for each object, its type and its binary
+** state (length prefixed so unknown object types can be skipped).  Any standby
+** objects are released since they no longer match the snapshot.
+**
+**  param   lightedObjects - objects to take the snapshot of
+** ============================================================================
+*/
+void LightDisplayScene::capture(const LightedObjectList& lightedObjects)
+{
+    releaseStandbyObjects();
+
+    BinaryWriter writer;
+    BinaryWriter objectWriter;
+
+    mNumLightedObjects = 0;
+    for (ILightedObject* lightedObject : lightedObjects)
+    {
+        if (nullptr != lightedObject)
+        {
+            ++mNumLightedObjects;
+        }
+    }
+
+    writer.writeVarUInt(mNumLightedObjects);
+    for (ILightedObject* lightedObject : lightedObjects)
+    {
+        if (nullptr != lightedObject)
+        {
+            objectWriter.clear();
+            lightedObject->serializeBinary(objectWriter);
+
+            writer.writeString(lightedObject->getObjectType());
+            writer.writeVarUInt(objectWriter.getBuffer().size());
+            writer.writeBytes(objectWriter.getBuffer().data(), objectWriter.getBuffer().size());
+        }
+    }
+
+    mSnapshot.swap(writer.getBuffer());
+    mSnapshot.shrink_to_fit();
+}
+
+/*
+** ============================================================================
+** Replaces the snapshot with one that was previously read from storage
+**
+**  param   data - snapshot data written by capture
+**  param   length - number of bytes of snapshot data
+** ============================================================================
+*/
+void LightDisplayScene::setSnapshot(const uint8_t* data, size_t length)
+{
+    releaseStandbyObjects();
+
+    mSnapshot.assign(data, data + length);
+
+    uint32_t numLightedObjects = 0;
+    BinaryReader reader(mSnapshot.data(), mSnapshot.size());
+    reader.readVarUInt(numLightedObjects);
+    mNumLightedObjects = numLightedObjects;
+}
+
+/*
+** ============================================================================
+** Instantiates the standby copy of the lighted objects from the snapshot so
+** that the scene can be activated with a simple swap.  Nothing is done if the
+** standby objects are already prepared.  If the snapshot is corrupt the objects
+** that could be read are kept so the scene does not get rebuilt every frame.
+**
+**  param   neoPixelWrapper - pixel wrapper the new objects draw into
+**  returns true if the whole snapshot could be read
+** ============================================================================
+*/
+bool LightDisplayScene::prepareStandbyObjects(NeoPixelWrapper* neoPixelWrapper)
+{
+    if (mIsStandbyReady)
+    {
+        return true;
+    }
+
+    releaseStandbyObjects();
+
+    BinaryReader reader(mSnapshot.data(), mSnapshot.size());
+
+    uint32_t numLightedObjects = 0;
+    reader.readVarUInt(numLightedObjects);
+    mStandbyObjects.reserve(numLightedObjects);
+
+    for (uint32_t objectIndex = 0; objectIndex < numLightedObjects && reader.isValid(); ++objectIndex)
+    {
+        std::string objectType;
+        uint32_t objectLength = 0;
+        if (!reader.readString(objectType) || !reader.readVarUInt(objectLength))
+        {
+            break;
+        }
+
+        const uint8_t* objectData = reader.getCurrentPosition();
+        if (!reader.skip(objectLength))
+        {
+            break;
+        }
+        BinaryReader objectReader(objectData, objectLength);
+
+        ILightedObject* newObject = LightedObjectFactory::get().createLightedObject(objectType, neoPixelWrapper);
+        if (nullptr != newObject)
+        {
+            newObject->deserializeBinary(objectReader);
+            mStandbyObjects.push_back(newObject);
+        }
+    }
+
+    mIsStandbyReady = true;
+    return reader.isValid();
+}
+
+/*
+** ============================================================================
+** Swaps the standby objects of this scene with the given active list.  After
+** the swap this scene holds the outgoing objects, they must be released (and
+** the standby objects prepared again) before the scene can be reactivated.
+**
+**  param   activeObjects - list of lighted objects that is currently displayed
+** ============================================================================
+*/
+void LightDisplayScene::swapStandbyObjects(LightedObjectList& activeObjects)
+{
+    mStandbyObjects.swap(activeObjects);
+    mIsStandbyReady = false;
+}
+
+/*
+** ============================================================================
+** Deletes the standby objects held by this scene
+** ============================================================================
+*/
+void LightDisplayScene::releaseStandbyObjects()
+{
+    for (ILightedObject* lightedObject : mStandbyObjects)
+    {
+        delete lightedObject;
+    }
+
+    mStandbyObjects.clear();
+    mIsStandbyReady = false;
+}
@@ -0,0 +1,56 @@
+#ifndef __LIGHT_DISPLAY_SCENE_H
+#define __LIGHT_DISPLAY_SCENE_H
+
+#include "Arduino.h"
+#include "NpbWrapper.h"
+
+#include <string>
+#include <vector>
+
+// Forward Declarations
+class ILightedObject;
+
+/*
+**-----------------------------------------------------------------------------
+** A scene is a named snapshot of the lighted objects that make up a display
+** (object types, parameters and effect selections).  The snapshot is kept as
+** a compact binary blob and, so that switching to the scene does not need to
+** parse or construct anything, the scene also keeps a standby copy of its
+** lighted objects already instantiated.  Activating the scene swaps that list
+** with the active list of the display.  The outgoing objects are then held by
+** the scene until they can be released and the standby copy rebuilt outside
+** of the time critical switch.
+**-----------------------------------------------------------------------------
+*/
+class LightDisplayScene
+{
+    public:
+        typedef std::vector<ILightedObject*> LightedObjectList;
+        typedef std::vector<uint8_t> SnapshotData;
+
+        LightDisplayScene(const std::string& name);
+        virtual ~LightDisplayScene();
+
+        void capture(const LightedObjectList& lightedObjects);
+        void setSnapshot(const uint8_t* data, size_t length);
+
+        bool prepareStandbyObjects(NeoPixelWrapper* neoPixelWrapper);
+        void swapStandbyObjects(LightedObjectList& activeObjects);
+        void releaseStandbyObjects();
+
+        bool isStandbyReady() const { return mIsStandbyReady; }
+
+        const std::string& getName() const { return mName; }
+        const SnapshotData& getSnapshot() const { return mSnapshot; }
+        uint8_t getNumberOfLightedObjects() const { return mNumLightedObjects; }
+
+    private:
+        std::string         mName;
+        SnapshotData        mSnapshot;
+        uint8_t             mNumLightedObjects;
+
+        LightedObjectList   mStandbyObjects;
+        bool                mIsStandbyReady;
+};
+
+#endif
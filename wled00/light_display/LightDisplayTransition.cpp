@@ -0,0 +1,247 @@
+#include "LightDisplayTransition.h"
+
+#include <stdlib.h>
+
+/*
+** ============================================================================
+** Constructor
+** ============================================================================
+*/
+LightDisplayTransition::LightDisplayTransition()
+    : mSnapshot( nullptr )
+    , mNumPixels( 0 )
+    , mBytesPerPixel( 3 )
+    , mStartTime( 0 )
+    , mDuration( 0 )
+{
+}
+
+/*
+** ============================================================================
+** Destructor
+** ============================================================================
+*/
+LightDisplayTransition::~LightDisplayTransition()
+{
+    end();
+}
+
+/*
+** ============================================================================
+** Snapshots the frame that is currently held by the pixel wrapper so that it
+** can be faded out over the given duration.  Any transition that is already
+** running is restarted, the snapshot is taken from whatever is on the LEDs now
+** and the ranges that were still fading are kept so a change in the middle of
+** a fade continues smoothly from that point.
+**
+**  param   pixelWrapper - pixel wrapper holding the outgoing frame
+**  param   numPixels - number of pixels in the display
+**  param   supportsWhite - true if the white channel needs to be kept
+**  param   startTime - timestamp (ms) the transition starts at
+**  param   duration - length of the crossfade in ms
+**  returns true if the snapshot could be allocated
+** ============================================================================
+*/
+bool LightDisplayTransition::begin(NeoPixelWrapper* pixelWrapper, uint16_t numPixels, bool supportsWhite, uint32_t startTime, uint16_t duration)
+{
+    std::vector<AddressRange> fadingRanges;
+    if (isActive())
+    {
+        fadingRanges.swap(mAffectedRanges);
+    }
+
+    end();
+
+    if (nullptr == pixelWrapper || 0 == numPixels || 0 == duration)
+    {
+        return false;
+    }
+
+    mBytesPerPixel = supportsWhite ? 4 : 3;
+    mSnapshot = static_cast<uint8_t*>(malloc(numPixels * mBytesPerPixel));
+    if (nullptr == mSnapshot)
+    {
+        return false;
+    }
+
+    mNumPixels = numPixels;
+    mStartTime = startTime;
+    mDuration = duration;
+    mAffectedRanges.swap(fadingRanges);
+
+    uint8_t* snapshotPixel = mSnapshot;
+    for (uint16_t address = 0; address < mNumPixels; ++address)
+    {
+        uint32_t color = pixelWrapper->GetPixelColorRgbw(address);
+        *snapshotPixel++ = (color >> 16); // red
+        *snapshotPixel++ = (color >>  8); // green
+        *snapshotPixel++ =  color;        // blue
+        if (mBytesPerPixel == 4)
+        {
+            *snapshotPixel++ = (color >> 24); // white
+        }
+    }
+
+    return true;
+}
+
+/*
+** ============================================================================
+** Adds a range of addresses that should be faded by this transition.  Ranges
+** are kept sorted and merged so that no pixel is ever blended twice per frame.
+** ============================================================================
+*/
+void LightDisplayTransition::addAffectedRange(uint16_t startingAddress, uint16_t numPixels)
+{
+    if (0 == numPixels)
+    {
+        return;
+    }
+
+    uint32_t newStart = startingAddress;
+    uint32_t newEnd = newStart + numPixels;
+
+    std::vector<AddressRange>::iterator rangeIter = mAffectedRanges.begin();
+    while (rangeIter != mAffectedRanges.end())
+    {
+        uint32_t rangeStart = rangeIter->startingAddress;
+        uint32_t rangeEnd = rangeStart + rangeIter->numPixels;
+
+        if (rangeEnd < newStart)
+        {
+            ++rangeIter;
+        }
+        else if (rangeStart > newEnd)
+        {
+            break;
+        }
+        else
+        {
+            // Overlapping or touching, absorb the existing range into the new one
+            newStart = (rangeStart < newStart) ? rangeStart : newStart;
+            newEnd = (rangeEnd > newEnd) ? rangeEnd : newEnd;
+            rangeIter = mAffectedRanges.erase(rangeIter);
+        }
+    }
+
+    AddressRange newRange;
+    newRange.startingAddress = newStart;
+    newRange.numPixels = newEnd - newStart;
+    mAffectedRanges.insert(rangeIter, newRange);
+}
+
+/*
+** ============================================================================
+** Blends the frame that was just rendered into the pixel wrapper with the
+** snapshot for every affected pixel.  Pixels that are no longer covered by any
+** lighted object (at or above renderedPixels) are faded towards black.  Once
+** the duration has elapsed the transition ends and the rendered frame is left
+** as is.
+**
+**  param   pixelWrapper - pixel wrapper holding the newly rendered frame
+**  param   currentTime - timestamp (ms) of the frame being blended
+**  param   renderedPixels - number of pixels covered by lighted objects
+** ============================================================================
+*/
+void LightDisplayTransition::blendFrame(NeoPixelWrapper* pixelWrapper, uint32_t currentTime, uint16_t renderedPixels)
+{
+    if (!isActive() || nullptr == pixelWrapper)
+    {
+        return;
+    }
+
+    uint32_t elapsed = currentTime - mStartTime;
+    if (elapsed >= mDuration)
+    {
+        // Uncovered pixels still need their final (black) value
+        for (const AddressRange& range : mAffectedRanges)
+        {
+            uint32_t firstUncovered = (range.startingAddress > renderedPixels) ? range.startingAddress : renderedPixels;
+            for (uint32_t address = firstUncovered; address < range.startingAddress + range.numPixels && address < mNumPixels; ++address)
+            {
+                pixelWrapper->SetPixelColor(address, RgbwColor(0, 0, 0, 0));
+            }
+        }
+
+        end();
+        return;
+    }
+
+    // Progress in 1/256 steps
+    uint16_t progress = (elapsed << 8) / mDuration;
+
+    for (const AddressRange& range : mAffectedRanges)
+    {
+        uint32_t lastAddress = range.startingAddress + range.numPixels;
+        if (lastAddress > mNumPixels)
+        {
+            lastAddress = mNumPixels;
+        }
+
+        for (uint32_t address = range.startingAddress; address < lastAddress; ++address)
+        {
+            uint32_t newColor = (address < renderedPixels) ? pixelWrapper->GetPixelColorRgbw(address) : 0;
+            const uint8_t* oldPixel = mSnapshot + (address * mBytesPerPixel);
+
+            RgbwColor blended;
+            blended.R = blendChannel(oldPixel[0], (newColor >> 16), progress);
+            blended.G = blendChannel(oldPixel[1], (newColor >>  8), progress);
+            blended.B = blendChannel(oldPixel[2],  newColor,        progress);
+            blended.W = (mBytesPerPixel == 4) ? blendChannel(oldPixel[3], (newColor >> 24), progress) : 0;
+            pixelWrapper->SetPixelColor(address, blended);
+        }
+    }
+}
+
+/*
+** ============================================================================
+** Sets every pixel in the affected ranges to black and clears the ranges.  This
+** is used instead of a fade when transitions are disabled or the snapshot could
+** not be allocated.
+**
+**  param   pixelWrapper - pixel wrapper to blank the pixels in
+**  param   numPixels - number of pixels in the display
+** ============================================================================
+*/
+void LightDisplayTransition::blankAffectedRanges(NeoPixelWrapper* pixelWrapper, uint16_t numPixels)
+{
+    if (nullptr != pixelWrapper)
+    {
+        for (const AddressRange& range : mAffectedRanges)
+        {
+            for (uint32_t address = range.startingAddress; address < range.startingAddress + range.numPixels && address < numPixels; ++address)
+            {
+                pixelWrapper->SetPixelColor(address, RgbwColor(0, 0, 0, 0));
+            }
+        }
+    }
+
+    end();
+}
+
+/*
+** ============================================================================
+** Stops the transition and releases the snapshot
+** ============================================================================
+*/
+void LightDisplayTransition::end()
+{
+    if (nullptr != mSnapshot)
+    {
+        free(mSnapshot);
+        mSnapshot = nullptr;
+    }
+
+    mNumPixels = 0;
+    mAffectedRanges.clear();
+}
+
+/*
+** ============================================================================
+** Linear interpolation of one color channel, progress is in 1/256 steps
+** ============================================================================
+*/
+uint8_t LightDisplayTransition::blendChannel(uint8_t oldValue, uint8_t newValue, uint16_t progress) const
+{
+    return oldValue + ((((int32_t)newValue - (int32_t)oldValue) * (int32_t)progress) >> 8);
+}
@@ -0,0 +1,53 @@
+#ifndef __LIGHT_DISPLAY_TRANSITION_H
+#define __LIGHT_DISPLAY_TRANSITION_H
+
+#include "Arduino.h"
+#include "NpbWrapper.h"
+
+#include <vector>
+
+/*
+**-----------------------------------------------------------------------------
+** Crossfades the LEDs of a light display from the frame that was showing before
+** a change to the lighted objects to the frames rendered after that change.  The
+** outgoing frame is snapshotted when the transition begins and then, for every
+** frame until the duration expires, each pixel in one of the affected address
+** ranges is linearly interpolated (8 bit fixed point) from its snapshot value
+** to the value that was just rendered.  Pixels outside of the affected ranges
+** are left untouched.
+**-----------------------------------------------------------------------------
+*/
+class LightDisplayTransition
+{
+    public:
+        LightDisplayTransition();
+        virtual ~LightDisplayTransition();
+
+        bool begin(NeoPixelWrapper* pixelWrapper, uint16_t numPixels, bool supportsWhite, uint32_t startTime, uint16_t duration);
+        void addAffectedRange(uint16_t startingAddress, uint16_t numPixels);
+        void blendFrame(NeoPixelWrapper* pixelWrapper, uint32_t currentTime, uint16_t renderedPixels);
+        void blankAffectedRanges(NeoPixelWrapper* pixelWrapper, uint16_t numPixels);
+        void end();
+
+        bool isActive() const { return mSnapshot != nullptr; }
+        bool hasAffectedRanges() const { return !mAffectedRanges.empty(); }
+
+    private:
+        struct AddressRange
+        {
+            uint16_t startingAddress;
+            uint16_t numPixels;
+        };
+
+        uint8_t blendChannel(uint8_t oldValue, uint8_t newValue, uint16_t progress) const;
+
+    private:
+        uint8_t*                    mSnapshot;
+        uint16_t                    mNumPixels;
+        uint8_t                     mBytesPerPixel;
+        uint32_t                    mStartTime;
+        uint16_t                    mDuration;
+        std::vector<AddressRange>   mAffectedRanges;
+};
+
+#endif
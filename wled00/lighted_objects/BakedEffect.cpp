@@ -0,0 +1,264 @@
+#include "BakedEffect.h"
+
+#include "Arduino.h"
+
+BakedEffect* BakedEffect::sBakingEffect = nullptr;
+uint32_t BakedEffect::sTotalBakedBytes = 0;
+
+/*
+** ============================================================================
+** Constructor
+** ============================================================================
+*/
+BakedEffect::BakedEffect()
+    : mNumPixels( 0 )
+    , mPeriod( 0 )
+    , mFrameInterval( DEFAULT_FRAME_INTERVAL_MS )
+    , mIsValid( false )
+    , mAccountedBytes( 0 )
+    , mRunColor( 0 )
+    , mRunLength( 0 )
+    , mBakeTimeMs( 0 )
+    , mReplayCount( 0 )
+    , mReplayFps( 0 )
+    , mReplayWindowStart( 0 )
+{
+}
+
+/*
+** ============================================================================
+** Destructor
+** ============================================================================
+*/
+BakedEffect::~BakedEffect()
+{
+    clear();
+}
+
+/*
+** ============================================================================
+** Starts baking an effect.  The caller then adds numPixels pixels per frame
+** followed by endFrame() for every frame interval in the period, and finally
+** calls finish().  The frames can be added over several loop passes, only one
+** effect is baked at a time.
+**
+** The baked period is a whole number of frame intervals so every frame is
+** shown for the same time, if the effect loop is not it is baked for as many
+** loops as that takes (when those fit in MAX_BAKED_FRAMES).
+**
+**  param   numPixels - number of pixels in each frame
+**  param   period - length (ms) of the effect loop
+**  param   frameInterval - time (ms) between baked frames
+**  returns false if another effect is being baked or if the period needs more
+**          frames than we allow
+** ============================================================================
+*/
+bool BakedEffect::begin(uint16_t numPixels, uint32_t period, uint16_t frameInterval)
+{
+    clear();
+
+    if (isBakeInProgress() || 0 == numPixels || 0 == period || 0 == frameInterval)
+    {
+        return false;
+    }
+
+    uint32_t wholePeriod = (period / greatestCommonDivisor(period, frameInterval)) * frameInterval;
+    if (wholePeriod / frameInterval <= MAX_BAKED_FRAMES)
+    {
+        period = wholePeriod;
+    }
+
+    uint32_t numFrames = (period + frameInterval - 1) / frameInterval;
+    if (numFrames > MAX_BAKED_FRAMES)
+    {
+        return false;
+    }
+
+    sBakingEffect = this;
+    mNumPixels = numPixels;
+    mPeriod = period;
+    mFrameInterval = frameInterval;
+    mFrameOffsets.reserve(numFrames);
+    mFrameOffsets.push_back(0);
+    return true;
+}
+
+/*
+** ============================================================================
+** Adds the next pixel of the frame being baked
+** ============================================================================
+*/
+void BakedEffect::addPixel(uint32_t color)
+{
+    if (mRunLength > 0 && (color != mRunColor || mRunLength == 255))
+    {
+        flushRun();
+    }
+
+    mRunColor = color;
+    ++mRunLength;
+}
+
+/*
+** ============================================================================
+** Completes the frame being baked
+**
+**  returns false if the baked frames no longer fit in MAX_BAKED_BYTES or in
+**          what is left of MAX_TOTAL_BAKED_BYTES
+** ============================================================================
+*/
+bool BakedEffect::endFrame()
+{
+    flushRun();
+
+    uint32_t bakedBytes = mFrameData.size() + (mFrameOffsets.size() * sizeof(uint32_t));
+    if (bakedBytes > MAX_BAKED_BYTES || (sTotalBakedBytes - mAccountedBytes + bakedBytes) > MAX_TOTAL_BAKED_BYTES)
+    {
+        clear();
+        return false;
+    }
+
+    sTotalBakedBytes += bakedBytes - mAccountedBytes;
+    mAccountedBytes = bakedBytes;
+    mFrameOffsets.push_back(mFrameData.size());
+    return true;
+}
+
+/*
+** ============================================================================
+** Completes the bake.  The offset of the end of the last frame stays in the
+** offsets table as an end marker so it is removed from the frame count.
+**
+**  param   bakeTimeMs - time spent baking the effect over every loop pass
+** ============================================================================
+*/
+void BakedEffect::finish(uint32_t bakeTimeMs)
+{
+    if (mFrameOffsets.size() < 2)
+    {
+        clear();
+        return;
+    }
+
+    mFrameData.shrink_to_fit();
+    mFrameOffsets.shrink_to_fit();
+    mBakeTimeMs = bakeTimeMs;
+    mIsValid = true;
+
+    if (isBaking())
+    {
+        sBakingEffect = nullptr;
+    }
+}
+
+/*
+** ============================================================================
+** Releases all baked frames, or gives up the bake in progress
+** ============================================================================
+*/
+void BakedEffect::clear()
+{
+    if (isBaking())
+    {
+        sBakingEffect = nullptr;
+    }
+    sTotalBakedBytes -= mAccountedBytes;
+    mAccountedBytes = 0;
+
+    std::vector<uint8_t>().swap(mFrameData);
+    std::vector<uint32_t>().swap(mFrameOffsets);
+    mNumPixels = 0;
+    mPeriod = 0;
+    mIsValid = false;
+    mRunColor = 0;
+    mRunLength = 0;
+    mReplayCount = 0;
+    mReplayFps = 0;
+}
+
+/*
+** ============================================================================
+** Writes the frame for the given effect time into the pixel wrapper
+**
+**  param   pixelWrapper - pixel wrapper to write the frame into
+**  param   startingAddress - address of the first pixel of the object
+**  param   effectTime - time (ms) the effect has been running
+**  returns index of the frame that was written
+** ============================================================================
+*/
+uint16_t BakedEffect::replay(NeoPixelWrapper* pixelWrapper, uint16_t startingAddress, uint32_t effectTime)
+{
+    if (!mIsValid || nullptr == pixelWrapper)
+    {
+        return 0;
+    }
+
+    // The last entry of mFrameOffsets marks the end of the last frame
+    uint16_t numFrames = mFrameOffsets.size() - 1;
+    uint16_t frameIndex = ((effectTime % mPeriod) / mFrameInterval) % numFrames;
+
+    const uint8_t* frameData = mFrameData.data() + mFrameOffsets[frameIndex];
+    const uint8_t* frameEnd = mFrameData.data() + mFrameOffsets[frameIndex + 1];
+
+    uint16_t address = startingAddress;
+    while (frameData < frameEnd)
+    {
+        uint8_t runLength = frameData[0];
+        RgbwColor color(frameData[2], frameData[3], frameData[4], frameData[1]);
+        frameData += 5;
+
+        for (uint8_t pixel = 0; pixel < runLength; ++pixel)
+        {
+            pixelWrapper->SetPixelColor(address++, color);
+        }
+    }
+
+    // Replay rate over the last second
+    uint32_t now = millis();
+    ++mReplayCount;
+    if (now - mReplayWindowStart >= 1000)
+    {
+        mReplayFps = ((uint32_t)mReplayCount * 1000) / (now - mReplayWindowStart);
+        mReplayCount = 0;
+        mReplayWindowStart = now;
+    }
+
+    return frameIndex;
+}
+
+/*
+** ============================================================================
+** Appends the current run (count byte followed by W, R, G, B) to the frame data
+** ============================================================================
+*/
+void BakedEffect::flushRun()
+{
+    if (0 == mRunLength)
+    {
+        return;
+    }
+
+    mFrameData.push_back(mRunLength);
+    mFrameData.push_back(mRunColor >> 24);
+    mFrameData.push_back(mRunColor >> 16);
+    mFrameData.push_back(mRunColor >>  8);
+    mFrameData.push_back(mRunColor);
+    mRunLength = 0;
+}
+
+/*
+** ============================================================================
+** Returns the greatest common divisor of a and b, used to find the length of
+** a loop made of whole frame intervals or whole effect steps
+** ============================================================================
+*/
+uint32_t BakedEffect::greatestCommonDivisor(uint32_t a, uint32_t b)
+{
+    while (b != 0)
+    {
+        uint32_t remainder = a % b;
+        a = b;
+        b = remainder;
+    }
+    return a;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "NpbWrapper.h"
+
+#include <stdint.h>
+#include <vector>
+
+/*
+**-----------------------------------------------------------------------------
+** Stores every frame of one period of a periodic effect so the effect can be
+** replayed without evaluating it.  Frames are sampled every frame interval and
+** run length encoded (a run is a count byte followed by a WRGB color), which
+** keeps solid and sparse effects such as chases very small.  Replaying looks up
+** the frame for the effect time and decodes it straight into the pixel wrapper.
+**
+** Baking is spread over several loop passes by the caller, only one effect is
+** baked at a time and all baked effects share MAX_TOTAL_BAKED_BYTES.
+**-----------------------------------------------------------------------------
+*/
+class BakedEffect
+{
+    public:
+        BakedEffect();
+        virtual ~BakedEffect();
+
+        #ifdef ESP8266
+        static const uint32_t MAX_BAKED_BYTES = 12288;
+        static const uint32_t MAX_TOTAL_BAKED_BYTES = 16384;
+        #else
+        static const uint32_t MAX_BAKED_BYTES = 65536;
+        static const uint32_t MAX_TOTAL_BAKED_BYTES = 131072;
+        #endif
+        static const uint16_t MAX_BAKED_FRAMES = 1024;
+        static const uint16_t DEFAULT_FRAME_INTERVAL_MS = 20;
+
+        // Baking
+        bool begin(uint16_t numPixels, uint32_t period, uint16_t frameInterval);
+        void addPixel(uint32_t color);
+        bool endFrame();
+        void finish(uint32_t bakeTimeMs);
+        void clear();
+
+        bool isBaking() const { return this == sBakingEffect; }
+        static bool isBakeInProgress() { return nullptr != sBakingEffect; }
+        static uint32_t getTotalBakedBytes() { return sTotalBakedBytes; }
+        static uint32_t greatestCommonDivisor(uint32_t a, uint32_t b);
+
+        // Replay
+        uint16_t replay(NeoPixelWrapper* pixelWrapper, uint16_t startingAddress, uint32_t effectTime);
+
+        bool isValid() const { return mIsValid; }
+        uint32_t getPeriod() const { return mPeriod; }
+        uint16_t getFrameInterval() const { return mFrameInterval; }
+        uint16_t getNumberOfFrames() const { return mIsValid ? mFrameOffsets.size() - 1 : 0; }
+        uint32_t getFrameTime(uint16_t frameIndex) const { return (uint32_t)frameIndex * mFrameInterval; }
+        uint32_t getMemoryUsage() const { return mFrameData.capacity() + (mFrameOffsets.capacity() * sizeof(uint32_t)); }
+        uint32_t getBakeTime() const { return mBakeTimeMs; }
+        uint16_t getReplayFps() const { return mReplayFps; }
+
+    private:
+        BakedEffect(const BakedEffect&);
+        BakedEffect& operator=(const BakedEffect&);
+
+        void flushRun();
+
+    private:
+        std::vector<uint8_t>    mFrameData;
+        std::vector<uint32_t>   mFrameOffsets;
+
+        uint16_t    mNumPixels;
+        uint32_t    mPeriod;
+        uint16_t    mFrameInterval;
+        bool        mIsValid;
+
+        // Bytes of this effect counted in sTotalBakedBytes
+        uint32_t    mAccountedBytes;
+
+        // Run length encoder state while baking
+        uint32_t    mRunColor;
+        uint8_t     mRunLength;
+
+        // Statistics
+        uint32_t    mBakeTimeMs;
+        uint16_t    mReplayCount;
+        uint16_t    mReplayFps;
+        uint32_t    mReplayWindowStart;
+
+        static BakedEffect* sBakingEffect;
+        static uint32_t     sTotalBakedBytes;
+};
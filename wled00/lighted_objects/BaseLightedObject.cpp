@@ -4,10 +4,16 @@
 
 std::initializer_list<const char*> BaseLightedObject::SUPPORTED_EFFECTS = {"None"};
 const char* BaseLightedObject::EFFECT_KEY = "effect";
+const char* BaseLightedObject::COLOR_SET_KEY = "colorSet";
+const char* BaseLightedObject::COLOR_SET_OFFSET_KEY = "colorSetOffset";
+const char* BaseLightedObject::EFFECT_SPEED_KEY = "effectSpeed";
+const char* BaseLightedObject::OUTPUT_KEY = "output";
 const char* ILightedObject::TYPE_ELEMENT = "type";
 const char* BaseLightedObject::SELECTED_EFFECT_ELEMENT = "selectedEffect";
 const char* BaseLightedObject::BRIGHTNESS_PCT_ELEMENT = "brightnessPct";
 const char* BaseLightedObject::POWERED_ON_ELEMENT = "poweredOn";  
+const char* BaseLightedObject::BAKE_EFFECT_ELEMENT = "bakeEffect";
+const char* BaseLightedObject::BAKE_STATS_ELEMENT = "bakeStats";
 const char* BaseLightedObject::UI_ELEMENTS_ARRAY_ELEMENT = "UIElements";
 
 /*
@@ -18,11 +24,32 @@ const char* BaseLightedObject::UI_ELEMENTS_ARRAY_ELEMENT = "UIElements";
 BaseLightedObject::BaseLightedObject()
     : mPixelWrapper( nullptr )
     , mTotalTimeRunning( 0 )
+    , mEffectStartTime( 0 )
+    , mEffectStarted( false )
     , mStartingAddress( 0 )
     , mNumberOfLEDs( 50 )
     , mPoweredOn( true )
+    , mFrameHash( FRAME_HASH_SEED )
+    , mLastFrameHash( FRAME_HASH_SEED )
+    , mFrameInvalidated( true )
+    , mBakingEnabled( false )
+    , mBakeAttempted( false )
+    , mBakeFrameTime( 0 )
+    , mBakeMicros( 0 )
+    , mSelectedEffect( 0 )
+    , mColorSet( nullptr )
+    , mColorSetOffset( 0 )
+    , mEffectSpeed( DEFAULT_EFFECT_SPEED )
+    , mOutput( 0 )
 {
     mDropDownSelections[EFFECT_KEY] = 0;
+    mDropDownSelections[COLOR_SET_KEY] = ColorSetStore::DEFAULT_COLOR_SET_ID;
+    mNumericValues[COLOR_SET_OFFSET_KEY] = 0;
+    mNumericValues[EFFECT_SPEED_KEY] = DEFAULT_EFFECT_SPEED;
+    mNumericValues[OUTPUT_KEY] = 0;
+
+    // Every entry of the maps is a separate tree node on the heap
+    HEAP_COUNT_ALLOCATIONS(HEAP_SITE_OBJECT_MAP, mDropDownSelections.size() + mNumericValues.size());
 }
 
 /*
@@ -51,22 +78,75 @@ std::list<const char*> BaseLightedObject::getSupportedEffects() const
 ** have for this 'frame'.  Note that this handles deciding if the pixels should
 ** be updated by the specialized effect function or turned off.
 **
-**  param delta - the number of milliseconds since the last update
+** The effect time is measured from the first frame after the parameters last
+** changed, so a frame that is dropped or delayed does not slow the effect down.
+**
+** Every color written is hashed so that a frame that is identical to the one
+** before it (a static effect, or an object that is off) is not reported as a
+** change and the display does not need to send it again.
+**
+**  param currentTime - timestamp (ms) of the frame being rendered
+**  returns true if the frame differs from the previous frame
 ** ============================================================================
 */
-bool BaseLightedObject::runEffect(uint32_t delta)
+bool BaseLightedObject::runEffect(uint32_t currentTime)
 {
-    mTotalTimeRunning += delta;
+    if (!mEffectStarted)
+    {
+        mEffectStartTime = currentTime;
+        mEffectStarted = true;
+    }
+    mTotalTimeRunning = currentTime - mEffectStartTime; // unsigned math handles millis() rollover
+    mFrameHash = FRAME_HASH_SEED;
 
     if (mPoweredOn)
     {
-        return runSpecializedEffect();
+        if (mBakingEnabled)
+        {
+            // Bake a few frames per loop pass after the parameters changed, until the effect
+            // is baked (or can not be baked) it keeps being rendered normally
+            if (!mBakeAttempted)
+            {
+                bakeNextFrames();
+            }
+
+            if (mBakedEffect.isValid())
+            {
+                // The frame index identifies the replayed pixels
+                addToFrameHash(mBakedEffect.replay(mPixelWrapper, mStartingAddress, mTotalTimeRunning));
+            }
+            else
+            {
+                runSpecializedEffect();
+            }
+        }
+        else
+        {
+            runSpecializedEffect();
+        }
     }
     else
     {
         turnOffPixelsInRange(mStartingAddress, mNumberOfLEDs);
-        return true;
     }
+
+    bool hasChanged = mFrameInvalidated || (mFrameHash != mLastFrameHash);
+    mLastFrameHash = mFrameHash;
+    mFrameInvalidated = false;
+    return hasChanged;
+}
+
+/*
+** ============================================================================
+** Enables or disables baking of the current effect.  The effect is baked on
+** the next frame, disabling releases the baked frames right away.
+** ============================================================================
+*/
+void BaseLightedObject::enableBaking(bool enabled)
+{
+    mBakingEnabled = enabled;
+    mBakeAttempted = false;
+    mBakedEffect.clear();
 }
 
 /*
@@ -86,6 +166,7 @@ void BaseLightedObject::update(const char* userInputValues)
     JsonArray userInputValueArray = jsonDoc.as<JsonArray>();
     deserializeUiElements(userInputValueArray);
 
+    applyCommonParameters();
     onParametersUpdated();
 }
 
@@ -100,6 +181,7 @@ void BaseLightedObject::deserializeAndApplyStateFromJson(JsonObject newState)
 {
     // Deserialize state variables
     POPULATE_FROM_JSON(mPoweredOn, newState[POWERED_ON_ELEMENT]);
+    POPULATE_FROM_JSON(mBakingEnabled, newState[BAKE_EFFECT_ELEMENT]);
     
     // Deserialize all UI Elements
     JsonArray uiElementsArray = newState[UI_ELEMENTS_ARRAY_ELEMENT];
@@ -109,6 +191,7 @@ void BaseLightedObject::deserializeAndApplyStateFromJson(JsonObject newState)
     deserializeSpecializedData(newState);
 
     // Fire the hook to let the derived class know that parameters have been updated
+    applyCommonParameters();
     onParametersUpdated();
 }
 
@@ -125,6 +208,7 @@ void BaseLightedObject::serializeCurrentStateToJson(JsonObject& currentState) co
     // Serialize state variables
     currentState[TYPE_ELEMENT] = String(getObjectType().c_str());
     currentState[POWERED_ON_ELEMENT] = mPoweredOn;
+    currentState[BAKE_EFFECT_ELEMENT] = mBakingEnabled;
 
     // Serialize all UI Elements
     JsonArray uiElementsArray = currentState.createNestedArray(UI_ELEMENTS_ARRAY_ELEMENT);
@@ -134,6 +218,111 @@ void BaseLightedObject::serializeCurrentStateToJson(JsonObject& currentState) co
     serializeSepecializedData(currentState);
 }
 
+/*
+** ============================================================================
+** Serializes the runtime statistics of this lighted object.  The replay rate
+** of a baked effect changes every second, so these are not part of the state
+** that is cached and diffed for the web.
+**
+**  param   statistics - JSON object to serialize into
+** ============================================================================
+*/
+void BaseLightedObject::serializeStatisticsToJson(JsonObject& statistics) const
+{
+    statistics[TYPE_ELEMENT] = String(getObjectType().c_str());
+
+    if (mBakedEffect.isValid())
+    {
+        JsonObject bakeStats = statistics.createNestedObject(BAKE_STATS_ELEMENT);
+        bakeStats["frames"] = mBakedEffect.getNumberOfFrames();
+        bakeStats["periodMs"] = mBakedEffect.getPeriod();
+        bakeStats["bytes"] = mBakedEffect.getMemoryUsage();
+        bakeStats["bakeMs"] = mBakedEffect.getBakeTime();
+        bakeStats["replayFps"] = mBakedEffect.getReplayFps();
+    }
+}
+
+/*
+** ============================================================================
+** Serializes the state of this lighted object into a compact binary form.  The
+** object type is not written, that is up to the caller since it is needed to
+** create the object before it can be deserialized.
+**
+**  param   writer - binary writer to serialize into
+** ============================================================================
+*/
+void BaseLightedObject::serializeBinary(BinaryWriter& writer) const
+{
+    uint8_t flags = (mPoweredOn ? 0x01 : 0x00) | (mBakingEnabled ? 0x02 : 0x00);
+    writer.writeUInt8(flags);
+
+    writer.writeVarUInt(mNumericValues.size());
+    for (const NumericValueEntry& numericValue : mNumericValues)
+    {
+        writer.writeString(numericValue.first);
+        writer.writeVarInt(numericValue.second);
+    }
+
+    writer.writeVarUInt(mDropDownSelections.size());
+    for (const DropDownSelectionEntry& dropDownSelection : mDropDownSelections)
+    {
+        writer.writeString(dropDownSelection.first);
+        writer.writeVarInt(dropDownSelection.second);
+    }
+
+    // Hand off to derived class to serialize any specialized data
+    serializeSpecializedBinary(writer);
+}
+
+/*
+** ============================================================================
+** Populates the state of this lighted object from data written by serializeBinary
+**
+**  param   reader - binary reader to deserialize from
+**  returns true if all of the data could be read
+** ============================================================================
+*/
+bool BaseLightedObject::deserializeBinary(BinaryReader& reader)
+{
+    uint8_t flags = 0x01;
+    reader.readUInt8(flags);
+    mPoweredOn = (flags & 0x01) != 0;
+    mBakingEnabled = (flags & 0x02) != 0;
+
+    uint32_t numEntries = 0;
+    reader.readVarUInt(numEntries);
+    for (uint32_t entry = 0; entry < numEntries && reader.isValid(); ++entry)
+    {
+        std::string key;
+        int32_t value = 0;
+        if (reader.readString(key) && reader.readVarInt(value))
+        {
+            mNumericValues[key] = value;
+        }
+    }
+
+    numEntries = 0;
+    reader.readVarUInt(numEntries);
+    for (uint32_t entry = 0; entry < numEntries && reader.isValid(); ++entry)
+    {
+        std::string key;
+        int32_t value = 0;
+        if (reader.readString(key) && reader.readVarInt(value))
+        {
+            mDropDownSelections[key] = value;
+        }
+    }
+
+    // Hand off to derived class to deserialize any specialized data
+    deserializeSpecializedBinary(reader);
+
+    // Fire the hook to let the derived class know that parameters have been updated
+    applyCommonParameters();
+    onParametersUpdated();
+
+    return reader.isValid();
+}
+
 /*
 ** ============================================================================
 ** Set the pixel at the given address to the given color
@@ -141,6 +330,8 @@ void BaseLightedObject::serializeCurrentStateToJson(JsonObject& currentState) co
 */
 void BaseLightedObject::setPixelColor(uint16_t address, uint32_t color)
 {
+    addToFrameHash(color);
+
     byte white  = (color >> 24);
     byte red    = (color >> 16);
     byte green  = (color >>  8);
@@ -161,6 +352,159 @@ void BaseLightedObject::setPixelColorForRange(uint16_t startingAddress, uint16_t
     }
 }
 
+/*
+** ============================================================================
+** Default effect implementation, every pixel of this object is set to the
+** color returned by renderPixel for the current effect time.
+** ============================================================================
+*/
+void BaseLightedObject::runSpecializedEffect()
+{
+    for (uint16_t pixelIndex = 0; pixelIndex < mNumberOfLEDs; ++pixelIndex)
+    {
+        setPixelColor(mStartingAddress + pixelIndex, renderPixel(pixelIndex, mTotalTimeRunning));
+    }
+}
+
+/*
+** ============================================================================
+** Returns the color for the given position, taken from the selected color set
+** (shifted by the color set offset) or from the object's default colors.
+** ============================================================================
+*/
+uint32_t BaseLightedObject::getPaletteColor(uint16_t position) const
+{
+    if (nullptr != mColorSet)
+    {
+        return mColorSet->getColor(position, mColorSetOffset);
+    }
+
+    return getDefaultColor(position);
+}
+
+/*
+** ============================================================================
+** Returns how many LEDs a moving effect has advanced after effectTime ms.  The
+** effect speed is in LEDs per second.
+** ============================================================================
+*/
+uint32_t BaseLightedObject::getEffectShift(uint32_t effectTime) const
+{
+    return ((uint64_t)effectTime * mEffectSpeed) / 1000;
+}
+
+/*
+** ============================================================================
+** Chase effect, every CHASE_SPACING'th LED is lit and the lit LEDs move along
+** the object at the effect speed.  Each lit LED keeps its color as it moves.
+** The position is reduced modulo the length of the whole pattern, so the
+** colors stay in order however far the effect has shifted and the effect
+** repeats every getChasePeriod, as the baked replay expects.
+** ============================================================================
+*/
+uint32_t BaseLightedObject::renderChase(uint16_t pixelIndex, uint32_t effectTime) const
+{
+    uint16_t paletteLength = getPaletteLength();
+    uint32_t patternLength = (uint32_t)CHASE_SPACING * (paletteLength > 0 ? paletteLength : 1);
+    uint32_t position = (pixelIndex + patternLength - getEffectShift(effectTime) % patternLength) % patternLength;
+    if (position % CHASE_SPACING != 0)
+    {
+        return 0;
+    }
+
+    return getPaletteColor(position / CHASE_SPACING);
+}
+
+/*
+** ============================================================================
+** Twinkle effect, each LED fades in and out with its own phase and for every
+** cycle a hash of the LED and the cycle number decides if it lights up.  The
+** cycle length gets shorter as the effect speed goes up.
+** ============================================================================
+*/
+uint32_t BaseLightedObject::renderTwinkle(uint16_t pixelIndex, uint32_t effectTime) const
+{
+    uint32_t period = TWINKLE_PERIOD_SCALE_MS / (mEffectSpeed > 0 ? mEffectSpeed : 1);
+    uint32_t phasedTime = effectTime + (hashPixel(pixelIndex) % period);
+    uint32_t cycle = phasedTime / period;
+
+    if (hashPixel(pixelIndex ^ ((cycle % TWINKLE_CYCLES) << 16)) % 3 != 0)
+    {
+        return 0;
+    }
+
+    // Triangle wave brightness over the cycle
+    uint32_t timeInCycle = phasedTime % period;
+    uint32_t halfPeriod = period / 2;
+    uint32_t brightness = (timeInCycle < halfPeriod) ? timeInCycle : (period - timeInCycle);
+    brightness = (halfPeriod > 0) ? (brightness * 255) / halfPeriod : 255;
+
+    return scaleColor(getPaletteColor(pixelIndex), brightness > 255 ? 255 : brightness);
+}
+
+/*
+** ============================================================================
+** Returns the number of positions after which getPaletteColor repeats
+** ============================================================================
+*/
+uint16_t BaseLightedObject::getPaletteLength() const
+{
+    return (nullptr != mColorSet) ? mColorSet->numColors : getDefaultColorCount();
+}
+
+/*
+** ============================================================================
+** Returns the period (ms) of renderChase.  The pattern repeats once the lit
+** LEDs have moved through every palette color, the period is the first whole
+** ms at which getEffectShift has moved by a whole number of patterns so the
+** replay of the baked effect has no seam where it loops.
+** ============================================================================
+*/
+uint32_t BaseLightedObject::getChasePeriod() const
+{
+    uint16_t paletteLength = getPaletteLength();
+    uint32_t patternMillis = (uint32_t)CHASE_SPACING * (paletteLength > 0 ? paletteLength : 1) * 1000;
+    uint32_t speed = (mEffectSpeed > 0 ? mEffectSpeed : 1);
+    return patternMillis / BakedEffect::greatestCommonDivisor(patternMillis, speed);
+}
+
+/*
+** ============================================================================
+** Returns the period (ms) of renderTwinkle
+** ============================================================================
+*/
+uint32_t BaseLightedObject::getTwinklePeriod() const
+{
+    return (TWINKLE_PERIOD_SCALE_MS / (mEffectSpeed > 0 ? mEffectSpeed : 1)) * TWINKLE_CYCLES;
+}
+
+/*
+** ============================================================================
+** Scales every channel of the given color by scale / 256
+** ============================================================================
+*/
+uint32_t BaseLightedObject::scaleColor(uint32_t color, uint8_t scale)
+{
+    uint32_t redBlue = ((color & 0x00FF00FF) * (scale + 1)) >> 8;
+    uint32_t whiteGreen = (((color >> 8) & 0x00FF00FF) * (scale + 1)) >> 8;
+    return (redBlue & 0x00FF00FF) | ((whiteGreen & 0x00FF00FF) << 8);
+}
+
+/*
+** ============================================================================
+** Integer hash used to give pixels pseudo random but repeatable behavior
+** ============================================================================
+*/
+uint32_t BaseLightedObject::hashPixel(uint32_t value)
+{
+    value ^= value >> 16;
+    value *= 0x7FEB352D;
+    value ^= value >> 15;
+    value *= 0x846CA68B;
+    value ^= value >> 16;
+    return value;
+}
+
 /*
 ** ============================================================================
 ** Turn off the pixels in the given address range
@@ -187,7 +531,23 @@ void BaseLightedObject::appendCommonUiElements(JsonArray& uiElementsArray) const
     int lastAddress = mStartingAddress + mNumberOfLEDs - 1;
     appendStringElement(uiElementsArray, TextTypeSmall, "Address range %d to %d (%d LEDs)", mStartingAddress, lastAddress, mNumberOfLEDs);
     
-    appendDropDownElement(uiElementsArray, getSupportedEffects(), mDropDownSelections.at(EFFECT_KEY), "Effect:", EFFECT_KEY);
+    std::list<const char*> supportedEffects = getSupportedEffects();
+    HEAP_COUNT_ALLOCATIONS(HEAP_SITE_EFFECT_LIST, supportedEffects.size());
+    appendDropDownElement(uiElementsArray, supportedEffects, mDropDownSelections.at(EFFECT_KEY), "Effect:", EFFECT_KEY);
+
+    std::list<const char*> colorSetNames;
+    ColorSetStore& colorSetStore = ColorSetStore::get();
+    for (uint8_t colorSetId = 0; colorSetId < colorSetStore.getNumberOfColorSets(); ++colorSetId)
+    {
+        colorSetNames.push_back(colorSetStore.getColorSetName(colorSetId));
+    }
+    appendDropDownElement(uiElementsArray, colorSetNames, mDropDownSelections.at(COLOR_SET_KEY), "Color Set:", COLOR_SET_KEY);
+    appendNumericElement(uiElementsArray, "Color Set Offset", 0, 255, mNumericValues.at(COLOR_SET_OFFSET_KEY), COLOR_SET_OFFSET_KEY);
+    appendNumericElement(uiElementsArray, "Effect Speed (LEDs/s)", 1, 255, mNumericValues.at(EFFECT_SPEED_KEY), EFFECT_SPEED_KEY);
+
+    #if WLED_MAX_PIXEL_OUTPUTS > 1
+    appendNumericElement(uiElementsArray, "Output", 0, WLED_MAX_PIXEL_OUTPUTS - 1, mNumericValues.at(OUTPUT_KEY), OUTPUT_KEY);
+    #endif
 }
 
 /*
@@ -200,7 +560,7 @@ void BaseLightedObject::appendCommonUiElements(JsonArray& uiElementsArray) const
 **  param   inputKey - the key that identifies this input when parsing the save object JSON request
 ** ============================================================================
 */
-void BaseLightedObject::appendDropDownElement(JsonArray& uiElementsArray, std::list<const char*> optionsList, int selectedIndex, const char* label, const char* inputKey) const
+void BaseLightedObject::appendDropDownElement(JsonArray& uiElementsArray, const std::list<const char*>& optionsList, int selectedIndex, const char* label, const char* inputKey) const
 {
     JsonObject dropDownElement = uiElementsArray.createNestedObject();
     dropDownElement["elementType"] = "dropdown";
@@ -303,6 +663,84 @@ void BaseLightedObject::deserializeUiElements(const JsonArray& uiElementsArray)
     }
 }
 
+/*
+** ============================================================================
+** Copies the common parameters out of the parameter maps so that they can be
+** used per pixel, and restarts the effect so it begins from time 0 with the
+** new parameters.
+** ============================================================================
+*/
+void BaseLightedObject::applyCommonParameters()
+{
+    mSelectedEffect = mDropDownSelections[EFFECT_KEY];
+    mColorSet = ColorSetStore::get().getColorSet(mDropDownSelections[COLOR_SET_KEY]);
+    mColorSetOffset = mNumericValues[COLOR_SET_OFFSET_KEY];
+    mEffectSpeed = mNumericValues[EFFECT_SPEED_KEY];
+    mOutput = mNumericValues[OUTPUT_KEY];
+    mEffectStarted = false;
+    mFrameInvalidated = true;
+
+    // Any baked frames are for the old parameters
+    mBakedEffect.clear();
+    mBakeAttempted = false;
+}
+
+/*
+** ============================================================================
+** Renders the next frames of the current effect into mBakedEffect.  Every
+** pixel of every frame is evaluated, so only as many frames as fit in
+** BAKE_TIME_BUDGET_US are rendered per loop pass and the bake is spread over
+** as many passes as it needs.  Only one object bakes at a time, the others
+** wait for their turn.  mBakeAttempted is set once the effect is baked or it
+** turned out that it can not be baked.
+** ============================================================================
+*/
+void BaseLightedObject::bakeNextFrames()
+{
+    if (!mBakedEffect.isBaking())
+    {
+        if (BakedEffect::isBakeInProgress())
+        {
+            return;
+        }
+
+        if (!mBakedEffect.begin(mNumberOfLEDs, getEffectPeriod(), BakedEffect::DEFAULT_FRAME_INTERVAL_MS))
+        {
+            mBakeAttempted = true;
+            return;
+        }
+
+        mBakeFrameTime = 0;
+        mBakeMicros = 0;
+    }
+
+    uint32_t passStartTime = micros();
+    uint32_t period = mBakedEffect.getPeriod();
+    do
+    {
+        for (uint16_t pixelIndex = 0; pixelIndex < mNumberOfLEDs; ++pixelIndex)
+        {
+            mBakedEffect.addPixel(renderPixel(pixelIndex, mBakeFrameTime));
+        }
+
+        if (!mBakedEffect.endFrame())
+        {
+            DEBUG_PRINTLN(F("Effect too large to bake"));
+            mBakeAttempted = true;
+            return;
+        }
+
+        mBakeFrameTime += mBakedEffect.getFrameInterval();
+    } while (mBakeFrameTime < period && (micros() - passStartTime) < BAKE_TIME_BUDGET_US);
+
+    mBakeMicros += micros() - passStartTime;
+    if (mBakeFrameTime >= period)
+    {
+        mBakedEffect.finish(mBakeMicros / 1000);
+        mBakeAttempted = true;
+    }
+}
+
 /*
 ** ============================================================================
 ** Appends a Title element to the given uiElementsArray
@@ -349,21 +787,14 @@ void BaseLightedObject::setPixelColor(uint16_t address, byte red, byte green, by
     }
 }
 
-// MDR DEBUG TODO - Add hardcoded colorsets
-//                  Apply color set onto a lighted object
-//                  Allow color set offset adjustment
-//                  Bug: Adjust total number of leds in display and then try to turn leds on/off.  The display is in a messed up state, probably need to clear all lighted objects when reloading.
+// MDR DEBUG TODO - Bug: Adjust total number of leds in display and then try to turn leds on/off.  The display is in a messed up state, probably need to clear all lighted objects when reloading.
 //                  Bug: After clearing all objects I have LEDs still on, maybe need to turn the LEDs off before clearing the object.
 //                  Implement some basic effects
 // MDR DEBUG TODO - Investigate overlap between cfg.cpp settings and lightDisplay.cpp settings
 //                  see https://www.toptal.com/designers/htmlarrows/arrows/)
 //                  Add numeric slider control
 //                  Add effect intensity & speed controllers to snowflake
-//                  Create Scene objects
 //                  Move scenes up/down
-//                  Remove scenes
-//                  Save/Load Scenes
-//                  Use a json to load color sets (create it with default sets if it doesn't exist)
 //                  Implement functionality to edit color sets
 // MDR DEBUG TODO - update NodeMCU LED to blink instead of remaining on (seems to be a problem with NeoPixelWrapper)
 // MDR DEBUG TODO - clean up bri, briT, briLast and the stuff related to the night dimming mode
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "BakedEffect.h"
 #include "ILightedObject.h"
 #include <map>
 #include <string>
@@ -30,21 +31,31 @@ class BaseLightedObject : public ILightedObject
         /// All connected LEDs have a unique address, this is the address of the
         /// first LED in this object
         virtual uint16_t getStartingLEDNumber() const { return mStartingAddress; }
-        virtual void setStartingLEDNumber(uint16_t startingAddress) { mStartingAddress = startingAddress; }
+        virtual void setStartingLEDNumber(uint16_t startingAddress) { mStartingAddress = startingAddress; mFrameInvalidated = true; }
 
         /// This will return a JSON list of all effects supported by this type
         /// of object
         virtual std::list<const char*> getSupportedEffects() const;
 
-        /// This is called to run another 'frame' of the current effect.  Returns true if any pixels in this
-        /// object have changed.
-        virtual bool runEffect(uint32_t delta) final;
+        /// This is called to render the 'frame' of the current effect for the given timestamp.  Returns
+        /// true if any pixels in this object have changed since the previous frame.
+        virtual bool runEffect(uint32_t currentTime) final;
 
         // This will pass in the pointer to the Neo Pixel wrapper for the lighted object to interact with
-        virtual void setNeoPixelWrapper(NeoPixelWrapper* neoPixelWrapper) { mPixelWrapper = neoPixelWrapper; }    
+        virtual void setNeoPixelWrapper(NeoPixelWrapper* neoPixelWrapper) { mPixelWrapper = neoPixelWrapper; mFrameInvalidated = true; }
+
+        /// Index of the light display output (data pin) the LEDs of this object are connected to
+        virtual uint8_t getOutput() const { return mOutput; }
+
+        /// Length (ms) after which the current effect repeats itself, 0 if it never does
+        virtual uint32_t getEffectPeriod() const { return 0; }
+
+        /// When baking is enabled one period of the effect is rendered ahead of time and replayed
+        virtual void enableBaking(bool enabled);
+        virtual bool isBakingEnabled() const { return mBakingEnabled; }
 
         /// Allows you to toggle the power for this lighted object
-        virtual void togglePower() { mPoweredOn = !mPoweredOn; }         
+        virtual void togglePower() { mPoweredOn = !mPoweredOn; mFrameInvalidated = true; }
 
         /// Updates the parameters of this lighted object using the user input values taken from the UI
         virtual void update(const char* userInputValues); 
@@ -57,10 +68,29 @@ class BaseLightedObject : public ILightedObject
         /// state of this lighted object.  This provides the current state to the web
         virtual void serializeCurrentStateToJson(JsonObject& currentState) const final;
 
+        /// This will populate the given JSON object with the statistics of the baked effect
+        virtual void serializeStatisticsToJson(JsonObject& statistics) const final;
+
+        /// This will write the state of this lighted object into a compact binary form
+        virtual void serializeBinary(BinaryWriter& writer) const final;
+
+        /// This will read state written by serializeBinary and apply it to this lighted object
+        virtual bool deserializeBinary(BinaryReader& reader) final;
+
     // Constants
     protected:
         static const int MAX_UI_STRING_LENGTH = 64;
 
+        static const int DEFAULT_EFFECT_SPEED = 10;
+        static const int CHASE_SPACING = 4;
+        static const uint32_t TWINKLE_PERIOD_SCALE_MS = 20000;
+        static const uint32_t TWINKLE_CYCLES = 8; // twinkle pattern repeats after this many cycles
+        static const uint32_t BAKE_TIME_BUDGET_US = 2000; // time spent baking per loop pass
+
+        // FNV-1a, used to detect frames that are identical to the previous one
+        static const uint32_t FRAME_HASH_SEED = 2166136261UL;
+        static const uint32_t FRAME_HASH_PRIME = 16777619UL;
+
         typedef std::map<std::string /* key */, int /* value */> NumericValues;
         typedef std::pair<std::string, int> NumericValueEntry;
 
@@ -81,8 +111,22 @@ class BaseLightedObject : public ILightedObject
         void setPixelColorForRange(uint16_t startingAddress, uint16_t numPixels, uint32_t color);
         void turnOffPixelsInRange(uint16_t startingAddress, uint16_t numPixels);
 
+        // Building blocks for renderPixel, all are pure functions of their arguments and the parameters
+        uint32_t getPaletteColor(uint16_t position) const;
+        uint32_t getEffectShift(uint32_t effectTime) const;
+        uint32_t renderChase(uint16_t pixelIndex, uint32_t effectTime) const;
+        uint32_t renderTwinkle(uint16_t pixelIndex, uint32_t effectTime) const;
+
+        // Effect periods for the building blocks above
+        uint32_t getStaticPeriod() const { return BakedEffect::DEFAULT_FRAME_INTERVAL_MS; }
+        uint32_t getChasePeriod() const;
+        uint32_t getTwinklePeriod() const;
+        uint16_t getPaletteLength() const;
+        static uint32_t scaleColor(uint32_t color, uint8_t scale);
+        static uint32_t hashPixel(uint32_t value);
+
         void appendCommonUiElements(JsonArray& uiElementsArray) const;
-        void appendDropDownElement(JsonArray& uiElementsArray, std::list<const char*> optionsList, int selectedIndex, const char* label, const char* inputKey) const;
+        void appendDropDownElement(JsonArray& uiElementsArray, const std::list<const char*>& optionsList, int selectedIndex, const char* label, const char* inputKey) const;
         void appendNumericElement(JsonArray& uiElementsArray, const char* name, int minValue, int maxValue, const int currentValue, const char* inputKey) const;
         void appendStringElement(JsonArray& uiElementsArray, TextTypeE textType, const char* format, ...) const;
 
@@ -92,10 +136,27 @@ class BaseLightedObject : public ILightedObject
         virtual void serializeSepecializedData(JsonObject& currentState) const = 0;
         virtual void onParametersUpdated() = 0;
 
-        virtual bool runSpecializedEffect() { return false; }
+        /// Returns the color of the pixel at pixelIndex (relative to the first LED of this object) when the
+        /// effect has been running for effectTime ms.  This must only depend on its arguments and the
+        /// parameters of the object so that frames can be rendered in any order.
+        virtual uint32_t renderPixel(uint16_t pixelIndex, uint32_t effectTime) const { return getPaletteColor(pixelIndex); }
+
+        /// Color used at the given position when the "Default" color set is selected
+        virtual uint32_t getDefaultColor(uint16_t position) const { return 0x00FFFFFF; }
+
+        /// Number of positions after which getDefaultColor repeats
+        virtual uint16_t getDefaultColorCount() const { return 1; }
+
+        virtual void deserializeSpecializedBinary(BinaryReader& reader) {}
+        virtual void serializeSpecializedBinary(BinaryWriter& writer) const {}
+
+        virtual void runSpecializedEffect();
 
     private:
         void deserializeUiElements(const JsonArray& uiElementsArray);
+        void applyCommonParameters();
+        void bakeNextFrames();
+        void addToFrameHash(uint32_t value) { mFrameHash = (mFrameHash ^ value) * FRAME_HASH_PRIME; }
 
         void appendTitleElement(JsonArray& uiElementsArray, const char* format, ...) const;
 
@@ -104,21 +165,51 @@ class BaseLightedObject : public ILightedObject
     protected:
         NeoPixelWrapper *mPixelWrapper;
 
-        uint64_t mTotalTimeRunning;
+        // Time (ms) the current effect has been running, this is derived from the display
+        // timestamp every frame rather than accumulated
+        uint32_t mTotalTimeRunning;
+        uint32_t mEffectStartTime;
+        bool     mEffectStarted;
         uint16_t mStartingAddress;
         uint16_t mNumberOfLEDs;
         bool     mPoweredOn;
 
+        // Hash of every color written in the current and the previous frame.  A frame is only
+        // reported as changed if the hashes differ or the frame was invalidated (parameters,
+        // power, address or pixel wrapper changed).
+        uint32_t mFrameHash;
+        uint32_t mLastFrameHash;
+        bool     mFrameInvalidated;
+
+        BakedEffect mBakedEffect;
+        bool        mBakingEnabled;
+        bool        mBakeAttempted;
+        uint32_t    mBakeFrameTime; // effect time (ms) of the next frame to bake
+        uint32_t    mBakeMicros;    // time spent baking over every loop pass
+
         // Parameter storage that can be used by derived classes, these store
         // parameters in a map using a string key that corresponds to the key
         // used by the UI to refer to the parameter.
         NumericValues mNumericValues;
         DropDownSelections mDropDownSelections;
 
+        // Copies of common parameters so rendering a pixel does not need a map lookup
+        uint8_t         mSelectedEffect;
+        const ColorSet* mColorSet;
+        uint16_t        mColorSetOffset;
+        uint16_t        mEffectSpeed;
+        uint8_t         mOutput;
+
         static const char* EFFECT_KEY;     
+        static const char* COLOR_SET_KEY;
+        static const char* COLOR_SET_OFFSET_KEY;
+        static const char* EFFECT_SPEED_KEY;
+        static const char* OUTPUT_KEY;
 
         static const char* SELECTED_EFFECT_ELEMENT;
         static const char* BRIGHTNESS_PCT_ELEMENT;
         static const char* POWERED_ON_ELEMENT;
+        static const char* BAKE_EFFECT_ELEMENT;
+        static const char* BAKE_STATS_ELEMENT;
         static const char* UI_ELEMENTS_ARRAY_ELEMENT;
 };
@@ -0,0 +1,294 @@
+#include "BinaryStream.h"
+
+#include <string.h>
+
+/*
+** ============================================================================
+** Constructor
+** ============================================================================
+*/
+BinaryWriter::BinaryWriter()
+{
+}
+
+/*
+** ============================================================================
+** Destructor
+** ============================================================================
+*/
+BinaryWriter::~BinaryWriter()
+{
+}
+
+/*
+** ============================================================================
+** Appends a single byte
+** ============================================================================
+*/
+void BinaryWriter::writeUInt8(uint8_t value)
+{
+    mBuffer.push_back(value);
+}
+
+/*
+** ============================================================================
+** Appends a fixed size 16 bit value (little endian)
+** ============================================================================
+*/
+void BinaryWriter::writeUInt16(uint16_t value)
+{
+    mBuffer.push_back(value);
+    mBuffer.push_back(value >> 8);
+}
+
+/*
+** ============================================================================
+** Appends a fixed size 32 bit value (little endian)
+** ============================================================================
+*/
+void BinaryWriter::writeUInt32(uint32_t value)
+{
+    writeUInt16(value);
+    writeUInt16(value >> 16);
+}
+
+/*
+** ============================================================================
+** Appends an unsigned value using as few bytes as possible.  Each byte holds 7
+** bits of the value, the high bit is set if more bytes follow.
+** ============================================================================
+*/
+void BinaryWriter::writeVarUInt(uint32_t value)
+{
+    while (value >= 0x80)
+    {
+        mBuffer.push_back((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    mBuffer.push_back(value);
+}
+
+/*
+** ============================================================================
+** Appends a signed value using as few bytes as possible.  The value is zigzag
+** encoded first so that small negative numbers stay small.
+** ============================================================================
+*/
+void BinaryWriter::writeVarInt(int32_t value)
+{
+    uint32_t zigzagValue = ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+    writeVarUInt(zigzagValue);
+}
+
+/*
+** ============================================================================
+** Appends a length prefixed string
+** ============================================================================
+*/
+void BinaryWriter::writeString(const std::string& value)
+{
+    writeVarUInt(value.length());
+    writeBytes(reinterpret_cast<const uint8_t*>(value.data()), value.length());
+}
+
+/*
+** ============================================================================
+** Appends raw bytes
+** ============================================================================
+*/
+void BinaryWriter::writeBytes(const uint8_t* data, size_t length)
+{
+    if (nullptr != data && length > 0)
+    {
+        mBuffer.insert(mBuffer.end(), data, data + length);
+    }
+}
+
+/*
+** ============================================================================
+** Constructor
+**
+**  param   data - buffer to read from, this must outlive the reader
+**  param   length - number of bytes in the buffer
+** ============================================================================
+*/
+BinaryReader::BinaryReader(const uint8_t* data, size_t length)
+    : mData( data )
+    , mLength( (nullptr != data) ? length : 0 )
+    , mPosition( 0 )
+    , mIsValid( true )
+{
+}
+
+/*
+** ============================================================================
+** Destructor
+** ============================================================================
+*/
+BinaryReader::~BinaryReader()
+{
+}
+
+/*
+** ============================================================================
+** Reads a single byte
+** ============================================================================
+*/
+bool BinaryReader::readUInt8(uint8_t& value)
+{
+    if (!canRead(1))
+    {
+        return false;
+    }
+
+    value = mData[mPosition++];
+    return true;
+}
+
+/*
+** ============================================================================
+** Reads a fixed size 16 bit value (little endian)
+** ============================================================================
+*/
+bool BinaryReader::readUInt16(uint16_t& value)
+{
+    if (!canRead(2))
+    {
+        return false;
+    }
+
+    value = mData[mPosition] | (mData[mPosition + 1] << 8);
+    mPosition += 2;
+    return true;
+}
+
+/*
+** ============================================================================
+** Reads a fixed size 32 bit value (little endian)
+** ============================================================================
+*/
+bool BinaryReader::readUInt32(uint32_t& value)
+{
+    uint16_t lowWord = 0;
+    uint16_t highWord = 0;
+    if (!readUInt16(lowWord) || !readUInt16(highWord))
+    {
+        return false;
+    }
+
+    value = ((uint32_t)highWord << 16) | lowWord;
+    return true;
+}
+
+/*
+** ============================================================================
+** Reads an unsigned value written by BinaryWriter::writeVarUInt
+** ============================================================================
+*/
+bool BinaryReader::readVarUInt(uint32_t& value)
+{
+    uint32_t result = 0;
+    for (uint8_t shift = 0; shift < 35; shift += 7)
+    {
+        uint8_t currentByte = 0;
+        if (!readUInt8(currentByte))
+        {
+            return false;
+        }
+
+        result |= (uint32_t)(currentByte & 0x7F) << shift;
+        if ((currentByte & 0x80) == 0)
+        {
+            value = result;
+            return true;
+        }
+    }
+
+    // More than 5 bytes can not be a valid 32 bit value
+    mIsValid = false;
+    return false;
+}
+
+/*
+** ============================================================================
+** Reads a signed value written by BinaryWriter::writeVarInt
+** ============================================================================
+*/
+bool BinaryReader::readVarInt(int32_t& value)
+{
+    uint32_t zigzagValue = 0;
+    if (!readVarUInt(zigzagValue))
+    {
+        return false;
+    }
+
+    value = (int32_t)(zigzagValue >> 1) ^ -(int32_t)(zigzagValue & 1);
+    return true;
+}
+
+/*
+** ============================================================================
+** Reads a length prefixed string
+** ============================================================================
+*/
+bool BinaryReader::readString(std::string& value)
+{
+    uint32_t length = 0;
+    if (!readVarUInt(length) || !canRead(length))
+    {
+        return false;
+    }
+
+    value.assign(reinterpret_cast<const char*>(mData + mPosition), length);
+    mPosition += length;
+    return true;
+}
+
+/*
+** ============================================================================
+** Reads raw bytes into the given buffer
+** ============================================================================
+*/
+bool BinaryReader::readBytes(uint8_t* data, size_t length)
+{
+    if (nullptr == data || !canRead(length))
+    {
+        return false;
+    }
+
+    memcpy(data, mData + mPosition, length);
+    mPosition += length;
+    return true;
+}
+
+/*
+** ============================================================================
+** Moves past the given number of bytes without reading them
+** ============================================================================
+*/
+bool BinaryReader::skip(size_t length)
+{
+    if (!canRead(length))
+    {
+        return false;
+    }
+
+    mPosition += length;
+    return true;
+}
+
+/*
+** ============================================================================
+** Returns true if there are at least length bytes left to read.  If there are
+** not then the reader is put into its error state.
+** ============================================================================
+*/
+bool BinaryReader::canRead(size_t length)
+{
+    if (mIsValid && length > mLength - mPosition)
+    {
+        mIsValid = false;
+    }
+
+    return mIsValid;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/*
+**-----------------------------------------------------------------------------
+** Writes values into a compact binary buffer.  Integers are stored as variable
+** length values (7 bits per byte, signed values are zigzag encoded) so that the
+** small numbers used for most lighted object parameters only take one byte.
+** Strings are stored as a length followed by the characters (no terminator).
+**-----------------------------------------------------------------------------
+*/
+class BinaryWriter
+{
+    public:
+        BinaryWriter();
+        virtual ~BinaryWriter();
+
+        void writeUInt8(uint8_t value);
+        void writeUInt16(uint16_t value);
+        void writeUInt32(uint32_t value);
+        void writeVarUInt(uint32_t value);
+        void writeVarInt(int32_t value);
+        void writeString(const std::string& value);
+        void writeBytes(const uint8_t* data, size_t length);
+
+        void clear() { mBuffer.clear(); }
+
+        const std::vector<uint8_t>& getBuffer() const { return mBuffer; }
+        std::vector<uint8_t>& getBuffer() { return mBuffer; }
+
+    private:
+        std::vector<uint8_t> mBuffer;
+};
+
+/*
+**-----------------------------------------------------------------------------
+** Reads values that were written by a BinaryWriter.  Reading past the end of
+** the data puts the reader into an error state, every read after that fails
+** and isValid() returns false, so callers only need to check once at the end.
+**-----------------------------------------------------------------------------
+*/
+class BinaryReader
+{
+    public:
+        BinaryReader(const uint8_t* data, size_t length);
+        virtual ~BinaryReader();
+
+        bool readUInt8(uint8_t& value);
+        bool readUInt16(uint16_t& value);
+        bool readUInt32(uint32_t& value);
+        bool readVarUInt(uint32_t& value);
+        bool readVarInt(int32_t& value);
+        bool readString(std::string& value);
+        bool readBytes(uint8_t* data, size_t length);
+        bool skip(size_t length);
+
+        const uint8_t* getCurrentPosition() const { return mData + mPosition; }
+        size_t getRemainingLength() const { return mLength - mPosition; }
+        bool isValid() const { return mIsValid; }
+
+    private:
+        bool canRead(size_t length);
+
+    private:
+        const uint8_t*  mData;
+        size_t          mLength;
+        size_t          mPosition;
+        bool            mIsValid;
+};
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "BinaryStream.h"
 #include "LightedObjectFactoryRegistration.h"
 
 #include "NpbWrapper.h"
@@ -19,6 +20,8 @@
 class ILightedObject
 {
     public:
+        virtual ~ILightedObject() {}
+
         /// Returns the name of this object type
         virtual std::string getObjectType() const = 0;
 
@@ -34,12 +37,26 @@ class ILightedObject
         /// of object
         virtual std::list<const char*> getSupportedEffects() const = 0;
 
-        /// This is called to run another 'frame' of the current effect
-        virtual bool runEffect(uint32_t delta) = 0;
+        /// This is called to render the 'frame' of the current effect for the given
+        /// timestamp (ms).  The frame only depends on the timestamp and the parameters,
+        /// not on which frames were rendered before, so frames can be skipped freely
+        virtual bool runEffect(uint32_t currentTime) = 0;
 
         // This will pass in the pointer to the Neo Pixel wrapper for the lighted object to interact with
         virtual void setNeoPixelWrapper(NeoPixelWrapper* neoPixelWrapper) = 0;
 
+        /// Index of the light display output (data pin) the LEDs of this object are connected
+        /// to.  The starting address is relative to the first LED of that output
+        virtual uint8_t getOutput() const = 0;
+
+        /// Length (ms) after which the current effect repeats itself, 0 if it never does
+        virtual uint32_t getEffectPeriod() const = 0;
+
+        /// When baking is enabled one period of the effect is rendered ahead of time and
+        /// replayed instead of evaluating the effect every frame
+        virtual void enableBaking(bool enabled) = 0;
+        virtual bool isBakingEnabled() const = 0;
+
         /// Allows you to toggle the power for this lighted object
         virtual void togglePower() = 0;      
 
@@ -54,6 +71,19 @@ class ILightedObject
         /// state of this lighted object.  This provides the current state to the web
         virtual void serializeCurrentStateToJson(JsonObject& currentState) const = 0;
 
+        /// This will populate the given JSON object with runtime statistics of this lighted
+        /// object (for example of its baked effect).  These change while the object runs, so
+        /// they are kept out of the current state and only reported in /json/perf
+        virtual void serializeStatisticsToJson(JsonObject& statistics) const = 0;
+
+        /// This will write the state of this lighted object (power, parameters and effect
+        /// selections) into a compact binary form.  This is used for scene snapshots
+        virtual void serializeBinary(BinaryWriter& writer) const = 0;
+
+        /// This will read state written by serializeBinary and apply it to this lighted
+        /// object.  Returns false if the data was truncated or corrupt
+        virtual bool deserializeBinary(BinaryReader& reader) = 0;
+
         /// This one JSON element tag is defined in the interface so that we can read it in Light Display
         /// when trying to decide which type of ILightedObject to create in order to deserialize the 
         /// array of lighted objects
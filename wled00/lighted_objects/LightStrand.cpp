@@ -60,30 +60,45 @@ void LightStrand::onParametersUpdated()
 
 /*
 ** ============================================================================
-** Run the currently selected effect
+** Default colors repeat red, green, blue and purple along the strand
 ** ============================================================================
 */
-bool LightStrand::runSpecializedEffect()
+uint32_t LightStrand::getDefaultColor(uint16_t position) const
 {
-    for (int address = mStartingAddress; address < mStartingAddress + mNumberOfLEDs; ++address)
+    static const uint32_t DEFAULT_COLORS[] = { 0x00FF0000, 0x0003D000, 0x000200FF, 0x00FF0085 }; // RED, GREEN, BLUE, PURPLE
+    return DEFAULT_COLORS[position % 4];
+}
+
+/*
+** ============================================================================
+** Returns the color of a pixel for the currently selected effect
+** ============================================================================
+*/
+uint32_t LightStrand::renderPixel(uint16_t pixelIndex, uint32_t effectTime) const
+{
+    switch (mSelectedEffect)
     {
-        if (address % 4 == 0)
-        {
-            setPixelColor(address, 0x00FF0000); // RED
-        }
-        else if (address % 4 == 1)
-        {
-            setPixelColor(address, 0x0003D000); // GREEN
-        }
-        else if (address % 4 == 2)
-        {
-            setPixelColor(address, 0x000200FF); // BLUE
-        }
-        else
-        {
-            setPixelColor(address, 0x00FF0085); // PURPLE
-        }
+        case 2: // Chase
+            return renderChase(pixelIndex, effectTime);
+
+        default: // Solid, Multi-Color Solid
+            return getPaletteColor(pixelIndex);
     }
+}
 
-    return true;
-}
\ No newline at end of file
+/*
+** ============================================================================
+** Returns the length (ms) after which the currently selected effect repeats
+** ============================================================================
+*/
+uint32_t LightStrand::getEffectPeriod() const
+{
+    switch (mSelectedEffect)
+    {
+        case 2: // Chase
+            return getChasePeriod();
+
+        default: // Solid, Multi-Color Solid
+            return getStaticPeriod();
+    }
+}
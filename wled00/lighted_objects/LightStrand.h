@@ -24,14 +24,19 @@ class LightStrand : public BaseLightedObject
         /// of object
         virtual std::list<const char*> getSupportedEffects() const;
 
+        /// Length (ms) after which the current effect repeats itself
+        virtual uint32_t getEffectPeriod() const;
+
     // BaseLightedObject overrides
     protected:        
         virtual void deserializeSpecializedData(const JsonObject& stateObject) {}
         virtual void serializeSepecializedData(JsonObject& currentState) const;
         virtual void onParametersUpdated();
 
-        // Handles the specialized effect logic for light strands
-        virtual bool runSpecializedEffect();
+        // Renders the effects for light strands
+        virtual uint32_t renderPixel(uint16_t pixelIndex, uint32_t effectTime) const;
+        virtual uint32_t getDefaultColor(uint16_t position) const;
+        virtual uint16_t getDefaultColorCount() const { return 4; }
 
     private:
         static std::initializer_list<const char*> SUPPORTED_EFFECTS;    
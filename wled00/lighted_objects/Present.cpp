@@ -37,15 +37,48 @@ std::list<const char*> Present::getSupportedEffects() const
 
 /*
 ** ============================================================================
-** Run the currently selected effect
+** Presents default to red
 ** ============================================================================
 */
-bool Present::runSpecializedEffect()
+uint32_t Present::getDefaultColor(uint16_t position) const
 {
-    for (int address = mStartingAddress; address < mStartingAddress + mNumberOfLEDs; ++address)
+    return 0x00FF0000;
+}
+
+/*
+** ============================================================================
+** Returns the color of a pixel for the currently selected effect.  Unwrap
+** lights the present one LED at a time at the effect speed, then starts over.
+** ============================================================================
+*/
+uint32_t Present::renderPixel(uint16_t pixelIndex, uint32_t effectTime) const
+{
+    switch (mSelectedEffect)
     {
-        setPixelColor(address, 0x00FF0000);
+        case 1: // Unwrap
+        {
+            uint32_t numUnwrapped = getEffectShift(effectTime) % (mNumberOfLEDs + 1);
+            return (pixelIndex < numUnwrapped) ? getPaletteColor(pixelIndex) : 0;
+        }
+
+        default: // Solid
+            return getPaletteColor(pixelIndex);
     }
+}
 
-    return true;
+/*
+** ============================================================================
+** Returns the length (ms) after which the currently selected effect repeats
+** ============================================================================
+*/
+uint32_t Present::getEffectPeriod() const
+{
+    switch (mSelectedEffect)
+    {
+        case 1: // Unwrap
+            return ((uint32_t)(mNumberOfLEDs + 1) * 1000) / (mEffectSpeed > 0 ? mEffectSpeed : 1);
+
+        default: // Solid
+            return getStaticPeriod();
+    }
 }
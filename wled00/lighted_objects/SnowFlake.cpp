@@ -66,17 +66,32 @@ void SnowFlake::onParametersUpdated()
 
 /*
 ** ============================================================================
-** Run the currently selected effect
+** Snow flakes default to blue
 ** ============================================================================
 */
-bool SnowFlake::runSpecializedEffect()
+uint32_t SnowFlake::getDefaultColor(uint16_t position) const
 {
-    for (int address = mStartingAddress; address < mStartingAddress + mNumberOfLEDs; ++address)
+    return 0x000000FF;
+}
+
+/*
+** ============================================================================
+** Returns the color of a pixel for the currently selected effect
+** ============================================================================
+*/
+uint32_t SnowFlake::renderPixel(uint16_t pixelIndex, uint32_t effectTime) const
+{
+    switch (mSelectedEffect)
     {
-        setPixelColor(address, 0x000000FF);
-    }
+        case 1: // Chase
+            return renderChase(pixelIndex, effectTime);
+
+        case 2: // Twinkle
+            return renderTwinkle(pixelIndex, effectTime);
 
-    return true;
+        default: // Solid
+            return getPaletteColor(pixelIndex);
+    }
 }
 
 /*
@@ -90,4 +105,24 @@ void SnowFlake::updateTotalNumberOfLeds()
 {
     int totalLedsPerArm = mNumericValues[ARM_LEN_KEY] + mNumericValues[LG_CHEVRON_LEN_KEY] + mNumericValues[SM_CHEVRON_LEN_KEY];
     mNumberOfLEDs = totalLedsPerArm * mNumericValues[NUM_ARM_KEY];
-}
\ No newline at end of file
+}
+
+/*
+** ============================================================================
+** Returns the length (ms) after which the currently selected effect repeats
+** ============================================================================
+*/
+uint32_t SnowFlake::getEffectPeriod() const
+{
+    switch (mSelectedEffect)
+    {
+        case 1: // Chase
+            return getChasePeriod();
+
+        case 2: // Twinkle
+            return getTwinklePeriod();
+
+        default: // Solid
+            return getStaticPeriod();
+    }
+}
@@ -24,14 +24,18 @@ class SnowFlake : public BaseLightedObject
         /// of object
         virtual std::list<const char*> getSupportedEffects() const;
 
+        /// Length (ms) after which the current effect repeats itself
+        virtual uint32_t getEffectPeriod() const;
+
     // BaseLightedObject overrides
     protected:
         virtual void deserializeSpecializedData(const JsonObject& stateObject) {}
         virtual void serializeSepecializedData(JsonObject& currentState) const;        
         virtual void onParametersUpdated();
 
-        // Handles the specialized effect logic for snowflakes
-        virtual bool runSpecializedEffect();        
+        // Renders the effects for snowflakes
+        virtual uint32_t renderPixel(uint16_t pixelIndex, uint32_t effectTime) const;
+        virtual uint32_t getDefaultColor(uint16_t position) const;
 
     private:
         static std::initializer_list<const char*> SUPPORTED_EFFECTS;
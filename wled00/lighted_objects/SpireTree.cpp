@@ -37,15 +37,53 @@ std::list<const char*> SpireTree::getSupportedEffects() const
 
 /*
 ** ============================================================================
-** Run the currently selected effect
+** Spire trees default to green
 ** ============================================================================
 */
-bool SpireTree::runSpecializedEffect()
+uint32_t SpireTree::getDefaultColor(uint16_t position) const
 {
-    for (int address = mStartingAddress; address < mStartingAddress + mNumberOfLEDs; ++address)
+    return 0x0000FF00;
+}
+
+/*
+** ============================================================================
+** Returns the color of a pixel for the currently selected effect.  Decorate
+** twinkles ornaments in the color set colors over the green tree.
+** ============================================================================
+*/
+uint32_t SpireTree::renderPixel(uint16_t pixelIndex, uint32_t effectTime) const
+{
+    switch (mSelectedEffect)
     {
-        setPixelColor(address, 0x0000FF00);
+        case 2: // Decorate
+        {
+            if (nullptr == mColorSet)
+            {
+                return getDefaultColor(pixelIndex);
+            }
+
+            uint32_t ornamentColor = renderTwinkle(pixelIndex, effectTime);
+            return (0 != ornamentColor) ? ornamentColor : getDefaultColor(pixelIndex);
+        }
+
+        default: // Solid, Multi-Color Solid
+            return getPaletteColor(pixelIndex);
     }
+}
 
-    return true;
+/*
+** ============================================================================
+** Returns the length (ms) after which the currently selected effect repeats
+** ============================================================================
+*/
+uint32_t SpireTree::getEffectPeriod() const
+{
+    switch (mSelectedEffect)
+    {
+        case 2: // Decorate
+            return (nullptr != mColorSet) ? getTwinklePeriod() : getStaticPeriod();
+
+        default: // Solid, Multi-Color Solid
+            return getStaticPeriod();
+    }
 }
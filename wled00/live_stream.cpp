@@ -0,0 +1,553 @@
+#include "wled.h"
+
+#ifdef WLED_ENABLE_WEBSOCKETS
+
+#ifdef ARDUINO_ARCH_ESP32
+  // start() and stop() come from the async TCP task, the stream runs in the loop task
+  static portMUX_TYPE sStreamMux = portMUX_INITIALIZER_UNLOCKED;
+  #define STREAM_LOCK()   portENTER_CRITICAL(&sStreamMux)
+  #define STREAM_UNLOCK() portEXIT_CRITICAL(&sStreamMux)
+#else
+  // Everything runs in the same context on the ESP8266
+  #define STREAM_LOCK()
+  #define STREAM_UNLOCK()
+#endif
+
+namespace
+{
+    const char* CLIENT_ELEMENT = "client";
+    const char* LED_COUNT_ELEMENT = "leds";
+    const char* INTERVAL_ELEMENT = "interval_ms";
+    const char* FRAMES_ELEMENT = "frames";
+    const char* KEY_FRAMES_ELEMENT = "key_frames";
+    const char* DROPPED_ELEMENT = "dropped";
+    const char* LOST_ELEMENT = "lost_msgs";
+    const char* MESSAGES_ELEMENT = "msgs";
+    const char* BYTES_ELEMENT = "bytes";
+    const char* AVERAGE_ENCODE_ELEMENT = "encode_avg_us";
+    const char* MAX_ENCODE_ELEMENT = "encode_max_us";
+
+    const uint8_t MESSAGE_MAGIC = 'L';
+    const uint8_t MAX_RUN = 255;
+
+    void writeUint16(uint8_t* destination, uint16_t value)
+    {
+        destination[0] = value & 0xFF;
+        destination[1] = value >> 8;
+    }
+}
+
+/*
+** ============================================================================
+** Returns the one live LED stream
+** ============================================================================
+*/
+LiveLedStream& LiveLedStream::get()
+{
+    static LiveLedStream sLiveLedStream;
+    return sLiveLedStream;
+}
+
+/*
+** ============================================================================
+** Constructor
+** ============================================================================
+*/
+LiveLedStream::LiveLedStream()
+    : mClientId( 0 )
+    , mRequestedClientId( 0 )
+    , mRestartRequested( false )
+    , mPreviousFrame( nullptr )
+    , mMessage( nullptr )
+    , mNumLeds( 0 )
+    , mFrameInProgress( false )
+    , mKeyFrame( true )
+    , mKeyFrameRequested( false )
+    , mKeyFrameTimestamp( 0 )
+    , mFrameNumber( 0 )
+    , mNextLed( 0 )
+    , mFrameStartTimestamp( 0 )
+    , mFrameInterval( MIN_FRAME_INTERVAL_MS )
+    , mNumFrames( 0 )
+    , mNumKeyFrames( 0 )
+    , mNumDroppedFrames( 0 )
+    , mNumLostMessages( 0 )
+    , mNumMessages( 0 )
+    , mNumBytes( 0 )
+    , mTotalEncodeMicros( 0 )
+    , mMaxEncodeMicros( 0 )
+{
+}
+
+/*
+** ============================================================================
+** Asks for the LEDs to be streamed to the given client, in place of any
+** client that was streaming before.  Starting again sends a new key frame.
+** The stream starts in the loop, a client is sent an error if there is not
+** enough memory for it.
+** ============================================================================
+*/
+void LiveLedStream::start(uint32_t clientId)
+{
+    STREAM_LOCK();
+    mRequestedClientId = clientId;
+    mRestartRequested = true;
+    STREAM_UNLOCK();
+}
+
+/*
+** ============================================================================
+** Asks for the stream to stop if it goes (or was about to go) to the given
+** client, the loop then frees its buffers
+** ============================================================================
+*/
+void LiveLedStream::stop(uint32_t clientId)
+{
+    STREAM_LOCK();
+    if (clientId == mRequestedClientId)
+    {
+        mRequestedClientId = 0;
+        mRestartRequested = false;
+    }
+    STREAM_UNLOCK();
+}
+
+/*
+** ============================================================================
+** Called every loop.  Applies a start or stop request, then starts a frame
+** when one is due and sends the next message of the frame in progress if the
+** client's queue has room for it.
+** ============================================================================
+*/
+void LiveLedStream::handle()
+{
+    STREAM_LOCK();
+    uint32_t requestedClientId = mRequestedClientId;
+    bool restart = mRestartRequested;
+    mRestartRequested = false;
+    STREAM_UNLOCK();
+
+    if (restart || requestedClientId != mClientId)
+    {
+        applyRequest(requestedClientId, restart);
+    }
+
+    if (0 == mClientId)
+    {
+        return;
+    }
+
+    AsyncWebSocketClient* client = ws.client(mClientId);
+    if (nullptr == client || client->status() != WS_CONNECTED)
+    {
+        endStream();
+        return;
+    }
+
+    uint32_t now = millis();
+    if (!mFrameInProgress)
+    {
+        if (now - mFrameStartTimestamp < mFrameInterval)
+        {
+            return;
+        }
+
+        if (client->queueLength() > 0)
+        {
+            // The client has not taken the last frame yet, slow down
+            ++mNumDroppedFrames;
+            mFrameStartTimestamp = now;
+            mFrameInterval = (mFrameInterval * 2 < MAX_FRAME_INTERVAL_MS) ? mFrameInterval * 2 : MAX_FRAME_INTERVAL_MS;
+            return;
+        }
+
+        startFrame(now);
+        if (!mFrameInProgress)
+        {
+            return;
+        }
+    }
+
+    if (client->queueLength() >= MAX_QUEUED_MESSAGES)
+    {
+        return;
+    }
+
+    sendNextMessage(client);
+
+    if (mNextLed >= mNumLeds)
+    {
+        mFrameInProgress = false;
+        ++mNumFrames;
+
+        // The frame went out in time, speed back up towards the minimum interval
+        if (millis() - mFrameStartTimestamp < mFrameInterval)
+        {
+            mFrameInterval -= mFrameInterval / 8;
+            if (mFrameInterval < MIN_FRAME_INTERVAL_MS)
+            {
+                mFrameInterval = MIN_FRAME_INTERVAL_MS;
+            }
+        }
+    }
+}
+
+/*
+** ============================================================================
+** Starts (or restarts) the stream to the requested client or stops it
+**
+**  param   clientId - client to stream to, 0 to stop
+**  param   restart - true if the client asked for the stream again
+** ============================================================================
+*/
+void LiveLedStream::applyRequest(uint32_t clientId, bool restart)
+{
+    if (0 == clientId)
+    {
+        endStream();
+        return;
+    }
+
+    if (!allocateBuffers(lightDisplay.getNumberOfLEDs()))
+    {
+        // Not tried again until the client asks again
+        STREAM_LOCK();
+        if (mRequestedClientId == clientId)
+        {
+            mRequestedClientId = 0;
+        }
+        STREAM_UNLOCK();
+
+        endStream();
+        AsyncWebSocketClient* client = ws.client(clientId);
+        if (nullptr != client && client->status() == WS_CONNECTED)
+        {
+            client->text(F("{\"error\":\"no memory\"}"));
+        }
+        return;
+    }
+
+    mClientId = clientId;
+    mFrameInProgress = false;
+    mKeyFrame = true;
+    mFrameInterval = MIN_FRAME_INTERVAL_MS;
+    mFrameStartTimestamp = millis() - MIN_FRAME_INTERVAL_MS;
+}
+
+/*
+** ============================================================================
+** Stops the stream and frees its buffers, along with the request for it so it
+** is not started again
+** ============================================================================
+*/
+void LiveLedStream::endStream()
+{
+    STREAM_LOCK();
+    if (mRequestedClientId == mClientId)
+    {
+        mRequestedClientId = 0;
+    }
+    STREAM_UNLOCK();
+
+    mClientId = 0;
+    mFrameInProgress = false;
+    freeBuffers();
+}
+
+/*
+** ============================================================================
+** Writes the stream statistics
+** ============================================================================
+*/
+void LiveLedStream::serializeToJson(JsonObject root) const
+{
+    root[CLIENT_ELEMENT] = mClientId;
+    root[LED_COUNT_ELEMENT] = mNumLeds;
+    root[INTERVAL_ELEMENT] = mFrameInterval;
+    root[FRAMES_ELEMENT] = mNumFrames;
+    root[KEY_FRAMES_ELEMENT] = mNumKeyFrames;
+    root[DROPPED_ELEMENT] = mNumDroppedFrames;
+    root[LOST_ELEMENT] = mNumLostMessages;
+    root[MESSAGES_ELEMENT] = mNumMessages;
+    root[BYTES_ELEMENT] = mNumBytes;
+    root[AVERAGE_ENCODE_ELEMENT] = (mNumMessages > 0) ? mTotalEncodeMicros / mNumMessages : 0;
+    root[MAX_ENCODE_ELEMENT] = mMaxEncodeMicros;
+}
+
+/*
+** ============================================================================
+** Makes sure there is a previous frame buffer for the given number of LEDs and
+** a message buffer
+**
+**  returns false if they could not be allocated
+** ============================================================================
+*/
+bool LiveLedStream::allocateBuffers(uint16_t numLeds)
+{
+    if (nullptr != mPreviousFrame && numLeds == mNumLeds)
+    {
+        return true;
+    }
+
+    freeBuffers();
+    if (0 == numLeds)
+    {
+        return false;
+    }
+
+    mPreviousFrame = (uint8_t*)malloc(numLeds * 3);
+    mMessage = (uint8_t*)malloc(MAX_MESSAGE_BYTES);
+    if (nullptr == mPreviousFrame || nullptr == mMessage)
+    {
+        DEBUG_PRINTLN(F("Live stream: out of memory"));
+        freeBuffers();
+        return false;
+    }
+
+    mNumLeds = numLeds;
+    mKeyFrame = true;
+    return true;
+}
+
+/*
+** ============================================================================
+** Frees the previous frame and message buffers
+** ============================================================================
+*/
+void LiveLedStream::freeBuffers()
+{
+    free(mPreviousFrame);
+    free(mMessage);
+    mPreviousFrame = nullptr;
+    mMessage = nullptr;
+    mNumLeds = 0;
+}
+
+/*
+** ============================================================================
+** Starts sending the next frame from the first LED
+** ============================================================================
+*/
+void LiveLedStream::startFrame(uint32_t currentMillis)
+{
+    // A different number of LEDs needs new buffers and a key frame
+    if (lightDisplay.getNumberOfLEDs() != mNumLeds && !allocateBuffers(lightDisplay.getNumberOfLEDs()))
+    {
+        endStream();
+        return;
+    }
+
+    mFrameInProgress = true;
+    mFrameStartTimestamp = currentMillis;
+    mNextLed = 0;
+    ++mFrameNumber;
+
+    // Corrects whatever the client may have missed
+    if (mKeyFrameRequested || currentMillis - mKeyFrameTimestamp >= KEY_FRAME_INTERVAL_MS)
+    {
+        mKeyFrame = true;
+    }
+
+    if (mKeyFrame)
+    {
+        mKeyFrameRequested = false;
+        mKeyFrameTimestamp = currentMillis;
+        ++mNumKeyFrames;
+    }
+}
+
+/*
+** ============================================================================
+** Encodes the LEDs from mNextLed into one message and sends it.  A delta
+** message without any changes is skipped.
+** ============================================================================
+*/
+void LiveLedStream::sendNextMessage(AsyncWebSocketClient* client)
+{
+    uint32_t startMicros = micros();
+    uint16_t firstLed = mNextLed;
+    uint16_t numEncoded = 0;
+    uint16_t payloadBytes = 0;
+    bool changed = true;
+    uint8_t encoding;
+
+    if (mKeyFrame)
+    {
+        payloadBytes = encodeKeyFrame(mMessage + HEADER_BYTES, MAX_MESSAGE_BYTES - HEADER_BYTES, numEncoded);
+        encoding = LIVE_ENCODING_RLE;
+
+        // Noisy content does not compress, the colors are in the previous frame now
+        if (payloadBytes > numEncoded * 3)
+        {
+            payloadBytes = numEncoded * 3;
+            memcpy(mMessage + HEADER_BYTES, mPreviousFrame + firstLed * 3, payloadBytes);
+            encoding = LIVE_ENCODING_RAW;
+        }
+    }
+    else
+    {
+        payloadBytes = encodeDelta(mMessage + HEADER_BYTES, MAX_MESSAGE_BYTES - HEADER_BYTES, numEncoded, changed);
+        encoding = LIVE_ENCODING_DELTA;
+    }
+
+    mNextLed += numEncoded;
+    if (mNextLed >= mNumLeds)
+    {
+        mKeyFrame = false;
+    }
+
+    uint32_t encodeMicros = micros() - startMicros;
+    mTotalEncodeMicros += encodeMicros;
+    if (encodeMicros > mMaxEncodeMicros)
+    {
+        mMaxEncodeMicros = encodeMicros;
+    }
+
+    if (!changed)
+    {
+        return;
+    }
+
+    mMessage[0] = MESSAGE_MAGIC;
+    mMessage[1] = encoding;
+    writeUint16(mMessage + 2, mFrameNumber);
+    writeUint16(mMessage + 4, mNumLeds);
+    writeUint16(mMessage + 6, firstLed);
+    writeUint16(mMessage + 8, numEncoded);
+
+    size_t messageBytes = HEADER_BYTES + payloadBytes;
+    if (client->queueIsFull())
+    {
+        // The message would be thrown away, but its LEDs are already in the previous frame
+        ++mNumLostMessages;
+        mKeyFrameRequested = true;
+        return;
+    }
+    client->binary(mMessage, messageBytes);
+
+    ++mNumMessages;
+    mNumBytes += messageBytes;
+}
+
+/*
+** ============================================================================
+** Run length encodes the LEDs from mNextLed until the payload is full and
+** stores them as the previous frame
+**
+**  returns the number of payload bytes, numEncoded is set to the LEDs covered
+** ============================================================================
+*/
+uint16_t LiveLedStream::encodeKeyFrame(uint8_t* payload, uint16_t maxBytes, uint16_t& numEncoded)
+{
+    uint16_t numBytes = 0;
+    uint8_t* run = nullptr;
+
+    uint16_t address = mNextLed;
+    for (; address < mNumLeds; ++address)
+    {
+        uint8_t* rgb = mPreviousFrame + address * 3;
+        getPixel(address, rgb);
+
+        if (nullptr != run && run[0] < MAX_RUN && 0 == memcmp(run + 1, rgb, 3))
+        {
+            ++run[0];
+            continue;
+        }
+
+        if (numBytes + 4 > maxBytes)
+        {
+            break;
+        }
+
+        run = payload + numBytes;
+        run[0] = 1;
+        memcpy(run + 1, rgb, 3);
+        numBytes += 4;
+    }
+
+    numEncoded = address - mNextLed;
+    return numBytes;
+}
+
+/*
+** ============================================================================
+** Encodes the LEDs from mNextLed that changed since the previous frame until
+** the payload is full, as pairs of unchanged and changed counts followed by
+** the colors of the changed LEDs
+**
+**  returns the number of payload bytes, numEncoded is set to the LEDs covered
+**  and changed to whether any of them changed
+** ============================================================================
+*/
+uint16_t LiveLedStream::encodeDelta(uint8_t* payload, uint16_t maxBytes, uint16_t& numEncoded, bool& changed)
+{
+    uint16_t numBytes = 0;
+    uint8_t* pair = nullptr;
+    changed = false;
+
+    uint16_t address = mNextLed;
+    for (; address < mNumLeds; ++address)
+    {
+        uint8_t rgb[3];
+        getPixel(address, rgb);
+        uint8_t* previous = mPreviousFrame + address * 3;
+
+        if (0 == memcmp(previous, rgb, 3))
+        {
+            // Unchanged LEDs open a new pair once the current one has changed LEDs
+            if (nullptr == pair || pair[1] > 0 || pair[0] == MAX_RUN)
+            {
+                if (numBytes + 2 > maxBytes)
+                {
+                    break;
+                }
+                pair = payload + numBytes;
+                pair[0] = 0;
+                pair[1] = 0;
+                numBytes += 2;
+            }
+            ++pair[0];
+            continue;
+        }
+
+        if (nullptr == pair || pair[1] == MAX_RUN)
+        {
+            if (numBytes + 5 > maxBytes)
+            {
+                break;
+            }
+            pair = payload + numBytes;
+            pair[0] = 0;
+            pair[1] = 0;
+            numBytes += 2;
+        }
+        else if (numBytes + 3 > maxBytes)
+        {
+            break;
+        }
+
+        memcpy(payload + numBytes, rgb, 3);
+        memcpy(previous, rgb, 3);
+        numBytes += 3;
+        ++pair[1];
+        changed = true;
+    }
+
+    numEncoded = address - mNextLed;
+    return numBytes;
+}
+
+/*
+** ============================================================================
+** Reads the color of one LED as r, g, b
+** ============================================================================
+*/
+void LiveLedStream::getPixel(uint16_t address, uint8_t* rgb) const
+{
+    uint32_t color = lightDisplay.getPixelColor(address);
+    rgb[0] = (color >> 16) & 0xFF;
+    rgb[1] = (color >> 8) & 0xFF;
+    rgb[2] = color & 0xFF;
+}
+
+#endif
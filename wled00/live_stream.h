@@ -0,0 +1,121 @@
+#ifndef LIVE_STREAM_H
+#define LIVE_STREAM_H
+
+#include "Arduino.h"
+
+/*
+** How the LEDs of one live stream message are encoded
+*/
+enum LiveStreamEncoding : uint8_t
+{
+    LIVE_ENCODING_RAW = 0,      // r,g,b for every LED
+    LIVE_ENCODING_RLE,          // runs of [count, r, g, b]
+    LIVE_ENCODING_DELTA         // [unchanged count, changed count, r,g,b of each changed LED]
+};
+
+/*
+**-----------------------------------------------------------------------------
+** Streams every LED of the light display to one WebSocket client as binary
+** messages, for watching a large display live without the 180 LED limit and
+** the hex strings of the JSON live view.  A client starts the stream with
+** {"lvb":true} and stops it with {"lvb":false}.
+**
+** start() and stop() are called from the WebSocket callbacks, which run in the
+** async TCP task on the ESP32, so they only record the request.  The loop
+** applies it in handle(), it is the only one that touches the buffers.
+**
+** A frame is sent as one or more messages of at most MAX_MESSAGE_BYTES, each
+** covering a range of LEDs and starting with a 10 byte little endian header,
+**
+**   'L', encoding, frame number (2), total LEDs (2), first LED (2), LED count (2)
+**
+** The first frame, and any frame after the number of LEDs changed, is a key
+** frame: run length encoded, or raw where that is smaller.  Every other frame
+** only carries the LEDs that changed since the previous frame, messages with
+** no changes are not sent at all.
+**
+** The previous frame is what was encoded, the WebSocket can not tell whether
+** a message was delivered (the queue is shared with the state updates and a
+** message buffer may fail to allocate).  So a key frame is also sent every
+** KEY_FRAME_INTERVAL_MS, and straight after a message had to be dropped, so a
+** lost message only leaves the client's picture wrong for a while.
+**
+** Only one message is encoded per loop so a 3000 LED key frame is spread over
+** several loops instead of holding up the render.  The frame interval starts
+** at MIN_FRAME_INTERVAL_MS; whenever a frame is due while the client still has
+** messages queued the frame is dropped and the interval doubled, and every
+** frame that goes out on time brings it back down.
+**-----------------------------------------------------------------------------
+*/
+class LiveLedStream
+{
+    public:
+        static const uint16_t MAX_MESSAGE_BYTES = 1460;
+        static const uint8_t HEADER_BYTES = 10;
+        static const uint16_t MIN_FRAME_INTERVAL_MS = 40;
+        static const uint16_t MAX_FRAME_INTERVAL_MS = 1000;
+        static const uint8_t MAX_QUEUED_MESSAGES = 2;
+        static const uint16_t KEY_FRAME_INTERVAL_MS = 5000;
+
+        static LiveLedStream& get();
+
+        void start(uint32_t clientId);
+        void stop(uint32_t clientId);
+        bool isStreaming() const { return 0 != mClientId; }
+
+        void handle();
+
+        void serializeToJson(JsonObject root) const;
+
+    private:
+        LiveLedStream();
+        LiveLedStream(const LiveLedStream&);
+        LiveLedStream& operator=(const LiveLedStream&);
+
+        void applyRequest(uint32_t clientId, bool restart);
+        void endStream();
+
+        bool allocateBuffers(uint16_t numLeds);
+        void freeBuffers();
+
+        void startFrame(uint32_t currentMillis);
+        void sendNextMessage(AsyncWebSocketClient* client);
+
+        uint16_t encodeKeyFrame(uint8_t* payload, uint16_t maxBytes, uint16_t& numEncoded);
+        uint16_t encodeDelta(uint8_t* payload, uint16_t maxBytes, uint16_t& numEncoded, bool& changed);
+        void getPixel(uint16_t address, uint8_t* rgb) const;
+
+    private:
+        uint32_t    mClientId;
+
+        // Set by start() and stop(), applied by the loop
+        uint32_t    mRequestedClientId;
+        bool        mRestartRequested;
+
+        // The colors the client was sent last and the message being encoded
+        uint8_t*    mPreviousFrame;
+        uint8_t*    mMessage;
+        uint16_t    mNumLeds;
+
+        // The frame being sent
+        bool        mFrameInProgress;
+        bool        mKeyFrame;
+        bool        mKeyFrameRequested;     // the next frame is a key frame
+        uint32_t    mKeyFrameTimestamp;
+        uint16_t    mFrameNumber;
+        uint16_t    mNextLed;
+        uint32_t    mFrameStartTimestamp;
+        uint16_t    mFrameInterval;
+
+        // Statistics
+        uint32_t    mNumFrames;
+        uint32_t    mNumKeyFrames;
+        uint32_t    mNumDroppedFrames;
+        uint32_t    mNumLostMessages;
+        uint32_t    mNumMessages;
+        uint32_t    mNumBytes;
+        uint32_t    mTotalEncodeMicros;
+        uint32_t    mMaxEncodeMicros;
+};
+
+#endif
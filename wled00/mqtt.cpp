@@ -86,9 +86,10 @@ void onMqttMessage(char* topic, char* payload, AsyncMqttClientMessageProperties
   } else if (strcmp(topic, "/api") == 0)
   {
     if (payload[0] == '{') { //JSON API
-      DynamicJsonDocument doc(JSON_BUFFER_SIZE);
-      deserializeJson(doc, payload);
-      deserializeState(doc.as<JsonObject>());
+      JsonDocumentLease doc;
+      if (!doc.isValid()) return;
+      deserializeJson(*doc, payload);
+      deserializeState(doc->as<JsonObject>());
     } else { //HTTP API
       String apireq = "win&";
       apireq += (char*)payload;
@@ -132,6 +133,31 @@ void publishMqtt()
 }
 
 
+#ifdef WLED_ENABLE_MQTT_TELEMETRY
+#define MQTT_TELEMETRY_INTERVAL 60000 // publish heap telemetry every minute
+
+void publishMqttTelemetry()
+{
+  static unsigned long lastTelemetryPublish = 0;
+  if (!WLED_MQTT_CONNECTED || millis() - lastTelemetryPublish < MQTT_TELEMETRY_INTERVAL) return;
+  lastTelemetryPublish = millis();
+
+  StaticJsonDocument<512> doc;
+  HeapTelemetry::get().serializeToJson(doc.to<JsonObject>());
+
+  char payload[512];
+  serializeJson(doc, payload, sizeof(payload));
+
+  char subuf[48];
+  strcpy(subuf, mqttDeviceTopic);
+  strcat(subuf, "/telemetry");
+  mqtt->publish(subuf, 0, false, payload);
+}
+#else
+void publishMqttTelemetry(){}
+#endif
+
+
 //HA autodiscovery was removed in favor of the native integration in HA v0.102.0
 
 bool initMqtt()
@@ -168,4 +194,5 @@ bool initMqtt()
 #else
 bool initMqtt(){return false;}
 void publishMqtt(){}
+void publishMqttTelemetry(){}
 #endif
@@ -20,9 +20,13 @@ int8_t playlistIndex = -1;
 
 uint16_t playlistEntryDur = 0;
 
+int8_t playlistPrefetchIndex = -1; //entry after which the next preset was prefetched into PresetCache
+
+#define PLAYLIST_PREFETCH_DELAY 500 //ms after a step, so the prefetch does not stall its transition
+
 void loadPlaylist(JsonObject playlistObj) {
   delete playlistEntries;
-  playlistIndex = -1; playlistEntryDur = 0;
+  playlistIndex = -1; playlistEntryDur = 0; playlistPrefetchIndex = -1;
   JsonArray presets = playlistObj["ps"];
   playlistLen = presets.size();
   if (playlistLen == 0) return;
@@ -102,5 +106,12 @@ void handlePlaylist()
     applyPreset(entries[playlistIndex].preset);
     playlistEntryDur = entries[playlistIndex].dur;
     if (playlistEntryDur == 0) playlistEntryDur = 10;
+  } else if (playlistIndex >= 0 && playlistPrefetchIndex != playlistIndex && millis() - presetCycledTime > PLAYLIST_PREFETCH_DELAY) {
+    //read the next step's preset now, so the step applies it from RAM
+    playlistPrefetchIndex = playlistIndex;
+    PlaylistEntry* entries = reinterpret_cast<PlaylistEntry*>(playlistEntries);
+    if (playlistIndex + 1 < playlistLen) PresetCache::get().prefetch(entries[playlistIndex + 1].preset);
+    else if (playlistRepeat != 1) PresetCache::get().prefetch(entries[0].preset);
+    else if (playlistEndPreset) PresetCache::get().prefetch(playlistEndPreset);
   }
 }
\ No newline at end of file
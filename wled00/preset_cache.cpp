@@ -0,0 +1,439 @@
+#include "wled.h"
+
+namespace
+{
+    const char* PRESETS_FILE_NAME = "/presets.json";
+
+    const char* ENTRIES_ELEMENT = "entries";
+    const char* BYTES_ELEMENT = "bytes";
+    const char* MAX_BYTES_ELEMENT = "max_bytes";
+    const char* HITS_ELEMENT = "hits";
+    const char* MISSES_ELEMENT = "misses";
+    const char* HIT_RATE_ELEMENT = "hit_rate";
+    const char* PREFETCHES_ELEMENT = "prefetches";
+    const char* EVICTIONS_ELEMENT = "evictions";
+    const char* INVALIDATIONS_ELEMENT = "invalidations";
+    const char* CACHED_APPLY_ELEMENT = "cached_apply_us";
+    const char* FILE_APPLY_ELEMENT = "file_apply_us";
+}
+
+/*
+** ============================================================================
+** Returns the one preset cache
+** ============================================================================
+*/
+PresetCache& PresetCache::get()
+{
+    static PresetCache sPresetCache;
+    return sPresetCache;
+}
+
+/*
+** ============================================================================
+** Constructor
+** ============================================================================
+*/
+PresetCache::PresetCache()
+    : mTotalBytes( 0 )
+    , mUseCounter( 0 )
+    , mIsInvalidated( false )
+    , mPrefetchId( 0 )
+    , mPrefetchOffset( 0 )
+    , mPrefetchDepth( 0 )
+    , mPrefetchInString( false )
+    , mPrefetchIsEscaped( false )
+    , mNumHits( 0 )
+    , mNumMisses( 0 )
+    , mNumPrefetches( 0 )
+    , mNumEvictions( 0 )
+    , mNumInvalidations( 0 )
+    , mNumCachedApplies( 0 )
+    , mCachedApplyMicros( 0 )
+    , mNumFileApplies( 0 )
+    , mFileApplyMicros( 0 )
+{
+}
+
+/*
+** ============================================================================
+** Reads a preset into the document, from the cache if it is there.  The
+** MessagePack is read in copy mode, the document does not point into the
+** cache, which applying the preset may change.
+**
+**  returns false if there is no such preset
+** ============================================================================
+*/
+bool PresetCache::read(uint8_t id, JsonDocument* document, bool& wasCached)
+{
+    applyInvalidation();
+
+    EntryList::iterator entry = find(id);
+    if (entry != mEntries.end())
+    {
+        DeserializationError error = deserializeMsgPack(*document, (const char*)entry->data.data(), entry->data.size());
+        if (!error)
+        {
+            entry->lastUse = ++mUseCounter;
+            ++mNumHits;
+            wasCached = true;
+            return true;
+        }
+        remove(id);
+    }
+
+    ++mNumMisses;
+    wasCached = false;
+    if (id == mPrefetchId)
+    {
+        // Read now, not worth finishing
+        cancelPrefetch();
+    }
+
+    if (!readObjectFromFileUsingId(PRESETS_FILE_NAME, id, document))
+    {
+        return false;
+    }
+
+    store(id, *document);
+    return true;
+}
+
+/*
+** ============================================================================
+** Starts reading a preset into the cache unless it is already there.  The
+** reading is done by handle(), a chunk per loop.
+** ============================================================================
+*/
+void PresetCache::prefetch(uint8_t id)
+{
+    applyInvalidation();
+    if (id == mPrefetchId || find(id) != mEntries.end())
+    {
+        return;
+    }
+
+    cancelPrefetch();
+    mPrefetchId = id;
+}
+
+/*
+** ============================================================================
+** Drops the presets if the file was replaced and reads the next chunk of the
+** preset being prefetched, called from the loop
+** ============================================================================
+*/
+void PresetCache::handle()
+{
+    applyInvalidation();
+    if (0 == mPrefetchId)
+    {
+        return;
+    }
+
+    if (!readPrefetchChunk())
+    {
+        cancelPrefetch();
+        return;
+    }
+
+    if (!mPrefetchJson.empty() && 0 == mPrefetchDepth)
+    {
+        finishPrefetch();
+    }
+}
+
+/*
+** ============================================================================
+** Drops a preset, it was written or deleted
+** ============================================================================
+*/
+void PresetCache::remove(uint8_t id)
+{
+    if (id == mPrefetchId)
+    {
+        cancelPrefetch();
+    }
+
+    EntryList::iterator entry = find(id);
+    if (entry != mEntries.end())
+    {
+        mTotalBytes -= entry->data.size();
+        mEntries.erase(entry);
+    }
+}
+
+/*
+** ============================================================================
+** Drops every preset
+** ============================================================================
+*/
+void PresetCache::clear()
+{
+    mEntries.clear();
+    mTotalBytes = 0;
+}
+
+/*
+** ============================================================================
+** Adds the time applyPreset took to the statistics
+** ============================================================================
+*/
+void PresetCache::recordApplyTime(bool wasCached, uint32_t micros)
+{
+    if (wasCached)
+    {
+        ++mNumCachedApplies;
+        mCachedApplyMicros += micros;
+    }
+    else
+    {
+        ++mNumFileApplies;
+        mFileApplyMicros += micros;
+    }
+}
+
+/*
+** ============================================================================
+** Writes the size of the cache, its hit rate and the average time applying a
+** preset took from the cache and from the file
+** ============================================================================
+*/
+void PresetCache::serializeToJson(JsonObject root) const
+{
+    root[ENTRIES_ELEMENT] = mEntries.size();
+    root[BYTES_ELEMENT] = mTotalBytes;
+    root[MAX_BYTES_ELEMENT] = getMaxBytes();
+    root[HITS_ELEMENT] = mNumHits;
+    root[MISSES_ELEMENT] = mNumMisses;
+    root[HIT_RATE_ELEMENT] = (mNumHits + mNumMisses) ? (100 * mNumHits) / (mNumHits + mNumMisses) : 0;
+    root[PREFETCHES_ELEMENT] = mNumPrefetches;
+    root[EVICTIONS_ELEMENT] = mNumEvictions;
+    root[INVALIDATIONS_ELEMENT] = mNumInvalidations;
+    root[CACHED_APPLY_ELEMENT] = mNumCachedApplies ? (uint32_t)(mCachedApplyMicros / mNumCachedApplies) : 0;
+    root[FILE_APPLY_ELEMENT] = mNumFileApplies ? (uint32_t)(mFileApplyMicros / mNumFileApplies) : 0;
+}
+
+/*
+** ============================================================================
+** Drops every preset, and the index, if invalidate() was called since the
+** last time
+** ============================================================================
+*/
+void PresetCache::applyInvalidation()
+{
+    if (!mIsInvalidated)
+    {
+        return;
+    }
+
+    mIsInvalidated = false;
+    cancelPrefetch();
+    PresetIndex::get().invalidate();
+    if (!mEntries.empty())
+    {
+        clear();
+        ++mNumInvalidations;
+    }
+}
+
+/*
+** ============================================================================
+** Reads the next chunk of the preset being prefetched.  The first call only
+** finds where its object starts.  The file is opened for every chunk, so a
+** preset written in between is read from the file it was written to.
+**
+**  returns false if there is no such preset or it can not be kept
+** ============================================================================
+*/
+bool PresetCache::readPrefetchChunk()
+{
+    if (doCloseFile)
+    {
+        closeFile();
+    }
+
+    File file = WLED_FS.open(PRESETS_FILE_NAME, "r");
+    if (!file)
+    {
+        return false;
+    }
+
+    if (0 == mPrefetchOffset)
+    {
+        bool isFound = PresetIndex::get().seek(file, mPrefetchId);
+        mPrefetchOffset = file.position();
+        file.close();
+        return isFound;
+    }
+
+    uint8_t buffer[PREFETCH_CHUNK_SIZE];
+    file.seek(mPrefetchOffset + mPrefetchJson.size(), SeekSet);
+    uint16_t length = file.read(buffer, PREFETCH_CHUNK_SIZE);
+    file.close();
+
+    // The MessagePack is never less than half of the JSON, a preset this long would not be kept
+    if (0 == length || mPrefetchJson.size() + length > 2 * getMaxBytes())
+    {
+        return false;
+    }
+
+    for (uint16_t i = 0; i < length; ++i)
+    {
+        char character = buffer[i];
+        mPrefetchJson.push_back(character);
+        if (mPrefetchInString)
+        {
+            if (mPrefetchIsEscaped)
+            {
+                mPrefetchIsEscaped = false;
+            }
+            else if (character == '\\')
+            {
+                mPrefetchIsEscaped = true;
+            }
+            else if (character == '"')
+            {
+                mPrefetchInString = false;
+            }
+        }
+        else if (character == '"')
+        {
+            mPrefetchInString = true;
+        }
+        else if (character == '{')
+        {
+            ++mPrefetchDepth;
+        }
+        else if (character == '}' && 0 == --mPrefetchDepth)
+        {
+            break;
+        }
+    }
+
+    return true;
+}
+
+/*
+** ============================================================================
+** Parses the prefetched JSON and keeps the preset
+** ============================================================================
+*/
+void PresetCache::finishPrefetch()
+{
+    // Not worth waiting for a document, the preset is then read when applied
+    // Read only, the strings are copied into the document
+    uint8_t id = mPrefetchId;
+    JsonDocumentLease document(0);
+    bool isParsed = document.isValid() && !deserializeJson(*document, (const char*)mPrefetchJson.data(), mPrefetchJson.size());
+    cancelPrefetch();
+
+    if (isParsed)
+    {
+        store(id, *document);
+        ++mNumPrefetches;
+    }
+}
+
+/*
+** ============================================================================
+** Stops prefetching and frees what was read so far
+** ============================================================================
+*/
+void PresetCache::cancelPrefetch()
+{
+    mPrefetchId = 0;
+    mPrefetchOffset = 0;
+    std::vector<char>().swap(mPrefetchJson);
+    mPrefetchDepth = 0;
+    mPrefetchInString = false;
+    mPrefetchIsEscaped = false;
+}
+
+/*
+** ============================================================================
+** Returns the entry of the given preset
+** ============================================================================
+*/
+PresetCache::EntryList::iterator PresetCache::find(uint8_t id)
+{
+    for (EntryList::iterator entry = mEntries.begin(); entry != mEntries.end(); ++entry)
+    {
+        if (entry->id == id)
+        {
+            return entry;
+        }
+    }
+
+    return mEntries.end();
+}
+
+/*
+** ============================================================================
+** Keeps a preset as MessagePack, evicting the least recently used presets
+** until it fits.  A preset larger than the whole cache is not kept.
+** ============================================================================
+*/
+void PresetCache::store(uint8_t id, const JsonDocument& document)
+{
+    remove(id);
+
+    size_t length = measureMsgPack(document);
+    uint32_t maxBytes = getMaxBytes();
+    if (0 == length || length > maxBytes)
+    {
+        return;
+    }
+
+    while (!mEntries.empty() && (mEntries.size() >= MAX_ENTRIES || mTotalBytes + length > maxBytes))
+    {
+        evictOldest();
+    }
+
+    Entry entry;
+    entry.id = id;
+    entry.lastUse = ++mUseCounter;
+    entry.data.resize(length);
+    serializeMsgPack(document, entry.data.data(), length);
+
+    mTotalBytes += length;
+    mEntries.push_back(std::move(entry));
+}
+
+/*
+** ============================================================================
+** Returns how many bytes the cache may hold now, MAX_BYTES or less when the
+** heap is short
+** ============================================================================
+*/
+uint32_t PresetCache::getMaxBytes() const
+{
+    uint32_t freeHeap = ESP.getFreeHeap() + mTotalBytes;
+    if (freeHeap <= MIN_FREE_HEAP)
+    {
+        return 0;
+    }
+
+    uint32_t maxBytes = (freeHeap - MIN_FREE_HEAP) / 2;
+    return (maxBytes < MAX_BYTES) ? maxBytes : MAX_BYTES;
+}
+
+/*
+** ============================================================================
+** Drops the least recently used preset
+** ============================================================================
+*/
+void PresetCache::evictOldest()
+{
+    EntryList::iterator oldest = mEntries.begin();
+    for (EntryList::iterator entry = mEntries.begin(); entry != mEntries.end(); ++entry)
+    {
+        if (entry->lastUse < oldest->lastUse)
+        {
+            oldest = entry;
+        }
+    }
+
+    mTotalBytes -= oldest->data.size();
+    mEntries.erase(oldest);
+    ++mNumEvictions;
+}
@@ -0,0 +1,117 @@
+#ifndef PRESET_CACHE_H
+#define PRESET_CACHE_H
+
+#include "Arduino.h"
+
+#include <vector>
+
+/*
+**-----------------------------------------------------------------------------
+** Keeps recently applied presets in RAM so applying one again (a playlist
+** going round, a button toggling between two presets) does not open and read
+** /presets.json inside the loop.  Presets are kept as MessagePack, which is
+** smaller than their JSON and quicker to parse.
+**
+** The cache holds at most MAX_ENTRIES presets and MAX_BYTES of them, and never
+** more than half of the heap above MIN_FREE_HEAP, so it shrinks when memory
+** gets tight.  The least recently used preset is evicted first.  The cache
+** is told by whatever changes the file: writeObjectToFile drops the preset it
+** writes, and an upload through /edit drops every preset (the flag it sets
+** is applied by the loop, the upload runs in the web server's task).  The
+** compactor only moves the presets, which just stops a running prefetch.
+**
+** handlePlaylist prefetches the preset of the next playlist entry a while
+** after the current one was applied, so the step itself applies from RAM.
+** The prefetch reads PREFETCH_CHUNK_SIZE bytes of the preset's JSON per loop
+** and parses it once the whole object was read.
+**-----------------------------------------------------------------------------
+*/
+class PresetCache
+{
+    public:
+#ifdef ESP8266
+        static const uint8_t MAX_ENTRIES = 8;
+        static const uint16_t MAX_BYTES = 4096;
+        static const uint16_t MIN_FREE_HEAP = 12000;
+#else
+        static const uint8_t MAX_ENTRIES = 32;
+        static const uint16_t MAX_BYTES = 32768;
+        static const uint16_t MIN_FREE_HEAP = 32768;
+#endif
+        static const uint16_t PREFETCH_CHUNK_SIZE = 256;
+
+        static PresetCache& get();
+
+        // Reads a preset from the cache, or from the file and then keeps it
+        //  returns false if there is no such preset
+        bool read(uint8_t id, JsonDocument* document, bool& wasCached);
+
+        // Reads a preset into the cache ahead of time, if it is not there yet,
+        // a chunk per loop from handle()
+        void prefetch(uint8_t id);
+        void handle();
+
+        void remove(uint8_t id);
+        void clear();
+
+        // The file was replaced, drops every preset on the next loop.  Can be
+        // called from the web server's task.
+        void invalidate() { mIsInvalidated = true; }
+
+        // The presets were moved within the file
+        void onFileMoved() { cancelPrefetch(); }
+
+        // How long applyPreset took, for the statistics
+        void recordApplyTime(bool wasCached, uint32_t micros);
+
+        void serializeToJson(JsonObject root) const;
+
+    private:
+        PresetCache();
+        PresetCache(const PresetCache&);
+        PresetCache& operator=(const PresetCache&);
+
+        struct Entry
+        {
+            uint8_t                 id;
+            uint32_t                lastUse;
+            std::vector<uint8_t>    data;
+        };
+        typedef std::vector<Entry> EntryList;
+
+        void applyInvalidation();
+        bool readPrefetchChunk();
+        void finishPrefetch();
+        void cancelPrefetch();
+        EntryList::iterator find(uint8_t id);
+        void store(uint8_t id, const JsonDocument& document);
+        uint32_t getMaxBytes() const;
+        void evictOldest();
+
+    private:
+        EntryList   mEntries;
+        uint32_t    mTotalBytes;
+        uint32_t    mUseCounter;
+        volatile bool mIsInvalidated;
+
+        // The preset being prefetched, 0 if none
+        uint8_t     mPrefetchId;
+        uint32_t    mPrefetchOffset;    // of the object's '{', 0 until found
+        std::vector<char> mPrefetchJson;
+        uint16_t    mPrefetchDepth;
+        bool        mPrefetchInString;
+        bool        mPrefetchIsEscaped;
+
+        // Statistics
+        uint32_t    mNumHits;
+        uint32_t    mNumMisses;
+        uint32_t    mNumPrefetches;
+        uint32_t    mNumEvictions;
+        uint32_t    mNumInvalidations;
+        uint32_t    mNumCachedApplies;
+        uint64_t    mCachedApplyMicros;
+        uint32_t    mNumFileApplies;
+        uint64_t    mFileApplyMicros;
+};
+
+#endif
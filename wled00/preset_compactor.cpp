@@ -0,0 +1,287 @@
+#include "wled.h"
+
+namespace
+{
+    const char* PRESETS_FILE_NAME = "/presets.json";
+    const char* TEMP_FILE_NAME = "/presets.json.tmp";
+
+    const char* COMPACTING_ELEMENT = "compacting";
+    const char* COMPACTIONS_ELEMENT = "compactions";
+    const char* CANCELLED_ELEMENT = "cancelled";
+    const char* RECLAIMED_ELEMENT = "reclaimed";
+    const char* LAST_DURATION_ELEMENT = "last_ms";
+
+    bool isWhitespace(char character)
+    {
+        return character == ' ' || character == '\t' || character == '\r' || character == '\n';
+    }
+}
+
+/*
+** ============================================================================
+** Returns the one preset compactor
+** ============================================================================
+*/
+PresetCompactor& PresetCompactor::get()
+{
+    static PresetCompactor sPresetCompactor;
+    return sPresetCompactor;
+}
+
+/*
+** ============================================================================
+** Constructor
+** ============================================================================
+*/
+PresetCompactor::PresetCompactor()
+    : mIsCompacting( false )
+    , mInString( false )
+    , mIsEscaped( false )
+    , mLastWriteTimestamp( 0 )
+    , mStartTimestamp( 0 )
+    , mSourceSize( 0 )
+    , mSourceLastWrite( 0 )
+    , mNumCompactions( 0 )
+    , mNumCancelled( 0 )
+    , mBytesReclaimed( 0 )
+    , mLastDurationMs( 0 )
+{
+}
+
+/*
+** ============================================================================
+** Starts a compaction when the file needs one and copies chunks of it until
+** the time budget of this loop is used up
+** ============================================================================
+*/
+void PresetCompactor::handle()
+{
+    if (!mIsCompacting)
+    {
+        if (!isNeeded())
+        {
+            return;
+        }
+
+        start();
+        if (!mIsCompacting)
+        {
+            return;
+        }
+    }
+
+    uint32_t startMicros = micros();
+    while (micros() - startMicros < TIME_BUDGET_US)
+    {
+        if (!copyChunk())
+        {
+            if (mIsCompacting)
+            {
+                finish();
+            }
+            return;
+        }
+    }
+}
+
+/*
+** ============================================================================
+** Cancels a running compaction, the copy would not have the new preset, and
+** holds the next one off for IDLE_MS
+** ============================================================================
+*/
+void PresetCompactor::onWrite()
+{
+    if (mIsCompacting)
+    {
+        cancel();
+    }
+
+    mLastWriteTimestamp = millis();
+}
+
+/*
+** ============================================================================
+** Writes whether a compaction is running and what the previous ones did
+** ============================================================================
+*/
+void PresetCompactor::serializeToJson(JsonObject root) const
+{
+    root[COMPACTING_ELEMENT] = mIsCompacting;
+    root[COMPACTIONS_ELEMENT] = mNumCompactions;
+    root[CANCELLED_ELEMENT] = mNumCancelled;
+    root[RECLAIMED_ELEMENT] = mBytesReclaimed;
+    root[LAST_DURATION_ELEMENT] = mLastDurationMs;
+}
+
+/*
+** ============================================================================
+** Returns true if enough of the file is holes and presets are not being
+** written right now.  The dead bytes are only known once the index was built.
+** ============================================================================
+*/
+bool PresetCompactor::isNeeded() const
+{
+    const PresetIndex& index = PresetIndex::get();
+    if (!index.isBuilt() || doCloseFile || millis() - mLastWriteTimestamp < IDLE_MS)
+    {
+        return false;
+    }
+
+    uint32_t deadBytes = index.getDeadBytes();
+    return deadBytes >= MIN_DEAD_BYTES && deadBytes * 100 >= index.getFileSize() * MIN_DEAD_PERCENT;
+}
+
+/*
+** ============================================================================
+** Opens the file and the temporary copy if there is room for the copy
+** ============================================================================
+*/
+void PresetCompactor::start()
+{
+    // Not before IDLE_MS again if this fails
+    mLastWriteTimestamp = millis();
+
+    updateFSInfo();
+    uint32_t liveBytes = PresetIndex::get().getFileSize() - PresetIndex::get().getDeadBytes();
+    if (liveBytes + 1024 > fsBytesTotal - fsBytesUsed)
+    {
+        return;
+    }
+
+    mSource = WLED_FS.open(PRESETS_FILE_NAME, "r");
+    mTarget = WLED_FS.open(TEMP_FILE_NAME, "w");
+    if (!mSource || !mTarget)
+    {
+        mSource.close();
+        mTarget.close();
+        return;
+    }
+
+    mIsCompacting = true;
+    mInString = false;
+    mIsEscaped = false;
+    mStartTimestamp = millis();
+    mSourceSize = mSource.size();
+    mSourceLastWrite = mSource.getLastWrite();
+}
+
+/*
+** ============================================================================
+** Copies the next chunk without the whitespace outside of strings
+**
+**  returns false when the whole file was copied or the copy failed
+** ============================================================================
+*/
+bool PresetCompactor::copyChunk()
+{
+    uint8_t buffer[CHUNK_SIZE];
+    uint16_t length = mSource.read(buffer, CHUNK_SIZE);
+    if (length == 0)
+    {
+        return false;
+    }
+
+    uint16_t kept = 0;
+    for (uint16_t i = 0; i < length; ++i)
+    {
+        char character = buffer[i];
+        if (mInString)
+        {
+            if (mIsEscaped)
+            {
+                mIsEscaped = false;
+            }
+            else if (character == '\\')
+            {
+                mIsEscaped = true;
+            }
+            else if (character == '"')
+            {
+                mInString = false;
+            }
+        }
+        else if (character == '"')
+        {
+            mInString = true;
+        }
+        else if (isWhitespace(character))
+        {
+            continue;
+        }
+
+        buffer[kept++] = character;
+    }
+
+    if (kept > 0 && mTarget.write(buffer, kept) != kept)
+    {
+        // Out of space
+        cancel();
+        return false;
+    }
+
+    return true;
+}
+
+/*
+** ============================================================================
+** Replaces the file with the compacted copy
+** ============================================================================
+*/
+void PresetCompactor::finish()
+{
+    uint32_t oldSize = mSource.size();
+    uint32_t newSize = mTarget.size();
+    mSource.close();
+    mTarget.close();
+    mIsCompacting = false;
+
+    if (0 == newSize || !isSourceUnchanged() || !WLED_FS.rename(TEMP_FILE_NAME, PRESETS_FILE_NAME))
+    {
+        WLED_FS.remove(TEMP_FILE_NAME);
+        ++mNumCancelled;
+        return;
+    }
+
+    // Every offset moved, the presets themselves did not change
+    PresetIndex::get().invalidate();
+    PresetCache::get().onFileMoved();
+
+    ++mNumCompactions;
+    mBytesReclaimed += oldSize - newSize;
+    mLastDurationMs = millis() - mStartTimestamp;
+}
+
+/*
+** ============================================================================
+** Returns true if the file still has the size and modification time it had
+** when the copy started.  An upload through /edit replaces it without
+** cancelling the copy, renaming the copy over it would lose the upload.
+** ============================================================================
+*/
+bool PresetCompactor::isSourceUnchanged()
+{
+    File file = WLED_FS.open(PRESETS_FILE_NAME, "r");
+    if (!file)
+    {
+        return false;
+    }
+
+    bool isUnchanged = file.size() == mSourceSize && file.getLastWrite() == mSourceLastWrite;
+    file.close();
+    return isUnchanged;
+}
+
+/*
+** ============================================================================
+** Stops the copy and throws it away, the file is left as it is
+** ============================================================================
+*/
+void PresetCompactor::cancel()
+{
+    mSource.close();
+    mTarget.close();
+    WLED_FS.remove(TEMP_FILE_NAME);
+    mIsCompacting = false;
+    ++mNumCancelled;
+}
@@ -0,0 +1,75 @@
+#ifndef PRESET_COMPACTOR_H
+#define PRESET_COMPACTOR_H
+
+#include "Arduino.h"
+
+/*
+**-----------------------------------------------------------------------------
+** Removes the holes from /presets.json.  writeObjectToFile treats the presets
+** file as a log: a saved preset is always appended at the end and the old
+** copy (or a deleted preset) is overwritten with spaces, so saving costs the
+** same however full the file is and never searches it for free space.  The
+** holes that leaves are removed here.
+**
+** Once the file is at least MIN_DEAD_PERCENT whitespace (and MIN_DEAD_BYTES),
+** and no preset was written for IDLE_MS, the file is copied to a temporary
+** file without the whitespace outside of strings, a little at a time from the
+** main loop with at most TIME_BUDGET_US spent per loop.  The copy then
+** replaces the file with a rename, which is atomic on LittleFS, so a reboot
+** in the middle leaves the old file as it was.  A preset written while the
+** copy is running cancels it, it is started again later.  The file can also
+** be replaced through /edit without going through writeObjectToFile, so the
+** rename is only done if the file still has the size and modification time
+** it had when the copy started.
+**-----------------------------------------------------------------------------
+*/
+class PresetCompactor
+{
+    public:
+        static const uint16_t TIME_BUDGET_US = 2000;
+        static const uint16_t CHUNK_SIZE = 128;
+        static const uint16_t MIN_DEAD_BYTES = 1024;
+        static const uint8_t MIN_DEAD_PERCENT = 25;
+        static const uint16_t IDLE_MS = 10000;
+
+        static PresetCompactor& get();
+
+        // Copies the next chunks, called from the loop
+        void handle();
+
+        // Called before a preset is written
+        void onWrite();
+
+        void serializeToJson(JsonObject root) const;
+
+    private:
+        PresetCompactor();
+        PresetCompactor(const PresetCompactor&);
+        PresetCompactor& operator=(const PresetCompactor&);
+
+        bool isNeeded() const;
+        void start();
+        bool copyChunk();
+        bool isSourceUnchanged();
+        void finish();
+        void cancel();
+
+    private:
+        File        mSource;
+        File        mTarget;
+        bool        mIsCompacting;
+        bool        mInString;
+        bool        mIsEscaped;
+        uint32_t    mLastWriteTimestamp;
+        uint32_t    mStartTimestamp;
+        uint32_t    mSourceSize;        // of /presets.json when the copy started
+        time_t      mSourceLastWrite;
+
+        // Statistics
+        uint32_t    mNumCompactions;
+        uint32_t    mNumCancelled;
+        uint32_t    mBytesReclaimed;
+        uint32_t    mLastDurationMs;
+};
+
+#endif
@@ -0,0 +1,362 @@
+#include "wled.h"
+
+namespace
+{
+    const char* ENTRIES_ELEMENT = "entries";
+    const char* BUILDS_ELEMENT = "builds";
+    const char* HITS_ELEMENT = "hits";
+    const char* MISSES_ELEMENT = "misses";
+    const char* STALE_ELEMENT = "stale";
+    const char* DEAD_BYTES_ELEMENT = "dead_bytes";
+
+    const uint16_t BUFFER_SIZE = 256;
+
+    // "65535": is the longest key of a preset
+    const uint8_t MAX_KEY_LENGTH = 9;
+
+    uint8_t formatKey(char* key, uint16_t id)
+    {
+        return snprintf(key, MAX_KEY_LENGTH + 1, "\"%u\":", id);
+    }
+}
+
+/*
+** ============================================================================
+** Returns the one preset index
+** ============================================================================
+*/
+PresetIndex& PresetIndex::get()
+{
+    static PresetIndex sPresetIndex;
+    return sPresetIndex;
+}
+
+/*
+** ============================================================================
+** Constructor
+** ============================================================================
+*/
+PresetIndex::PresetIndex()
+    : mIsBuilt( false )
+    , mFileSize( 0 )
+    , mDeadBytes( 0 )
+    , mNumBuilds( 0 )
+    , mNumHits( 0 )
+    , mNumMisses( 0 )
+    , mNumStale( 0 )
+{
+}
+
+/*
+** ============================================================================
+** Positions the file at the start of the preset's object.  The key in front
+** of the indexed offset is checked, if it is not there the file was changed
+** without the index and it is rebuilt.
+**
+**  returns false if there is no such preset
+** ============================================================================
+*/
+bool PresetIndex::seek(File& file, uint16_t id)
+{
+    if (!mIsBuilt || file.size() != mFileSize)
+    {
+        if (mIsBuilt)
+        {
+            // Changed behind our back, the cached presets may be old
+            PresetCache::get().clear();
+        }
+        build(file);
+    }
+
+    EntryList::iterator entry = find(id);
+    if (entry == mEntries.end())
+    {
+        ++mNumMisses;
+        return false;
+    }
+
+    if (!isKeyAt(file, id, entry->offset))
+    {
+        ++mNumStale;
+        PresetCache::get().clear();
+        build(file);
+        entry = find(id);
+        if (entry == mEntries.end())
+        {
+            ++mNumMisses;
+            return false;
+        }
+    }
+
+    ++mNumHits;
+    file.seek(entry->offset, SeekSet);
+    return true;
+}
+
+/*
+** ============================================================================
+** Records the offset of a preset that was just written
+** ============================================================================
+*/
+void PresetIndex::add(uint16_t id, uint32_t offset, uint32_t fileSize)
+{
+    if (!mIsBuilt)
+    {
+        // Will be found by the build
+        return;
+    }
+
+    EntryList::iterator entry = find(id);
+    if (entry != mEntries.end())
+    {
+        entry->offset = offset;
+    }
+    else
+    {
+        Entry newEntry = { id, offset };
+        EntryList::iterator position = mEntries.begin();
+        while (position != mEntries.end() && position->id < id)
+        {
+            ++position;
+        }
+        mEntries.insert(position, newEntry);
+    }
+
+    mFileSize = fileSize;
+}
+
+/*
+** ============================================================================
+** Forgets a preset that was just deleted.  Deleting overwrites it with
+** spaces, it does not change the size.
+** ============================================================================
+*/
+void PresetIndex::remove(uint16_t id, uint32_t blankedBytes)
+{
+    if (!mIsBuilt)
+    {
+        return;
+    }
+
+    EntryList::iterator entry = find(id);
+    if (entry != mEntries.end())
+    {
+        mEntries.erase(entry);
+    }
+    mDeadBytes += blankedBytes;
+}
+
+/*
+** ============================================================================
+** Writes the size of the index and how well it did
+** ============================================================================
+*/
+void PresetIndex::serializeToJson(JsonObject root) const
+{
+    root[ENTRIES_ELEMENT] = mEntries.size();
+    root[BUILDS_ELEMENT] = mNumBuilds;
+    root[HITS_ELEMENT] = mNumHits;
+    root[MISSES_ELEMENT] = mNumMisses;
+    root[STALE_ELEMENT] = mNumStale;
+    root[DEAD_BYTES_ELEMENT] = mDeadBytes;
+}
+
+/*
+** ============================================================================
+** Reads the whole file once and records the offset of the object of every
+** root level key that is a number, and counts the whitespace.  Strings are
+** skipped with their escapes so braces in preset names do not count.
+** ============================================================================
+*/
+void PresetIndex::build(File& file)
+{
+    PROFILE_SCOPE(PROFILE_PRESET_INDEX_BUILD);
+    mEntries.clear();
+    mIsBuilt = true;
+    mFileSize = file.size();
+    mDeadBytes = 0;
+    ++mNumBuilds;
+
+    uint8_t buffer[BUFFER_SIZE];
+    uint32_t position = 0;
+    uint16_t depth = 0;
+    bool inString = false;
+    bool isEscaped = false;
+    bool inKey = false;
+    bool expectKey = false;
+    bool isNumberKey = false;
+    bool hasDigits = false;
+    bool expectValue = false;
+    uint32_t id = 0;
+
+    file.seek(0, SeekSet);
+    while (position < mFileSize)
+    {
+        uint16_t length = file.read(buffer, BUFFER_SIZE);
+        if (length == 0)
+        {
+            break;
+        }
+
+        for (uint16_t i = 0; i < length; ++i, ++position)
+        {
+            char character = buffer[i];
+            if (inString)
+            {
+                if (isEscaped)
+                {
+                    isEscaped = false;
+                    isNumberKey = false;
+                }
+                else if (character == '\\')
+                {
+                    isEscaped = true;
+                }
+                else if (character == '"')
+                {
+                    inString = false;
+                    if (inKey && !hasDigits)
+                    {
+                        isNumberKey = false;
+                    }
+                    inKey = false;
+                }
+                else if (inKey)
+                {
+                    if (character >= '0' && character <= '9' && id <= UINT16_MAX)
+                    {
+                        id = id * 10 + (character - '0');
+                        hasDigits = true;
+                    }
+                    else
+                    {
+                        isNumberKey = false;
+                    }
+                }
+                continue;
+            }
+
+            switch (character)
+            {
+                case '"':
+                    inString = true;
+                    inKey = (depth == 1 && expectKey);
+                    if (inKey)
+                    {
+                        expectKey = false;
+                        isNumberKey = true;
+                        hasDigits = false;
+                        id = 0;
+                    }
+                    break;
+                case ':':
+                    expectValue = (depth == 1);
+                    break;
+                case ',':
+                    expectKey = (depth == 1);
+                    break;
+                case '{':
+                    if (depth == 1 && expectValue && isNumberKey && id <= UINT16_MAX)
+                    {
+                        Entry entry = { (uint16_t)id, position };
+                        EntryList::iterator insertAt = mEntries.begin();
+                        while (insertAt != mEntries.end() && insertAt->id < entry.id)
+                        {
+                            ++insertAt;
+                        }
+                        // The first of two equal keys is the one that is found
+                        if (insertAt == mEntries.end() || insertAt->id != entry.id)
+                        {
+                            mEntries.insert(insertAt, entry);
+                        }
+                    }
+                    ++depth;
+                    expectKey = (depth == 1);
+                    expectValue = false;
+                    break;
+                case '}':
+                    if (depth > 0)
+                    {
+                        --depth;
+                    }
+                    break;
+                case '[':
+                    ++depth;
+                    break;
+                case ']':
+                    if (depth > 0)
+                    {
+                        --depth;
+                    }
+                    break;
+                case ' ':
+                case '\t':
+                case '\r':
+                case '\n':
+                    ++mDeadBytes;
+                    break;
+                default:
+                    if (depth == 1)
+                    {
+                        // A value that is not an object
+                        expectValue = false;
+                    }
+                    break;
+            }
+        }
+    }
+}
+
+/*
+** ============================================================================
+** Returns the entry of the given preset with a binary search
+** ============================================================================
+*/
+PresetIndex::EntryList::iterator PresetIndex::find(uint16_t id)
+{
+    int16_t low = 0;
+    int16_t high = (int16_t)mEntries.size() - 1;
+    while (low <= high)
+    {
+        int16_t middle = (low + high) / 2;
+        if (mEntries[middle].id == id)
+        {
+            return mEntries.begin() + middle;
+        }
+
+        if (mEntries[middle].id < id)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle - 1;
+        }
+    }
+
+    return mEntries.end();
+}
+
+/*
+** ============================================================================
+** Returns true if the preset's key is right in front of the given offset
+** ============================================================================
+*/
+bool PresetIndex::isKeyAt(File& file, uint16_t id, uint32_t offset) const
+{
+    char key[MAX_KEY_LENGTH + 1];
+    uint8_t keyLength = formatKey(key, id);
+    if (offset < keyLength || offset >= file.size())
+    {
+        return false;
+    }
+
+    char found[MAX_KEY_LENGTH + 1];
+    file.seek(offset - keyLength, SeekSet);
+    if (file.read((uint8_t*)found, keyLength + 1) != keyLength + 1)
+    {
+        return false;
+    }
+
+    return 0 == strncmp(found, key, keyLength) && found[keyLength] == '{';
+}
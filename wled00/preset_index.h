@@ -0,0 +1,84 @@
+#ifndef PRESET_INDEX_H
+#define PRESET_INDEX_H
+
+#include "Arduino.h"
+
+#include <vector>
+
+/*
+**-----------------------------------------------------------------------------
+** Remembers where each preset's object starts in /presets.json, so applying or
+** saving a preset seeks straight to it instead of searching the whole file
+** for its "N": key with bufferedFind.
+**
+** The index is built with one pass over the file the first time a preset is
+** looked up after boot.  writeObjectToFile keeps it up to date as it writes,
+** which it can do exactly because it never moves other objects (an old or
+** deleted object is overwritten with spaces, a new one appended).  The
+** index is rebuilt when the file's size is not what it last saw, and when
+** the key is not found at the indexed offset, so a file changed behind its
+** back (for example with the editor) is picked up, which also drops the
+** PresetCache.
+**
+** Only the start of an object is kept, its end is still found by reading the
+** object itself, which is all the reading and writing needs anyway.
+**
+** The index also knows how many bytes of the file are whitespace (mostly the
+** holes left by replaced and deleted presets), which PresetCompactor uses to
+** decide when to compact the file.
+**-----------------------------------------------------------------------------
+*/
+class PresetIndex
+{
+    public:
+        static PresetIndex& get();
+
+        static bool isIndexedFile(const char* path) { return 0 == strcmp(path, "/presets.json"); }
+
+        // Positions the file at the start of the preset's object (just past its key)
+        //  returns false if there is no such preset
+        bool seek(File& file, uint16_t id);
+
+        // Called by writeObjectToFile after it wrote or deleted (blanked) a preset
+        void add(uint16_t id, uint32_t offset, uint32_t fileSize);
+        void remove(uint16_t id, uint32_t blankedBytes);
+
+        // Rebuilds on the next lookup
+        void invalidate() { mIsBuilt = false; }
+
+        bool isBuilt() const { return mIsBuilt; }
+        uint32_t getFileSize() const { return mFileSize; }
+        uint32_t getDeadBytes() const { return mDeadBytes; }
+
+        void serializeToJson(JsonObject root) const;
+
+    private:
+        PresetIndex();
+        PresetIndex(const PresetIndex&);
+        PresetIndex& operator=(const PresetIndex&);
+
+        struct Entry
+        {
+            uint16_t    id;
+            uint32_t    offset;     // of the object's '{'
+        };
+        typedef std::vector<Entry> EntryList;
+
+        void build(File& file);
+        EntryList::iterator find(uint16_t id);
+        bool isKeyAt(File& file, uint16_t id, uint32_t offset) const;
+
+    private:
+        EntryList   mEntries;       // sorted by id
+        bool        mIsBuilt;
+        uint32_t    mFileSize;
+        uint32_t    mDeadBytes;     // whitespace outside of strings
+
+        // Statistics
+        uint32_t    mNumBuilds;
+        uint32_t    mNumHits;
+        uint32_t    mNumMisses;
+        uint32_t    mNumStale;
+};
+
+#endif
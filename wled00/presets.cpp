@@ -6,8 +6,10 @@
 
 bool applyPreset(byte index)
 {
+  uint32_t startMicros = micros();
+  bool wasCached = false; //read from PresetCache instead of the file
   if (fileDoc) {
-    errorFlag = readObjectFromFileUsingId("/presets.json", index, fileDoc) ? ERR_NONE : ERR_FS_PLOAD;
+    errorFlag = PresetCache::get().read(index, fileDoc, wasCached) ? ERR_NONE : ERR_FS_PLOAD;
     JsonObject fdo = fileDoc->as<JsonObject>();
     if (fdo["ps"] == index) fdo.remove("ps"); //remove load request for same presets to prevent recursive crash
     #ifdef WLED_DEBUG_FS
@@ -16,15 +18,17 @@ bool applyPreset(byte index)
     deserializeState(fdo);
   } else {
     DEBUGFS_PRINTLN(F("Make read buf"));
-    DynamicJsonDocument fDoc(JSON_BUFFER_SIZE);
-    errorFlag = readObjectFromFileUsingId("/presets.json", index, &fDoc) ? ERR_NONE : ERR_FS_PLOAD;
-    JsonObject fdo = fDoc.as<JsonObject>();
+    JsonDocumentLease fDoc;
+    if (!fDoc.isValid()) return false;
+    errorFlag = PresetCache::get().read(index, fDoc.get(), wasCached) ? ERR_NONE : ERR_FS_PLOAD;
+    JsonObject fdo = fDoc->as<JsonObject>();
     if (fdo["ps"] == index) fdo.remove("ps");
     #ifdef WLED_DEBUG_FS
-      serializeJson(fDoc, Serial);
+      serializeJson(*fDoc, Serial);
     #endif
     deserializeState(fdo);
   }
+  PresetCache::get().recordApplyTime(wasCached, micros() - startMicros);
 
   if (!errorFlag) {
     currentPreset = index;
@@ -42,14 +46,15 @@ void savePreset(byte index, bool persist, const char* pname, JsonObject saveobj)
 
   if (!docAlloc) {
     DEBUGFS_PRINTLN(F("Allocating saving buffer"));
-    DynamicJsonDocument lDoc(JSON_BUFFER_SIZE);
-    sObj = lDoc.to<JsonObject>();
+    JsonDocumentLease lDoc;
+    if (!lDoc.isValid()) return;
+    sObj = lDoc->to<JsonObject>();
     if (pname) sObj["n"] = pname;
     DEBUGFS_PRINTLN(F("Save current state"));
     serializeState(sObj, true);
     currentPreset = index;
 
-    writeObjectToFileUsingId("/presets.json", index, &lDoc);
+    writeObjectToFileUsingId("/presets.json", index, lDoc.get());
   } else { //from JSON API
     DEBUGFS_PRINTLN(F("Reuse recv buffer"));
     sObj.remove(F("psave"));
@@ -0,0 +1,398 @@
+#include "wled.h"
+
+#ifndef WLED_DISABLE_PROFILER
+
+#ifdef ARDUINO_ARCH_ESP32
+  // Stages are timed in the async TCP task as well as in the loop task
+  static portMUX_TYPE sProfilerMux = portMUX_INITIALIZER_UNLOCKED;
+  #define PROFILER_LOCK()   portENTER_CRITICAL(&sProfilerMux)
+  #define PROFILER_UNLOCK() portEXIT_CRITICAL(&sProfilerMux)
+#else
+  // Everything runs in the same context on the ESP8266
+  #define PROFILER_LOCK()
+  #define PROFILER_UNLOCK()
+#endif
+
+namespace
+{
+    // Indexed by ProfileStage
+    const char* STAGE_NAMES[PROFILE_NUM_STAGES] = {
+        "loop",
+        "ir",
+        "connection",
+        "serial",
+        "notifications",
+        "transitions",
+        "dmx",
+        "usermods",
+        "io",
+        "network_time",
+        "alexa",
+        "overlays",
+        "nightlight",
+        "playlist",
+        "hue",
+        "blynk",
+        "light_display",
+        "mqtt",
+        "ws",
+        "render_object",
+        "transition_blend",
+        "power_calc",
+        "show",
+        "prepare_scenes",
+        "save_display",
+        "file_write",
+        "http_json",
+        "ws_event",
+        "e131_packet",
+        "file_read",
+        "preset_index_build",
+        "preset_compaction",
+        "preset_prefetch",
+        "deferred_services",
+    };
+
+    const char* UPTIME_ELEMENT = "uptime_ms";
+    const char* BUCKET_LIMITS_ELEMENT = "bucket_us";
+    const char* STAGES_ELEMENT = "stages";
+    const char* COUNT_ELEMENT = "count";
+    const char* TOTAL_ELEMENT = "total_us";
+    const char* AVERAGE_ELEMENT = "avg_us";
+    const char* MAX_ELEMENT = "max_us";
+    const char* HISTOGRAM_ELEMENT = "hist";
+
+    // Stages handled by the network callbacks run outside of the main loop (in the async TCP/UDP
+    // task on the ESP32), so they are shown on their own track to keep the loop track nested
+    const uint8_t LOOP_TRACK = 1;
+    const uint8_t NETWORK_TRACK = 2;
+
+    const char* TRACE_HEADER =
+        "{\"traceEvents\":["
+        "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"loop\"}},"
+        "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"network\"}}";
+    const char* TRACE_EVENT_FORMAT =
+        ",{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%lu,\"dur\":%lu,\"pid\":1,\"tid\":%u,\"args\":{\"arg\":%u}}";
+    const char* TRACE_FOOTER = "],\"displayTimeUnit\":\"ms\"}";
+
+    uint8_t getTraceTrack(uint8_t stage)
+    {
+        switch (stage)
+        {
+            case PROFILE_HTTP_JSON:
+            case PROFILE_WS_EVENT:
+            case PROFILE_E131_PACKET:
+                return NETWORK_TRACK;
+            default:
+                return LOOP_TRACK;
+        }
+    }
+}
+
+/*
+** ============================================================================
+** Returns the one profiler
+** ============================================================================
+*/
+Profiler& Profiler::get()
+{
+    static Profiler sProfiler;
+    return sProfiler;
+}
+
+/*
+** ============================================================================
+** Constructor
+** ============================================================================
+*/
+Profiler::Profiler()
+    : mCyclesPerMicro( ESP.getCpuFreqMHz() )
+{
+    if (0 == mCyclesPerMicro)
+    {
+        mCyclesPerMicro = 80;
+    }
+
+    reset();
+}
+
+/*
+** ============================================================================
+** Adds one sample to the histogram of the given stage and to the trace
+**
+**  param   stage - ProfileStage that was timed
+**  param   cycles - CPU cycles the stage took
+**  param   arg - stage specific argument stored in the trace
+** ============================================================================
+*/
+void Profiler::record(uint8_t stage, uint32_t cycles, uint8_t arg)
+{
+    if (stage >= PROFILE_NUM_STAGES)
+    {
+        return;
+    }
+
+    uint32_t elapsedMicros = cycles / mCyclesPerMicro;
+    FrameTracer::get().record(stage, micros() - elapsedMicros, elapsedMicros, arg);
+
+    // Bucket is the number of significant bits, so bucket n holds [2^(n-1), 2^n)
+    uint8_t bucket = 0;
+    for (uint32_t remaining = elapsedMicros; remaining > 0 && bucket < NUM_BUCKETS - 1; remaining >>= 1)
+    {
+        ++bucket;
+    }
+
+    PROFILER_LOCK();
+    StageStatistics& statistics = mStages[stage];
+    ++statistics.count;
+    statistics.totalMicros += elapsedMicros;
+    ++statistics.buckets[bucket];
+
+    if (elapsedMicros > statistics.maxMicros)
+    {
+        statistics.maxMicros = elapsedMicros;
+    }
+    PROFILER_UNLOCK();
+}
+
+/*
+** ============================================================================
+** Clears the histograms of every stage
+** ============================================================================
+*/
+void Profiler::reset()
+{
+    PROFILER_LOCK();
+    memset(mStages, 0, sizeof(mStages));
+    mResetTimestamp = millis();
+    PROFILER_UNLOCK();
+}
+
+/*
+** ============================================================================
+** Writes the histograms of every stage that has been timed since the last
+** reset.  The histograms are written as arrays of counts, "bucket_us" has the
+** upper limit (us) of each bucket (0 for the last, unbounded bucket).
+** ============================================================================
+*/
+void Profiler::serializeToJson(JsonObject root) const
+{
+    root[UPTIME_ELEMENT] = millis() - mResetTimestamp;
+
+    JsonArray bucketLimits = root.createNestedArray(BUCKET_LIMITS_ELEMENT);
+    for (uint8_t bucket = 0; bucket < NUM_BUCKETS; ++bucket)
+    {
+        bucketLimits.add((bucket < NUM_BUCKETS - 1) ? (1UL << bucket) : 0);
+    }
+
+    JsonObject stages = root.createNestedObject(STAGES_ELEMENT);
+    for (uint8_t stage = 0; stage < PROFILE_NUM_STAGES; ++stage)
+    {
+        // Copied so the lock is not held while building the JSON
+        PROFILER_LOCK();
+        StageStatistics statistics = mStages[stage];
+        PROFILER_UNLOCK();
+
+        if (0 == statistics.count)
+        {
+            continue;
+        }
+
+        JsonObject stageObject = stages.createNestedObject(STAGE_NAMES[stage]);
+        stageObject[COUNT_ELEMENT] = statistics.count;
+        stageObject[TOTAL_ELEMENT] = statistics.totalMicros;
+        stageObject[AVERAGE_ELEMENT] = statistics.totalMicros / statistics.count;
+        stageObject[MAX_ELEMENT] = statistics.maxMicros;
+
+        // Trailing empty buckets are left out
+        uint8_t numBuckets = NUM_BUCKETS;
+        while (numBuckets > 0 && 0 == statistics.buckets[numBuckets - 1])
+        {
+            --numBuckets;
+        }
+
+        JsonArray histogram = stageObject.createNestedArray(HISTOGRAM_ELEMENT);
+        for (uint8_t bucket = 0; bucket < numBuckets; ++bucket)
+        {
+            histogram.add(statistics.buckets[bucket]);
+        }
+    }
+}
+
+/*
+** ============================================================================
+** Returns the one frame tracer
+** ============================================================================
+*/
+FrameTracer& FrameTracer::get()
+{
+    static FrameTracer sFrameTracer;
+    return sFrameTracer;
+}
+
+/*
+** ============================================================================
+** Constructor
+** ============================================================================
+*/
+FrameTracer::FrameTracer()
+{
+    clear();
+}
+
+/*
+** ============================================================================
+** Adds an event to the trace, replacing the oldest event once the buffer is
+** full
+** ============================================================================
+*/
+void FrameTracer::record(uint8_t stage, uint32_t startMicros, uint32_t durationMicros, uint8_t arg)
+{
+    PROFILER_LOCK();
+    TraceEvent& event = mEvents[mNextEvent];
+    event.startMicros = startMicros;
+    event.durationMicros = durationMicros;
+    event.stage = stage;
+    event.arg = arg;
+
+    mNextEvent = (mNextEvent + 1) % NUM_EVENTS;
+    if (mNumEvents < NUM_EVENTS)
+    {
+        ++mNumEvents;
+    }
+    PROFILER_UNLOCK();
+}
+
+/*
+** ============================================================================
+** Removes every event from the trace
+** ============================================================================
+*/
+void FrameTracer::clear()
+{
+    PROFILER_LOCK();
+    mNextEvent = 0;
+    mNumEvents = 0;
+    PROFILER_UNLOCK();
+}
+
+/*
+** ============================================================================
+** Copies the events in the trace, oldest first, into the given list
+** ============================================================================
+*/
+void FrameTracer::copyEvents(std::vector<TraceEvent>& events) const
+{
+    // Reserved up front so nothing is allocated while the lock is held
+    events.clear();
+    events.reserve(NUM_EVENTS);
+
+    PROFILER_LOCK();
+    uint16_t numEvents = mNumEvents;
+    uint16_t oldestEvent = (mNextEvent + NUM_EVENTS - numEvents) % NUM_EVENTS;
+
+    for (uint16_t i = 0; i < numEvents; ++i)
+    {
+        events.push_back(mEvents[(oldestEvent + i) % NUM_EVENTS]);
+    }
+    PROFILER_UNLOCK();
+}
+
+/*
+** ============================================================================
+** Constructor, takes the copy of the trace to export
+** ============================================================================
+*/
+TraceExport::TraceExport()
+    : mNextEvent( 0 )
+    , mState( EXPORT_HEADER )
+    , mPendingLength( 0 )
+    , mPendingOffset( 0 )
+{
+    FrameTracer::get().copyEvents(mEvents);
+}
+
+/*
+** ============================================================================
+** Fills the buffer with the next part of the trace document.  A part that
+** does not fit is carried over to the next call.
+**
+**  returns the number of bytes written, 0 once the whole document is written
+** ============================================================================
+*/
+size_t TraceExport::write(uint8_t* buffer, size_t maxLength)
+{
+    size_t written = 0;
+
+    while (written < maxLength)
+    {
+        if (mPendingOffset >= mPendingLength && !formatNextPart())
+        {
+            break;
+        }
+
+        size_t length = mPendingLength - mPendingOffset;
+        if (length > maxLength - written)
+        {
+            length = maxLength - written;
+        }
+
+        memcpy(buffer + written, mPending + mPendingOffset, length);
+        mPendingOffset += length;
+        written += length;
+    }
+
+    return written;
+}
+
+/*
+** ============================================================================
+** Formats the next part of the document into the pending buffer
+**
+**  returns false once there is nothing left to write
+** ============================================================================
+*/
+bool TraceExport::formatNextPart()
+{
+    int length = 0;
+
+    switch (mState)
+    {
+        case EXPORT_HEADER:
+            length = snprintf(mPending, sizeof(mPending), "%s", TRACE_HEADER);
+            mState = EXPORT_EVENTS;
+            break;
+
+        case EXPORT_EVENTS:
+            if (mNextEvent < mEvents.size())
+            {
+                const TraceEvent& event = mEvents[mNextEvent++];
+                const char* name = (event.stage < PROFILE_NUM_STAGES) ? STAGE_NAMES[event.stage] : "unknown";
+                length = snprintf(mPending, sizeof(mPending), TRACE_EVENT_FORMAT, name, (unsigned long)event.startMicros,
+                                  (unsigned long)event.durationMicros, (unsigned)getTraceTrack(event.stage), (unsigned)event.arg);
+                break;
+            }
+
+            mState = EXPORT_FOOTER;
+            // fall through
+
+        case EXPORT_FOOTER:
+            length = snprintf(mPending, sizeof(mPending), "%s", TRACE_FOOTER);
+            mState = EXPORT_DONE;
+            break;
+
+        case EXPORT_DONE:
+        default:
+            return false;
+    }
+
+    if (length < 0)
+    {
+        length = 0;
+    }
+    mPendingLength = ((size_t)length < sizeof(mPending)) ? length : sizeof(mPending) - 1;
+    mPendingOffset = 0;
+    return true;
+}
+
+#endif
@@ -0,0 +1,223 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "Arduino.h"
+
+#include <vector>
+
+/*
+** Stages of the main loop and of the frame rendering that are timed by the
+** profiler.  New stages are added before PROFILE_NUM_STAGES and given a name in
+** profiler.cpp.
+*/
+enum ProfileStage : uint8_t
+{
+    PROFILE_LOOP = 0,
+    PROFILE_IR,
+    PROFILE_CONNECTION,
+    PROFILE_SERIAL,
+    PROFILE_NOTIFICATIONS,
+    PROFILE_TRANSITIONS,
+    PROFILE_DMX,
+    PROFILE_USERMODS,
+    PROFILE_IO,
+    PROFILE_NETWORK_TIME,
+    PROFILE_ALEXA,
+    PROFILE_OVERLAYS,
+    PROFILE_NIGHTLIGHT,
+    PROFILE_PLAYLIST,
+    PROFILE_HUE,
+    PROFILE_BLYNK,
+    PROFILE_LIGHT_DISPLAY,
+    PROFILE_MQTT,
+    PROFILE_WS,
+    PROFILE_RENDER_OBJECT,
+    PROFILE_TRANSITION_BLEND,
+    PROFILE_POWER_CALC,
+    PROFILE_SHOW,
+    PROFILE_PREPARE_SCENES,
+    PROFILE_SAVE_DISPLAY,
+    PROFILE_FILE_WRITE,
+    PROFILE_HTTP_JSON,
+    PROFILE_WS_EVENT,
+    PROFILE_E131_PACKET,
+    PROFILE_FILE_READ,
+    PROFILE_PRESET_INDEX_BUILD,
+    PROFILE_PRESET_COMPACTION,
+    PROFILE_PRESET_PREFETCH,
+    PROFILE_DEFERRED_SERVICES,
+    PROFILE_NUM_STAGES
+};
+
+#ifndef WLED_DISABLE_PROFILER
+
+/*
+**-----------------------------------------------------------------------------
+** Collects how long each stage of the hot path takes.  Stages are timed with
+** the CPU cycle counter, which costs a couple of cycles to read, and every
+** sample is added to a fixed log2 histogram of microseconds: bucket 0 counts
+** samples under 1us, bucket n counts samples from 2^(n-1) up to 2^n us and the
+** last bucket counts everything longer.  Recording a sample never allocates.
+** On the ESP32 the web server callbacks are timed in the async TCP task, so
+** the histograms and the trace are guarded by a spinlock.
+**
+** The histograms are served at /json/perf ("profiler") and cleared by the "reset_perf_stats"
+** object action.
+** Building with WLED_DISABLE_PROFILER removes the profiler and every PROFILE_
+** macro expands to just the code it wraps.
+**-----------------------------------------------------------------------------
+*/
+class Profiler
+{
+    public:
+        static const uint8_t NUM_BUCKETS = 16;
+
+        static Profiler& get();
+
+        void record(uint8_t stage, uint32_t cycles, uint8_t arg);
+        void reset();
+
+        void serializeToJson(JsonObject root) const;
+
+    private:
+        Profiler();
+        Profiler(const Profiler&);
+        Profiler& operator=(const Profiler&);
+
+        struct StageStatistics
+        {
+            uint32_t    count;
+            uint32_t    totalMicros;
+            uint32_t    maxMicros;
+            uint32_t    buckets[NUM_BUCKETS];
+        };
+
+    private:
+        StageStatistics mStages[PROFILE_NUM_STAGES];
+        uint32_t        mCyclesPerMicro;
+        uint32_t        mResetTimestamp;
+};
+
+/*
+**-----------------------------------------------------------------------------
+** One timed stage in the trace.  The argument tells apart several instances of
+** the same stage, for example the output index of a bus transmit.  The full
+** duration is kept, the long stalls are the ones the trace is meant to find.
+**-----------------------------------------------------------------------------
+*/
+struct TraceEvent
+{
+    uint32_t    startMicros;
+    uint32_t    durationMicros;
+    uint8_t     stage;
+    uint8_t     arg;
+};
+
+/*
+**-----------------------------------------------------------------------------
+** Keeps the most recent timed stages in a fixed ring buffer so that stutters
+** can be inspected after the fact, for example a WebSocket message being
+** handled right before a Show().  Every sample given to the profiler is also
+** added here, which is a single 12 byte store, so the tracer is cheap enough to
+** stay enabled.
+**
+** The trace is downloaded from /json/trace as Chrome trace event JSON, which
+** can be opened in Perfetto or chrome://tracing.
+**-----------------------------------------------------------------------------
+*/
+class FrameTracer
+{
+    public:
+#ifdef ESP8266
+        static const uint16_t NUM_EVENTS = 256;
+#else
+        static const uint16_t NUM_EVENTS = 1024;
+#endif
+
+        static FrameTracer& get();
+
+        void record(uint8_t stage, uint32_t startMicros, uint32_t durationMicros, uint8_t arg);
+        void clear();
+
+        // Copies the events, oldest first
+        void copyEvents(std::vector<TraceEvent>& events) const;
+
+    private:
+        FrameTracer();
+        FrameTracer(const FrameTracer&);
+        FrameTracer& operator=(const FrameTracer&);
+
+    private:
+        TraceEvent  mEvents[NUM_EVENTS];
+        uint16_t    mNextEvent;
+        uint16_t    mNumEvents;
+};
+
+/*
+**-----------------------------------------------------------------------------
+** Writes a copy of the trace as Chrome trace event JSON a chunk at a time, so
+** a chunked web response never needs the whole document in memory.  The copy
+** is taken when the export is created so recording carries on meanwhile.
+**-----------------------------------------------------------------------------
+*/
+class TraceExport
+{
+    public:
+        TraceExport();
+
+        // Fills the buffer with the next part of the document, returns 0 once done
+        size_t write(uint8_t* buffer, size_t maxLength);
+
+    private:
+        enum ExportState : uint8_t
+        {
+            EXPORT_HEADER = 0,
+            EXPORT_EVENTS,
+            EXPORT_FOOTER,
+            EXPORT_DONE
+        };
+
+        bool formatNextPart();
+
+    private:
+        static const uint16_t MAX_PART_LENGTH = 256;
+
+        std::vector<TraceEvent> mEvents;
+        size_t                  mNextEvent;
+        ExportState             mState;
+
+        char                    mPending[MAX_PART_LENGTH];
+        size_t                  mPendingLength;
+        size_t                  mPendingOffset;
+};
+
+/*
+**-----------------------------------------------------------------------------
+** Records the time from its construction to the end of the enclosing scope
+**-----------------------------------------------------------------------------
+*/
+class ProfileScope
+{
+    public:
+        explicit ProfileScope(uint8_t stage, uint8_t arg = 0) : mStage(stage), mArg(arg), mStartCycles(ESP.getCycleCount()) {}
+        ~ProfileScope() { Profiler::get().record(mStage, ESP.getCycleCount() - mStartCycles, mArg); }
+
+    private:
+        uint8_t     mStage;
+        uint8_t     mArg;
+        uint32_t    mStartCycles;
+};
+
+#define PROFILE_SCOPE(stage) ProfileScope profileScope_##stage(stage)
+#define PROFILE_SCOPE_ARG(stage, arg) ProfileScope profileScope_##stage(stage, arg)
+#define PROFILE_CALL(stage, call) do { ProfileScope profileScope(stage); call; } while (0)
+
+#else
+
+#define PROFILE_SCOPE(stage)
+#define PROFILE_SCOPE_ARG(stage, arg)
+#define PROFILE_CALL(stage, call) do { call; } while (0)
+
+#endif
+
+#endif
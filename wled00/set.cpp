@@ -32,6 +32,7 @@ void handleSettingsSet(AsyncWebServerRequest *request, byte subPage)
 {
   //0: menu 1: wifi 2: leds 3: ui 4: sync 5: time 6: sec 7: DMX
   if (subPage <1 || subPage >7) return;
+  JsonResponseCache::get().invalidate();
 
   //WIFI SETTINGS
   if (subPage == 1)
@@ -338,113 +339,70 @@ void handleSettingsSet(AsyncWebServerRequest *request, byte subPage)
 
 
 
-//helper to get int value at a position in string
-int getNumVal(const String* req, uint16_t pos)
-{
-  return req->substring(pos+3).toInt();
-}
-
-
-//helper to get int value at a position in string
-bool updateVal(const String* req, const char* key, byte* val, byte minv, byte maxv)
-{
-  int pos = req->indexOf(key);
-  if (pos < 1) return false;
-
-  if (req->charAt(pos+3) == '~') {
-    int out = getNumVal(req, pos+1);
-    if (out == 0)
-    {
-      if (req->charAt(pos+4) == '-')
-      {
-        *val = (*val <= minv)? maxv : *val -1;
-      } else {
-        *val = (*val >= maxv)? minv : *val +1;
-      }
-    } else {
-      out += *val;
-      if (out > maxv) out = maxv;
-      if (out < minv) out = minv;
-      *val = out;
-    }
-  } else
-  {
-    *val = getNumVal(req, pos);
-  }
-  return true;
-}
-
-
 //HTTP API request parser
 bool handleSet(AsyncWebServerRequest *request, const String& req, bool apply)
 {
   if (!(req.indexOf("win") >= 0)) return false;
+  JsonResponseCache::get().invalidate();
 
-  int pos = 0;
   DEBUG_PRINT(F("API req: "));
   DEBUG_PRINTLN(req);
 
+  ApiRequest api(req); //splits the request into its parameters once
+
 #ifdef ENABLE_SET_EFFECTS // MDR TEMP - removing set effects functionality
   strip.applyToAllSelected = false;
 #endif // ENABLE_SET_EFFECTS
 
   //set presets
-  pos = req.indexOf(F("P1=")); //sets first preset for cycle
-  if (pos > 0) presetCycleMin = getNumVal(&req, pos);
-
-  pos = req.indexOf(F("P2=")); //sets last preset for cycle
-  if (pos > 0) presetCycleMax = getNumVal(&req, pos);
+  if (api.has(API_KEY_P1)) presetCycleMin = api.getNumber(API_KEY_P1); //sets first preset for cycle
+  if (api.has(API_KEY_P2)) presetCycleMax = api.getNumber(API_KEY_P2); //sets last preset for cycle
 
   //preset cycle
-  pos = req.indexOf(F("CY="));
-  if (pos > 0)
+  if (api.has(API_KEY_CY))
   {
-    char cmd = req.charAt(pos+3);
+    char cmd = api.getFirstChar(API_KEY_CY);
     if (cmd == '2') presetCyclingEnabled = !presetCyclingEnabled;
     else presetCyclingEnabled = (cmd != '0');
     presetCycCurr = presetCycleMin;
   }
 
-  pos = req.indexOf(F("PT=")); //sets cycle time in ms
-  if (pos > 0) {
-    int v = getNumVal(&req, pos);
+  if (api.has(API_KEY_PT)) { //sets cycle time in ms
+    int v = api.getNumber(API_KEY_PT);
     if (v > 100) presetCycleTime = v/100;
   }
 
-  pos = req.indexOf(F("PS=")); //saves current in preset
-  if (pos > 0) savePreset(getNumVal(&req, pos));
+  if (api.has(API_KEY_PS)) savePreset(api.getNumber(API_KEY_PS)); //saves current in preset
 
   //apply preset
-  if (updateVal(&req, "PL=", &presetCycCurr, presetCycleMin, presetCycleMax)) {
+  if (api.updateByte(API_KEY_PL, &presetCycCurr, presetCycleMin, presetCycleMax)) {
     applyPreset(presetCycCurr);
   }
 
   //set brightness
-  updateVal(&req, "&A=", &bri);
+  api.updateByte(API_KEY_A, &bri);
 
   //set colors
-  updateVal(&req, "&R=", &col[0]);
-  updateVal(&req, "&G=", &col[1]);
-  updateVal(&req, "&B=", &col[2]);
-  updateVal(&req, "&W=", &col[3]);
-  updateVal(&req, "R2=", &colSec[0]);
-  updateVal(&req, "G2=", &colSec[1]);
-  updateVal(&req, "B2=", &colSec[2]);
-  updateVal(&req, "W2=", &colSec[3]);
+  api.updateByte(API_KEY_R, &col[0]);
+  api.updateByte(API_KEY_G, &col[1]);
+  api.updateByte(API_KEY_B, &col[2]);
+  api.updateByte(API_KEY_W, &col[3]);
+  api.updateByte(API_KEY_R2, &colSec[0]);
+  api.updateByte(API_KEY_G2, &colSec[1]);
+  api.updateByte(API_KEY_B2, &colSec[2]);
+  api.updateByte(API_KEY_W2, &colSec[3]);
 
   #ifdef WLED_ENABLE_LOXONE
   //lox parser
-  pos = req.indexOf(F("LX=")); // Lox primary color
-  if (pos > 0) {
-    int lxValue = getNumVal(&req, pos);
+  if (api.has(API_KEY_LX)) { // Lox primary color
+    int lxValue = api.getNumber(API_KEY_LX);
     if (parseLx(lxValue, col)) {
       bri = 255;
       nightlightActive = false; //always disable nightlight when toggling
     }
   }
-  pos = req.indexOf(F("LY=")); // Lox secondary color
-  if (pos > 0) {
-    int lxValue = getNumVal(&req, pos);
+  if (api.has(API_KEY_LY)) { // Lox secondary color
+    int lxValue = api.getNumber(API_KEY_LY);
     if(parseLx(lxValue, colSec)) {
       bri = 255;
       nightlightActive = false; //always disable nightlight when toggling
@@ -454,47 +412,43 @@ bool handleSet(AsyncWebServerRequest *request, const String& req, bool apply)
   #endif
 
   //set hue
-  pos = req.indexOf(F("HU="));
-  if (pos > 0) {
-    uint16_t temphue = getNumVal(&req, pos);
+  if (api.has(API_KEY_HU)) {
+    uint16_t temphue = api.getNumber(API_KEY_HU);
     byte tempsat = 255;
-    pos = req.indexOf(F("SA="));
-    if (pos > 0) {
-      tempsat = getNumVal(&req, pos);
+    if (api.has(API_KEY_SA)) {
+      tempsat = api.getNumber(API_KEY_SA);
     }
-    colorHStoRGB(temphue,tempsat,(req.indexOf(F("H2"))>0)? colSec:col);
+    colorHStoRGB(temphue,tempsat,api.has(API_KEY_H2)? colSec:col);
   }
 
   //set white spectrum (kelvin)
-  pos = req.indexOf(F("&K="));
-  if (pos > 0) {
-    colorKtoRGB(getNumVal(&req, pos),(req.indexOf(F("K2"))>0)? colSec:col);
+  if (api.has(API_KEY_K)) {
+    colorKtoRGB(api.getNumber(API_KEY_K),api.has(API_KEY_K2)? colSec:col);
   }
 
   //set color from HEX or 32bit DEC
-  pos = req.indexOf(F("CL="));
-  if (pos > 0) {
-    colorFromDecOrHexString(col, (char*)req.substring(pos + 3).c_str());
+  char colorValue[16];
+  if (api.has(API_KEY_CL)) {
+    api.getValue(API_KEY_CL, colorValue, sizeof(colorValue));
+    colorFromDecOrHexString(col, colorValue);
   }
-  pos = req.indexOf(F("C2="));
-  if (pos > 0) {
-    colorFromDecOrHexString(colSec, (char*)req.substring(pos + 3).c_str());
+  if (api.has(API_KEY_C2)) {
+    api.getValue(API_KEY_C2, colorValue, sizeof(colorValue));
+    colorFromDecOrHexString(colSec, colorValue);
   }
-  pos = req.indexOf(F("C3="));
-  if (pos > 0) {
+  if (api.has(API_KEY_C3)) {
     byte t[4];
-    colorFromDecOrHexString(t, (char*)req.substring(pos + 3).c_str());
+    api.getValue(API_KEY_C3, colorValue, sizeof(colorValue));
+    colorFromDecOrHexString(t, colorValue);
   }
 
   //set to random hue SR=0->1st SR=1->2nd
-  pos = req.indexOf(F("SR"));
-  if (pos > 0) {
-    _setRandomColor(getNumVal(&req, pos));
+  if (api.has(API_KEY_SR)) {
+    _setRandomColor(api.getNumber(API_KEY_SR));
   }
 
   //swap 2nd & 1st
-  pos = req.indexOf(F("SC"));
-  if (pos > 0) {
+  if (api.has(API_KEY_SC)) {
     byte temp;
     for (uint8_t i=0; i<4; i++)
     {
@@ -507,34 +461,28 @@ bool handleSet(AsyncWebServerRequest *request, const String& req, bool apply)
   // MDR DEBUG - TODO support macros to set color set here
 
   //set advanced overlay
-  pos = req.indexOf(F("OL="));
-  if (pos > 0) {
-    overlayCurrent = getNumVal(&req, pos);
+  if (api.has(API_KEY_OL)) {
+    overlayCurrent = api.getNumber(API_KEY_OL);
   }
 
   //apply macro (deprecated, added for compatibility with pre-0.11 automations)
-  pos = req.indexOf(F("&M="));
-  if (pos > 0) {
-    applyPreset(getNumVal(&req, pos) + 16);
+  if (api.has(API_KEY_M)) {
+    applyPreset(api.getNumber(API_KEY_M) + 16);
   }
 
   //toggle send UDP direct notifications
-  pos = req.indexOf(F("SN="));
-  if (pos > 0) notifyDirect = (req.charAt(pos+3) != '0');
+  if (api.has(API_KEY_SN)) notifyDirect = (api.getFirstChar(API_KEY_SN) != '0');
 
   //toggle receive UDP direct notifications
-  pos = req.indexOf(F("RN="));
-  if (pos > 0) receiveNotifications = (req.charAt(pos+3) != '0');
+  if (api.has(API_KEY_RN)) receiveNotifications = (api.getFirstChar(API_KEY_RN) != '0');
 
   //receive live data via UDP/Hyperion
-  pos = req.indexOf(F("RD="));
-  if (pos > 0) receiveDirect = (req.charAt(pos+3) != '0');
+  if (api.has(API_KEY_RD)) receiveDirect = (api.getFirstChar(API_KEY_RD) != '0');
 
   //main toggle on/off (parse before nightlight, #1214)
-  pos = req.indexOf(F("&T="));
-  if (pos > 0) {
+  if (api.has(API_KEY_T)) {
     nightlightActive = false; //always disable nightlight when toggling
-    switch (getNumVal(&req, pos))
+    switch (api.getNumber(API_KEY_T))
     {
       case 0: if (bri != 0){briLast = bri; bri = 0;} break; //off, only if it was previously on
       case 1: if (bri == 0) bri = briLast; break; //on, only if it was previously off
@@ -543,17 +491,15 @@ bool handleSet(AsyncWebServerRequest *request, const String& req, bool apply)
   }
 
   //toggle nightlight mode
-  bool aNlDef = false;
-  if (req.indexOf(F("&ND")) > 0) aNlDef = true;
-  pos = req.indexOf(F("NL="));
-  if (pos > 0)
+  bool aNlDef = api.has(API_KEY_ND);
+  if (api.has(API_KEY_NL))
   {
-    if (req.charAt(pos+3) == '0')
+    if (api.getFirstChar(API_KEY_NL) == '0')
     {
       nightlightActive = false;
     } else {
       nightlightActive = true;
-      if (!aNlDef) nightlightDelayMins = getNumVal(&req, pos);
+      if (!aNlDef) nightlightDelayMins = api.getNumber(API_KEY_NL);
       nightlightStartTime = millis();
     }
   } else if (aNlDef)
@@ -563,17 +509,15 @@ bool handleSet(AsyncWebServerRequest *request, const String& req, bool apply)
   }
 
   //set nightlight target brightness
-  pos = req.indexOf(F("NT="));
-  if (pos > 0) {
-    nightlightTargetBri = getNumVal(&req, pos);
+  if (api.has(API_KEY_NT)) {
+    nightlightTargetBri = api.getNumber(API_KEY_NT);
     nightlightActiveOld = false; //re-init
   }
 
   //toggle nightlight fade
-  pos = req.indexOf(F("NF="));
-  if (pos > 0)
+  if (api.has(API_KEY_NF))
   {
-    nightlightMode = getNumVal(&req, pos);
+    nightlightMode = api.getNumber(API_KEY_NF);
 
     nightlightActiveOld = false; //re-init
   }
@@ -581,72 +525,61 @@ bool handleSet(AsyncWebServerRequest *request, const String& req, bool apply)
 
   #if AUXPIN >= 0
   //toggle general purpose output
-  pos = req.indexOf(F("AX="));
-  if (pos > 0) {
-    auxTime = getNumVal(&req, pos);
+  if (api.has(API_KEY_AX)) {
+    auxTime = api.getNumber(API_KEY_AX);
     auxActive = true;
     if (auxTime == 0) auxActive = false;
   }
   #endif
 
-  pos = req.indexOf(F("TT="));
-  if (pos > 0) transitionDelay = getNumVal(&req, pos);
+  if (api.has(API_KEY_TT)) transitionDelay = api.getNumber(API_KEY_TT);
 
   //set time (unix timestamp)
-  pos = req.indexOf(F("ST="));
-  if (pos > 0) {
-    setTime(getNumVal(&req, pos));
+  if (api.has(API_KEY_ST)) {
+    setTime(api.getNumber(API_KEY_ST));
   }
 
   //set countdown goal (unix timestamp)
-  pos = req.indexOf(F("CT="));
-  if (pos > 0) {
-    countdownTime = getNumVal(&req, pos);
+  if (api.has(API_KEY_CT)) {
+    countdownTime = api.getNumber(API_KEY_CT);
     if (countdownTime - now() > 0) countdownOverTriggered = false;
   }
 
-  pos = req.indexOf(F("LO="));
-  if (pos > 0) {
-    realtimeOverride = getNumVal(&req, pos);
+  if (api.has(API_KEY_LO)) {
+    realtimeOverride = api.getNumber(API_KEY_LO);
     if (realtimeOverride > 2) realtimeOverride = REALTIME_OVERRIDE_ALWAYS;
   }
 
-  pos = req.indexOf(F("RB"));
-  if (pos > 0) doReboot = true;
+  if (api.has(API_KEY_RB)) doReboot = true;
 
   //cronixie
   #ifndef WLED_DISABLE_CRONIXIE
   //mode, 1 countdown
-  pos = req.indexOf(F("NM="));
-  if (pos > 0) countdownMode = (req.charAt(pos+3) != '0');
+  if (api.has(API_KEY_NM)) countdownMode = (api.getFirstChar(API_KEY_NM) != '0');
   
-  pos = req.indexOf(F("NB="));
-  if (pos > 0) //sets backlight
+  if (api.has(API_KEY_NB)) //sets backlight
   {
-    cronixieBacklight = (req.charAt(pos+3) != '0');
+    cronixieBacklight = (api.getFirstChar(API_KEY_NB) != '0');
     overlayRefreshedTime = 0;
   }
   #endif
 
-  pos = req.indexOf(F("U0=")); //user var 0
-  if (pos > 0) {
-    userVar0 = getNumVal(&req, pos);
+  if (api.has(API_KEY_U0)) { //user var 0
+    userVar0 = api.getNumber(API_KEY_U0);
   }
 
-  pos = req.indexOf(F("U1=")); //user var 1
-  if (pos > 0) {
-    userVar1 = getNumVal(&req, pos);
+  if (api.has(API_KEY_U1)) { //user var 1
+    userVar1 = api.getNumber(API_KEY_U1);
   }
   //you can add more if you need
 
   if (!apply) return true; //when called by JSON API, do not call colorUpdated() here
   
   //internal call, does not send XML response
-  pos = req.indexOf(F("IN"));
-  if (pos < 1) XML_response(request);
+  if (!api.has(API_KEY_IN)) XML_response(request);
 
-  pos = req.indexOf(F("&NN")); //do not send UDP notifications this time
-  colorUpdated((pos > 0) ? NOTIFIER_CALL_MODE_NO_NOTIFY : NOTIFIER_CALL_MODE_DIRECT_CHANGE);
+  //do not send UDP notifications this time
+  colorUpdated(api.has(API_KEY_NN) ? NOTIFIER_CALL_MODE_NO_NOTIFY : NOTIFIER_CALL_MODE_DIRECT_CHANGE);
 
   return true;
 }
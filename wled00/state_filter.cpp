@@ -0,0 +1,231 @@
+#include "wled.h"
+
+namespace
+{
+    #define SHAPE_BIT(shape) (1 << (shape))
+
+    const uint8_t ALL_SHAPES = SHAPE_BIT(STATE_REQUEST_NUM_SHAPES) - 1;
+    const uint8_t LIGHT_SHAPES = SHAPE_BIT(STATE_REQUEST_BRIGHTNESS) | SHAPE_BIT(STATE_REQUEST_POWER);
+
+    struct FilterKey
+    {
+        const char* name;
+        uint8_t     shapes;
+    };
+
+    // The top level keys each shape keeps, anything else makes a request a full one
+    const FilterKey FILTER_KEYS[] =
+    {
+        { "bri",           LIGHT_SHAPES },
+        { "on",            SHAPE_BIT(STATE_REQUEST_POWER) },
+        { "transition",    LIGHT_SHAPES | SHAPE_BIT(STATE_REQUEST_PRESET) },
+        { "tt",            LIGHT_SHAPES | SHAPE_BIT(STATE_REQUEST_PRESET) },
+        { "ps",            SHAPE_BIT(STATE_REQUEST_PRESET) },
+        { "object_action", SHAPE_BIT(STATE_REQUEST_OBJECT_ACTION) },
+        { "v",             ALL_SHAPES }
+    };
+    const uint8_t NUM_FILTER_KEYS = sizeof(FILTER_KEYS) / sizeof(FILTER_KEYS[0]);
+
+    const char* SHAPE_NAMES[STATE_REQUEST_NUM_SHAPES] = { "bri", "on", "ps", "object_action" };
+    const char* FULL_ELEMENT = "full";
+    const char* FALLBACK_ELEMENT = "fallback";
+
+    bool isWhitespace(char character)
+    {
+        return character == ' ' || character == '\t' || character == '\r' || character == '\n';
+    }
+
+    // The shapes a top level key belongs to, an object action has to be a single one
+    uint8_t getKeyShapes(const char* key, size_t keyLength, char valueStart)
+    {
+        for (const FilterKey& filterKey : FILTER_KEYS)
+        {
+            if (strlen(filterKey.name) == keyLength && 0 == strncmp(filterKey.name, key, keyLength))
+            {
+                if (filterKey.shapes == SHAPE_BIT(STATE_REQUEST_OBJECT_ACTION) && valueStart != '{')
+                {
+                    return 0;
+                }
+                return filterKey.shapes;
+            }
+        }
+
+        return 0;
+    }
+}
+
+/*
+** ============================================================================
+** Returns the one state request filter
+** ============================================================================
+*/
+StateRequestFilter& StateRequestFilter::get()
+{
+    static StateRequestFilter sStateRequestFilter;
+    return sStateRequestFilter;
+}
+
+/*
+** ============================================================================
+** Constructor
+** ============================================================================
+*/
+StateRequestFilter::StateRequestFilter()
+    : mNumFull( 0 )
+    , mNumFallbacks( 0 )
+{
+    memset(mShapeCounts, 0, sizeof(mShapeCounts));
+}
+
+/*
+** ============================================================================
+** Finds the shape of a request by scanning its top level keys.  Strings are
+** skipped with their escapes and nesting is only counted, no document is
+** built.  Malformed input is a full request so that the full parse reports
+** the error.
+** ============================================================================
+*/
+StateRequestShape StateRequestFilter::classify(const char* json, size_t length)
+{
+    size_t position = 0;
+    while (position < length && isWhitespace(json[position]))
+    {
+        ++position;
+    }
+
+    if (position >= length || json[position] != '{')
+    {
+        return STATE_REQUEST_FULL;
+    }
+
+    uint8_t shapes = ALL_SHAPES;
+    uint8_t depth = 0;
+    bool expectKey = false;
+    while (position < length && json[position] != 0 && shapes != 0)
+    {
+        char character = json[position];
+        if (character == '"')
+        {
+            size_t start = ++position;
+            while (position < length && json[position] != 0 && json[position] != '"')
+            {
+                if (json[position] == '\\')
+                {
+                    // An escaped key never matches, the string is only skipped
+                    ++position;
+                }
+                ++position;
+            }
+
+            if (position >= length || json[position] != '"')
+            {
+                return STATE_REQUEST_FULL;
+            }
+
+            if (depth == 1 && expectKey)
+            {
+                // Look past the colon for the start of the value
+                size_t valuePosition = position + 1;
+                while (valuePosition < length && (isWhitespace(json[valuePosition]) || json[valuePosition] == ':'))
+                {
+                    ++valuePosition;
+                }
+
+                char valueStart = (valuePosition < length) ? json[valuePosition] : 0;
+                shapes &= getKeyShapes(json + start, position - start, valueStart);
+                expectKey = false;
+            }
+        }
+        else if (character == '{' || character == '[')
+        {
+            ++depth;
+            expectKey = (depth == 1);
+        }
+        else if (character == '}' || character == ']')
+        {
+            if (depth == 0)
+            {
+                return STATE_REQUEST_FULL;
+            }
+            --depth;
+        }
+        else if (character == ',' && depth == 1)
+        {
+            expectKey = true;
+        }
+
+        ++position;
+    }
+
+    if (shapes == 0 || depth != 0)
+    {
+        return STATE_REQUEST_FULL;
+    }
+
+    // The first matching shape is the smallest one
+    for (uint8_t shape = 0; shape < STATE_REQUEST_NUM_SHAPES; ++shape)
+    {
+        if (shapes & SHAPE_BIT(shape))
+        {
+            return (StateRequestShape)shape;
+        }
+    }
+
+    return STATE_REQUEST_FULL;
+}
+
+/*
+** ============================================================================
+** Parses a request of a known shape into a small document, keeping only the
+** keys of the shape, and applies it.  The input is read in copy mode so a
+** request that does not fit can still be parsed in full by the caller.
+**
+**  returns false if the caller has to parse and apply the request itself
+** ============================================================================
+*/
+bool StateRequestFilter::tryDeserializeState(const char* json, size_t length, bool& verboseResponse)
+{
+    StateRequestShape shape = classify(json, length);
+    if (shape == STATE_REQUEST_FULL)
+    {
+        ++mNumFull;
+        return false;
+    }
+
+    StaticJsonDocument<JSON_OBJECT_SIZE(NUM_FILTER_KEYS)> filter;
+    for (const FilterKey& filterKey : FILTER_KEYS)
+    {
+        if (filterKey.shapes & SHAPE_BIT(shape))
+        {
+            filter[filterKey.name] = true;
+        }
+    }
+
+    StaticJsonDocument<DOCUMENT_SIZE> document;
+    DeserializationError error = deserializeJson(document, json, length, DeserializationOption::Filter(filter));
+    JsonObject root = document.as<JsonObject>();
+    if (error || root.isNull())
+    {
+        ++mNumFallbacks;
+        return false;
+    }
+
+    ++mShapeCounts[shape];
+    verboseResponse = deserializeState(root);
+    return true;
+}
+
+/*
+** ============================================================================
+** Writes how many requests took each path
+** ============================================================================
+*/
+void StateRequestFilter::serializeToJson(JsonObject root) const
+{
+    for (uint8_t shape = 0; shape < STATE_REQUEST_NUM_SHAPES; ++shape)
+    {
+        root[SHAPE_NAMES[shape]] = mShapeCounts[shape];
+    }
+    root[FULL_ELEMENT] = mNumFull;
+    root[FALLBACK_ELEMENT] = mNumFallbacks;
+}
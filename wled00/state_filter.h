@@ -0,0 +1,64 @@
+#ifndef STATE_FILTER_H
+#define STATE_FILTER_H
+
+#include "Arduino.h"
+
+/*
+** The request shapes that are parsed into a small document.  A request has a
+** shape when each of its top level keys belongs to it.
+*/
+enum StateRequestShape : uint8_t
+{
+    STATE_REQUEST_BRIGHTNESS = 0,   // {"bri":128} from the slider
+    STATE_REQUEST_POWER,            // {"on":true} or {"on":"t"} with brightness
+    STATE_REQUEST_PRESET,           // {"ps":3}
+    STATE_REQUEST_OBJECT_ACTION,    // {"object_action":{...}} with one action
+    STATE_REQUEST_NUM_SHAPES,
+    STATE_REQUEST_FULL = STATE_REQUEST_NUM_SHAPES
+};
+
+/*
+**-----------------------------------------------------------------------------
+** Lets the frequent, small state requests skip the JSON_BUFFER_SIZE document
+** from the pool.  classify() scans the top level keys of the raw request
+** without building a document, and a request of one of the known shapes is
+** parsed into a small document on the stack through an ArduinoJson filter
+** that keeps only the keys of that shape.
+**
+** Anything else (or a request that does not fit the small document) is left
+** to the caller to parse in full as before, the input is not modified.
+**-----------------------------------------------------------------------------
+*/
+class StateRequestFilter
+{
+    public:
+#ifdef ESP8266
+        static const uint16_t DOCUMENT_SIZE = 512;
+#else
+        static const uint16_t DOCUMENT_SIZE = 1024;
+#endif
+
+        static StateRequestFilter& get();
+
+        // Returns the shape of the request, STATE_REQUEST_FULL if it has none
+        static StateRequestShape classify(const char* json, size_t length);
+
+        // Applies the request with deserializeState if it has a shape
+        //  returns false if the caller has to parse and apply it in full
+        bool tryDeserializeState(const char* json, size_t length, bool& verboseResponse);
+
+        void serializeToJson(JsonObject root) const;
+
+    private:
+        StateRequestFilter();
+        StateRequestFilter(const StateRequestFilter&);
+        StateRequestFilter& operator=(const StateRequestFilter&);
+
+    private:
+        // Statistics
+        uint32_t    mShapeCounts[STATE_REQUEST_NUM_SHAPES];
+        uint32_t    mNumFull;
+        uint32_t    mNumFallbacks;
+};
+
+#endif
@@ -0,0 +1,206 @@
+#include "wled.h"
+
+namespace
+{
+    const char* SENT_ELEMENT = "sent";
+    const char* GZIPPED_ELEMENT = "gzipped";
+    const char* NOT_MODIFIED_ELEMENT = "not_modified";
+
+    // Long enough for a content hash or a size and time pair
+    const uint8_t MAX_TAG_LENGTH = 20;
+}
+
+/*
+** ============================================================================
+** Returns the one static asset server
+** ============================================================================
+*/
+StaticAssetServer& StaticAssetServer::get()
+{
+    static StaticAssetServer sStaticAssetServer;
+    return sStaticAssetServer;
+}
+
+/*
+** ============================================================================
+** Constructor
+** ============================================================================
+*/
+StaticAssetServer::StaticAssetServer()
+    : mNumSent( 0 )
+    , mNumGzipped( 0 )
+    , mNumNotModified( 0 )
+{
+}
+
+/*
+** ============================================================================
+** Sends an asset from flash with its content hash as the ETag, or just a 304
+** if the client has it already
+** ============================================================================
+*/
+void StaticAssetServer::sendProgmem(AsyncWebServerRequest* request, const char* contentType, const uint8_t* content, size_t length, const char* etag, bool gzipped)
+{
+    char tag[MAX_TAG_LENGTH];
+    strncpy_P(tag, etag, sizeof(tag) - 1);
+    tag[sizeof(tag) - 1] = 0;
+
+    String quotedTag = String('"') + tag + '"';
+    if (sendNotModified(request, quotedTag))
+    {
+        return;
+    }
+
+    AsyncWebServerResponse* response = request->beginResponse_P(200, contentType, content, length);
+    if (gzipped)
+    {
+        response->addHeader(F("Content-Encoding"), "gzip");
+        ++mNumGzipped;
+    }
+    addCacheHeaders(request, response, tag, quotedTag);
+    request->send(response);
+    ++mNumSent;
+}
+
+/*
+** ============================================================================
+** Sends a file, or its precompressed .gz, from the file system.  Only a file
+** system that keeps the time of the last write gives files an ETag, without
+** it a file of the same size could not be told from the one the client has.
+** Data files (.json) are rewritten all the time and never get one.
+**
+**  returns false if there is no such file
+** ============================================================================
+*/
+bool StaticAssetServer::sendFile(AsyncWebServerRequest* request, const String& path, const String& contentType)
+{
+    String gzipPath = path + ".gz";
+    bool hasPlain = WLED_FS.exists(path);
+    bool hasGzip = WLED_FS.exists(gzipPath);
+    if (!hasPlain && !hasGzip)
+    {
+        return false;
+    }
+
+    bool gzipped = hasGzip && (!hasPlain || acceptsGzip(request));
+    File file = WLED_FS.open(gzipped ? gzipPath : path, "r");
+    if (!file)
+    {
+        return false;
+    }
+
+    char tag[MAX_TAG_LENGTH] = "";
+    time_t lastWrite = file.getLastWrite();
+    if (0 != lastWrite && !path.endsWith(".json"))
+    {
+        snprintf(tag, sizeof(tag), "%x-%x", (unsigned)file.size(), (unsigned)lastWrite);
+    }
+
+    String weakTag = String(F("W/\"")) + tag + '"';
+    if (0 != tag[0] && sendNotModified(request, weakTag))
+    {
+        file.close();
+        return true;
+    }
+
+    // A .gz file sent under the plain path gets Content-Encoding: gzip from AsyncFileResponse
+    AsyncWebServerResponse* response = request->beginResponse(file, path, contentType);
+    if (hasGzip)
+    {
+        response->addHeader(F("Vary"), F("Accept-Encoding"));
+    }
+    if (0 != tag[0])
+    {
+        addCacheHeaders(request, response, tag, weakTag);
+    }
+    request->send(response);
+
+    ++mNumSent;
+    if (gzipped)
+    {
+        ++mNumGzipped;
+    }
+    return true;
+}
+
+/*
+** ============================================================================
+** Writes how many assets were sent and how many were answered with 304
+** ============================================================================
+*/
+void StaticAssetServer::serializeToJson(JsonObject root) const
+{
+    root[SENT_ELEMENT] = mNumSent;
+    root[GZIPPED_ELEMENT] = mNumGzipped;
+    root[NOT_MODIFIED_ELEMENT] = mNumNotModified;
+}
+
+/*
+** ============================================================================
+** Returns false only if the client sent an Accept-Encoding without gzip
+** ============================================================================
+*/
+bool StaticAssetServer::acceptsGzip(AsyncWebServerRequest* request)
+{
+    if (!request->hasHeader(F("Accept-Encoding")))
+    {
+        return true;
+    }
+
+    return request->getHeader(F("Accept-Encoding"))->value().indexOf(F("gzip")) >= 0;
+}
+
+/*
+** ============================================================================
+** Returns true if the request's If-None-Match header contains the given ETag
+** ============================================================================
+*/
+bool StaticAssetServer::isEtagMatch(AsyncWebServerRequest* request, const String& etag)
+{
+    if (!request->hasHeader(F("If-None-Match")))
+    {
+        return false;
+    }
+
+    return request->getHeader(F("If-None-Match"))->value().indexOf(etag) >= 0;
+}
+
+/*
+** ============================================================================
+** Adds the ETag and Cache-Control headers.  A URL versioned with ?v=tag can
+** never have other content, so the browser need not ask again.
+** ============================================================================
+*/
+void StaticAssetServer::addCacheHeaders(AsyncWebServerRequest* request, AsyncWebServerResponse* response, const String& tag, const String& etag)
+{
+    response->addHeader(F("ETag"), etag);
+    if (request->hasArg("v") && request->arg("v") == tag)
+    {
+        response->addHeader(F("Cache-Control"), F("public, max-age=31536000, immutable"));
+    }
+    else
+    {
+        response->addHeader(F("Cache-Control"), F("no-cache"));
+    }
+}
+
+/*
+** ============================================================================
+** Answers with 304 if the client already has the asset with the given ETag
+**
+**  returns true if the request was answered
+** ============================================================================
+*/
+bool StaticAssetServer::sendNotModified(AsyncWebServerRequest* request, const String& etag)
+{
+    if (!isEtagMatch(request, etag))
+    {
+        return false;
+    }
+
+    ++mNumNotModified;
+    AsyncWebServerResponse* response = request->beginResponse(304);
+    response->addHeader(F("ETag"), etag);
+    request->send(response);
+    return true;
+}
@@ -0,0 +1,56 @@
+#ifndef STATIC_ASSETS_H
+#define STATIC_ASSETS_H
+
+#include "Arduino.h"
+
+/*
+**-----------------------------------------------------------------------------
+** Serves the web UI assets, from flash (the arrays made by tools/cdata.js) or
+** from WLED_FS, so that a browser that already has an asset does not download
+** it again.
+**
+** Flash assets get the content hash written by cdata.js as their ETag, which
+** only changes with the firmware.  Files get a weak ETag made from their size
+** and last write time (none on a file system that keeps no time, nor for the
+** .json data files).  A request whose If-None-Match matches is answered with
+** 304 and no body.  Assets are sent with "no-cache", the browser revalidates
+** them, unless the URL carries the asset's ETag as ?v=, then they are
+** immutable for a year.
+**
+** A file with a precompressed path.gz next to it (or instead of it) is sent
+** as the .gz with Content-Encoding: gzip, unless the client did not list gzip
+** in Accept-Encoding and the uncompressed file exists.
+**-----------------------------------------------------------------------------
+*/
+class StaticAssetServer
+{
+    public:
+        static StaticAssetServer& get();
+
+        // Sends an asset from flash, etag is the PROGMEM hash from cdata.js
+        void sendProgmem(AsyncWebServerRequest* request, const char* contentType, const uint8_t* content, size_t length, const char* etag, bool gzipped);
+
+        // Sends path (or path.gz) from the file system, returns false if neither exists
+        bool sendFile(AsyncWebServerRequest* request, const String& path, const String& contentType);
+
+        void serializeToJson(JsonObject root) const;
+
+    private:
+        StaticAssetServer();
+        StaticAssetServer(const StaticAssetServer&);
+        StaticAssetServer& operator=(const StaticAssetServer&);
+
+        static bool acceptsGzip(AsyncWebServerRequest* request);
+        static bool isEtagMatch(AsyncWebServerRequest* request, const String& etag);
+        static void addCacheHeaders(AsyncWebServerRequest* request, AsyncWebServerResponse* response, const String& tag, const String& etag);
+
+        bool sendNotModified(AsyncWebServerRequest* request, const String& etag);
+
+    private:
+        // Statistics
+        uint32_t    mNumSent;
+        uint32_t    mNumGzipped;
+        uint32_t    mNumNotModified;
+};
+
+#endif
@@ -0,0 +1,150 @@
+#include "wled.h"
+
+namespace
+{
+    const char* FREE_ELEMENT = "free";
+    const char* MAX_BLOCK_ELEMENT = "max_block";
+    const char* FRAGMENTATION_ELEMENT = "frag";
+    const char* STACK_FREE_ELEMENT = "stack_free";
+    const char* MIN_FREE_ELEMENT = "min_free";
+    const char* MIN_MAX_BLOCK_ELEMENT = "min_max_block";
+    const char* MAX_FRAGMENTATION_ELEMENT = "max_frag";
+
+#ifdef WLED_DEBUG
+    // Indexed by HeapSite
+    const char* SITE_NAMES[HEAP_NUM_SITES] = {
+        "json_document",
+        "object_map",
+        "effect_list",
+    };
+
+    const char* SITES_ELEMENT = "sites";
+#endif
+}
+
+/*
+** ============================================================================
+** Returns the one heap telemetry
+** ============================================================================
+*/
+HeapTelemetry& HeapTelemetry::get()
+{
+    static HeapTelemetry sHeapTelemetry;
+    return sHeapTelemetry;
+}
+
+/*
+** ============================================================================
+** Constructor
+** ============================================================================
+*/
+HeapTelemetry::HeapTelemetry()
+    : mLastSampleTimestamp( 0 )
+    , mFreeHeap( 0 )
+    , mLargestFreeBlock( 0 )
+    , mFragmentation( 0 )
+    , mStackHighWater( 0 )
+    , mMinFreeHeap( UINT32_MAX )
+    , mMinLargestFreeBlock( UINT32_MAX )
+    , mMaxFragmentation( 0 )
+{
+    memset(mSiteAllocations, 0, sizeof(mSiteAllocations));
+}
+
+/*
+** ============================================================================
+** Takes a new sample once the sample interval has passed.  Must be called from
+** the loop task so the stack that is measured is the one of the loop.
+** ============================================================================
+*/
+void HeapTelemetry::update(uint32_t currentMillis)
+{
+    // The first call always samples
+    if (0 != mFreeHeap && currentMillis - mLastSampleTimestamp < SAMPLE_INTERVAL_MS)
+    {
+        return;
+    }
+
+    mLastSampleTimestamp = currentMillis;
+    sample();
+}
+
+/*
+** ============================================================================
+** Reads the current heap and stack usage
+** ============================================================================
+*/
+void HeapTelemetry::sample()
+{
+    mFreeHeap = ESP.getFreeHeap();
+
+#ifdef ARDUINO_ARCH_ESP32
+    mLargestFreeBlock = ESP.getMaxAllocHeap();
+    mFragmentation = (mFreeHeap > 0) ? 100 - (uint8_t)((uint64_t)mLargestFreeBlock * 100 / mFreeHeap) : 0;
+    // Least amount of stack (bytes) the loop task had left since it started
+    mStackHighWater = uxTaskGetStackHighWaterMark(NULL);
+#else
+    mLargestFreeBlock = ESP.getMaxFreeBlockSize();
+    mFragmentation = ESP.getHeapFragmentation();
+    // The cont stack is painted at boot so this is the least amount that was ever left
+    mStackHighWater = ESP.getFreeContStack();
+#endif
+
+    if (mFreeHeap < mMinFreeHeap)
+    {
+        mMinFreeHeap = mFreeHeap;
+    }
+
+    if (mLargestFreeBlock < mMinLargestFreeBlock)
+    {
+        mMinLargestFreeBlock = mLargestFreeBlock;
+    }
+
+    if (mFragmentation > mMaxFragmentation)
+    {
+        mMaxFragmentation = mFragmentation;
+    }
+}
+
+/*
+** ============================================================================
+** Counts allocations made by the given call site
+**
+**  param   site - HeapSite making the allocations
+**  param   numAllocations - number of separate blocks allocated
+** ============================================================================
+*/
+void HeapTelemetry::countAllocations(uint8_t site, uint32_t numAllocations)
+{
+    if (site >= HEAP_NUM_SITES)
+    {
+        return;
+    }
+
+    mSiteAllocations[site] += numAllocations;
+}
+
+/*
+** ============================================================================
+** Writes the last sample, the worst values since boot and (when counted) the
+** allocations of every call site
+** ============================================================================
+*/
+void HeapTelemetry::serializeToJson(JsonObject root) const
+{
+    root[FREE_ELEMENT] = mFreeHeap;
+    root[MAX_BLOCK_ELEMENT] = mLargestFreeBlock;
+    root[FRAGMENTATION_ELEMENT] = mFragmentation;
+    root[STACK_FREE_ELEMENT] = mStackHighWater;
+    root[MIN_FREE_ELEMENT] = mMinFreeHeap;
+    root[MIN_MAX_BLOCK_ELEMENT] = mMinLargestFreeBlock;
+    root[MAX_FRAGMENTATION_ELEMENT] = mMaxFragmentation;
+
+#ifdef WLED_DEBUG
+    JsonObject sites = root.createNestedObject(SITES_ELEMENT);
+    for (uint8_t site = 0; site < HEAP_NUM_SITES; ++site)
+    {
+        sites[SITE_NAMES[site]] = mSiteAllocations[site];
+    }
+#endif
+}
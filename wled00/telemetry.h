@@ -0,0 +1,85 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include "Arduino.h"
+
+/*
+** Call sites that allocate on the heap while the node is running.  Only
+** counted in WLED_DEBUG builds, see HEAP_COUNT_ALLOCATIONS.  New sites are added
+** before HEAP_NUM_SITES and given a name in telemetry.cpp.
+**
+** HEAP_SITE_JSON_DOCUMENT counts the JSON documents that are not borrowed from
+** the pool (transient documents).
+*/
+enum HeapSite : uint8_t
+{
+    HEAP_SITE_JSON_DOCUMENT = 0,
+    HEAP_SITE_OBJECT_MAP,
+    HEAP_SITE_EFFECT_LIST,
+    HEAP_NUM_SITES
+};
+
+/*
+**-----------------------------------------------------------------------------
+** Samples the free heap, the largest free block and the stack of the loop
+** task once a second and keeps the lowest values seen since boot.  Heap
+** fragmentation is the part of the free heap that is not in the largest block,
+** so a node with plenty of free heap but a high fragmentation still fails the
+** next JSON_BUFFER_SIZE allocation.
+**
+** The samples are reported in /json/perf ("heap") and, when built with
+** WLED_ENABLE_MQTT_TELEMETRY, published to <device topic>/telemetry.
+**
+** In WLED_DEBUG builds the number of allocations is also counted per call
+** site, where the allocation is made, so the site that churns the heap can be
+** found.  Only the count is kept, the size of a container node is up to the
+** standard library and a guess would be worse than nothing.
+**-----------------------------------------------------------------------------
+*/
+class HeapTelemetry
+{
+    public:
+        static const uint16_t SAMPLE_INTERVAL_MS = 1000;
+
+        static HeapTelemetry& get();
+
+        void update(uint32_t currentMillis);
+        void sample();
+
+        void countAllocations(uint8_t site, uint32_t numAllocations);
+
+        void serializeToJson(JsonObject root) const;
+
+        uint32_t getFreeHeap() const { return mFreeHeap; }
+        uint32_t getLargestFreeBlock() const { return mLargestFreeBlock; }
+        uint8_t getFragmentation() const { return mFragmentation; }
+        uint32_t getStackHighWater() const { return mStackHighWater; }
+
+    private:
+        HeapTelemetry();
+        HeapTelemetry(const HeapTelemetry&);
+        HeapTelemetry& operator=(const HeapTelemetry&);
+
+    private:
+        uint32_t        mLastSampleTimestamp;
+
+        uint32_t        mFreeHeap;
+        uint32_t        mLargestFreeBlock;
+        uint8_t         mFragmentation;
+        uint32_t        mStackHighWater;
+
+        uint32_t        mMinFreeHeap;
+        uint32_t        mMinLargestFreeBlock;
+        uint8_t         mMaxFragmentation;
+
+        uint32_t        mSiteAllocations[HEAP_NUM_SITES];
+};
+
+#ifdef WLED_DEBUG
+  #define HEAP_COUNT_ALLOCATIONS(site, numAllocations) HeapTelemetry::get().countAllocations(site, numAllocations)
+#else
+  #define HEAP_COUNT_ALLOCATIONS(site, numAllocations)
+#endif
+#define HEAP_COUNT_ALLOCATION(site) HEAP_COUNT_ALLOCATIONS(site, 1)
+
+#endif
@@ -6,6 +6,10 @@
  * Main WLED class implementation. Mostly initialization and connection logic
  */
 
+// how long after the interfaces are up the first of the deferred services is started
+#define DEFERRED_SERVICES_DELAY 1000
+#define DEFERRED_SERVICES_STEPS 5
+
 WLED::WLED()
 {
 }
@@ -107,25 +111,27 @@ void WiFiEvent(WiFiEvent_t event)
 
 void WLED::loop()
 {
-  handleIR();        // 2nd call to function needed for ESP32 to return valid results -- should be good for ESP8266, too
-  handleConnection();
-  handleSerial();
-  handleNotifications();
-  handleTransitions();
+  PROFILE_SCOPE(PROFILE_LOOP);
+
+  PROFILE_CALL(PROFILE_IR, handleIR());        // 2nd call to function needed for ESP32 to return valid results -- should be good for ESP8266, too
+  PROFILE_CALL(PROFILE_CONNECTION, handleConnection());
+  PROFILE_CALL(PROFILE_DEFERRED_SERVICES, handleDeferredServices());
+  PROFILE_CALL(PROFILE_SERIAL, handleSerial());
+  PROFILE_CALL(PROFILE_NOTIFICATIONS, handleNotifications());
+  PROFILE_CALL(PROFILE_TRANSITIONS, handleTransitions());
 #ifdef WLED_ENABLE_DMX
-  handleDMX();
+  PROFILE_CALL(PROFILE_DMX, handleDMX());
 #endif
-  userLoop();
-  usermods.loop();
+  PROFILE_CALL(PROFILE_USERMODS, userLoop(); usermods.loop());
 
   yield();
-  handleIO();
-  handleIR();
-  handleNetworkTime();
-  handleAlexa();
+  PROFILE_CALL(PROFILE_IO, handleIO());
+  PROFILE_CALL(PROFILE_IR, handleIR());
+  PROFILE_CALL(PROFILE_NETWORK_TIME, handleNetworkTime());
+  PROFILE_CALL(PROFILE_ALEXA, handleAlexa());
 
 #ifdef ENABLE_CLOCK_OVERLAY
-  handleOverlays();
+  PROFILE_CALL(PROFILE_OVERLAYS, handleOverlays());
 #endif // ENABLE_CLOCK_OVERLAY  
   yield();
 #ifdef WLED_USE_ANALOG_LEDS
@@ -147,12 +153,14 @@ void WLED::loop()
     if (WLED_CONNECTED && aOtaEnabled)
       ArduinoOTA.handle();
 #endif
-    handleNightlight();
-    handlePlaylist();
+    PROFILE_CALL(PROFILE_NIGHTLIGHT, handleNightlight());
+    PROFILE_CALL(PROFILE_PLAYLIST, handlePlaylist());
+    PROFILE_CALL(PROFILE_PRESET_COMPACTION, PresetCompactor::get().handle());
+    PROFILE_CALL(PROFILE_PRESET_PREFETCH, PresetCache::get().handle());
     yield();
 
-    handleHue();
-    handleBlynk();
+    PROFILE_CALL(PROFILE_HUE, handleHue());
+    PROFILE_CALL(PROFILE_BLYNK, handleBlynk());
 
     /*if (presetToApply) {
       applyPreset(presetToApply);
@@ -163,7 +171,7 @@ void WLED::loop()
 
     if (!offMode)
     {
-      lightDisplay.runEffect();
+      PROFILE_CALL(PROFILE_LIGHT_DISPLAY, lightDisplay.runEffect());
     }
 #ifdef ESP8266
     else if (!noWifiSleep)
@@ -176,10 +184,12 @@ void WLED::loop()
 #endif
   if (millis() - lastMqttReconnectAttempt > 30000) {
     if (lastMqttReconnectAttempt > millis()) rolloverMillis++; //millis() rolls over every 50 days
-    initMqtt();
+    PROFILE_CALL(PROFILE_MQTT, initMqtt());
   }
   yield();
-  handleWs();
+  PROFILE_CALL(PROFILE_WS, handleWs());
+  HeapTelemetry::get().update(millis());
+  publishMqttTelemetry();
   handleStatusLED();
 
 // DEBUG serial logging
@@ -208,6 +218,7 @@ void WLED::loop()
 
 void WLED::setup()
 {
+  BootProfiler::get().mark(BOOT_STAGE_SETUP_START);
   Serial.begin(115200);
   Serial.setTimeout(50);
   DEBUG_PRINTLN();
@@ -226,6 +237,7 @@ void WLED::setup()
   int heapPreAlloc = ESP.getFreeHeap();
   DEBUG_PRINT("heap ");
   DEBUG_PRINTLN(ESP.getFreeHeap());
+  JsonDocumentPool::get().begin(); // take the JSON arenas while the heap is still in one piece
   registerUsermods();
 
   //strip.init(EEPROM.read(372), ledCount, EEPROM.read(2204));        // init LEDs quickly
@@ -247,7 +259,10 @@ void WLED::setup()
     errorFlag = ERR_FS_BEGIN;
   } else deEEP();
   updateFSInfo();
+  BootProfiler::get().mark(BOOT_STAGE_FS_MOUNT);
   deserializeConfig();
+  ColorSetStore::get().load();
+  BootProfiler::get().mark(BOOT_STAGE_CONFIG);
 
 #if STATUSLED && STATUSLED != LEDPIN
   pinMode(STATUSLED, OUTPUT);
@@ -256,8 +271,15 @@ void WLED::setup()
   //DEBUG_PRINTLN(F("Load EEPROM"));
   //loadSettingsFromEEPROM();
   beginStrip();
+
+  // Show the saved display before anything else is set up, so the LEDs are not dark
+  // (or showing whatever they powered up with) while usermods, WiFi and the services start
+  lightDisplay.runEffect();
+  BootProfiler::get().mark(BOOT_STAGE_FIRST_LIGHT);
+
   userSetup();
   usermods.setup();
+  BootProfiler::get().mark(BOOT_STAGE_USERMODS);
   if (strcmp(clientSSID, DEFAULT_CLIENT_SSID) == 0)
     showWelcomePage = true;
   WiFi.persistent(false);
@@ -283,8 +305,6 @@ void WLED::setup()
     sprintf(mqttClientID + 5, "%*s", 6, escapedMac.c_str() + 6);
   }
 
-  lightDisplay.runEffect();
-
 #ifndef WLED_DISABLE_OTA
   if (aOtaEnabled) {
     ArduinoOTA.onStart([]() {
@@ -302,6 +322,7 @@ void WLED::setup()
 #endif
   // HTTP server page init
   initServer();
+  BootProfiler::get().mark(BOOT_STAGE_SETUP_DONE);
 }
 
 void WLED::beginStrip()
@@ -320,6 +341,7 @@ void WLED::beginStrip()
   }
 
   lightDisplay.init(useRGBW, ledCount);
+  BootProfiler::get().mark(BOOT_STAGE_LIGHT_DISPLAY);
 
 #if defined(BTNPIN) && BTNPIN > -1
   pinManager.allocatePin(BTNPIN, false);
@@ -469,10 +491,6 @@ void WLED::initInterfaces()
     hueIP[2] = Network.localIP()[2];
   }
 
-  // init Alexa hue emulation
-  if (alexaEnabled)
-    alexaInit();
-
 #ifndef WLED_DISABLE_OTA
   if (aOtaEnabled)
     ArduinoOTA.begin();
@@ -503,17 +521,46 @@ void WLED::initInterfaces()
     if (udpConnected && udpPort2 != udpPort && udpPort2 != udpRgbPort)
       udp2Connected = notifier2Udp.begin(udpPort2);
   }
-  if (ntpEnabled)
-    ntpConnected = ntpUdp.begin(ntpLocalPort);
-
-  initBlynk(blynkApiKey);
   e131.begin(e131Multicast, e131Port, e131Universe, E131_MAX_UNIVERSE_COUNT);
-  reconnectHue();
-  initMqtt();
+
+  // Alexa, NTP, Blynk, Hue and MQTT are started later by handleDeferredServices
+  deferredServiceStep = 0;
+  interfacesInitedTime = millis();
   interfacesInited = true;
   wasConnected = true;
 }
 
+// Starts the services that are not needed to control the LEDs over HTTP and UDP, one per
+// loop and only a while after the interfaces came up, so connecting does not hold up
+// the frames for the time all of them take to start
+void WLED::handleDeferredServices()
+{
+  if (!interfacesInited || deferredServiceStep >= DEFERRED_SERVICES_STEPS || millis() - interfacesInitedTime < DEFERRED_SERVICES_DELAY)
+    return;
+
+  switch (deferredServiceStep++)
+  {
+    case 0: // init Alexa hue emulation
+      if (alexaEnabled)
+        alexaInit();
+      break;
+    case 1:
+      if (ntpEnabled)
+        ntpConnected = ntpUdp.begin(ntpLocalPort);
+      break;
+    case 2:
+      initBlynk(blynkApiKey);
+      break;
+    case 3:
+      reconnectHue();
+      break;
+    case 4:
+      initMqtt();
+      BootProfiler::get().mark(BOOT_STAGE_SERVICES);
+      break;
+  }
+}
+
 byte stacO = 0;
 uint32_t lastHeap;
 unsigned long heapTime = 0;
@@ -580,7 +627,9 @@ void WLED::handleConnection()
     DEBUG_PRINTLN("");
     DEBUG_PRINT(F("Connected! IP address: "));
     DEBUG_PRINTLN(Network.localIP());
+    BootProfiler::get().mark(BOOT_STAGE_CONNECTED);
     initInterfaces();
+    BootProfiler::get().mark(BOOT_STAGE_INTERFACES);
     userConnected();
     usermods.connected();
 
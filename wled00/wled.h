@@ -34,6 +34,7 @@
 #define WLED_ENABLE_ADALIGHT       // saves 500b only
 //#define WLED_ENABLE_DMX          // uses 3.5kb (use LEDPIN other than 2)
 //#define WLED_ENABLE_LOXONE       // uses 1.2kb
+//#define WLED_ENABLE_MQTT_TELEMETRY // publishes heap telemetry to <device topic>/telemetry every minute
 #ifndef WLED_DISABLE_WEBSOCKETS
   #define WLED_ENABLE_WEBSOCKETS
 #endif
@@ -112,6 +113,21 @@
 #include "html_settings.h"
 #include "html_other.h"
 #include "FX.h"
+#include "colorlist.h"
+#include "profiler.h"
+#include "telemetry.h"
+#include "json_pool.h"
+#include "json_cache.h"
+#include "ws_delta.h"
+#include "live_stream.h"
+#include "ws_assembler.h"
+#include "api_request.h"
+#include "state_filter.h"
+#include "static_assets.h"
+#include "preset_index.h"
+#include "preset_compactor.h"
+#include "preset_cache.h"
+#include "boot_profiler.h"
 #include "ir_codes.h"
 #include "const.h"
 
@@ -339,6 +355,8 @@ WLED_GLOBAL bool forceReconnect _INIT(false);
 WLED_GLOBAL uint32_t lastReconnectAttempt _INIT(0);
 WLED_GLOBAL bool interfacesInited _INIT(false);
 WLED_GLOBAL bool wasConnected _INIT(false);
+WLED_GLOBAL uint32_t interfacesInitedTime _INIT(0);
+WLED_GLOBAL byte deferredServiceStep _INIT(0);
 
 // color
 WLED_GLOBAL byte colOld[]    _INIT_N(({ 0, 0, 0, 0 }));        // color before transition
@@ -617,6 +635,7 @@ public:
   void initAP(bool resetAP = false);
   void initConnection();
   void initInterfaces();
+  void handleDeferredServices();
   void handleStatusLED();
 };
 #endif        // WLED_H
@@ -32,6 +32,27 @@ bool captivePortal(AsyncWebServerRequest *request)
   return false;
 }
 
+#ifdef WLED_ENABLE_FS_EDITOR
+//passes every request on to the FS editor, which replaces files without the preset cache knowing,
+//and drops the cached presets after an upload or delete (in the web server's task, the cache applies it in the loop)
+class PresetNotifyingEditor : public AsyncWebHandler {
+  private:
+    SPIFFSEditor* _editor;
+  public:
+    PresetNotifyingEditor(SPIFFSEditor* editor) : _editor(editor) {}
+    virtual ~PresetNotifyingEditor() { delete _editor; }
+    virtual bool canHandle(AsyncWebServerRequest *request) override { return _editor->canHandle(request); }
+    virtual void handleRequest(AsyncWebServerRequest *request) override {
+      _editor->handleRequest(request);
+      if (request->method() != HTTP_GET) PresetCache::get().invalidate();
+    }
+    virtual void handleUpload(AsyncWebServerRequest *request, const String& filename, size_t index, uint8_t *data, size_t len, bool final) override {
+      _editor->handleUpload(request, filename, index, data, len, final);
+    }
+    virtual bool isRequestHandlerTrivial() override { return false; }
+};
+#endif
+
 void initServer()
 {
   //CORS compatiblity
@@ -51,7 +72,7 @@ void initServer()
   server.on("/favicon.ico", HTTP_GET, [](AsyncWebServerRequest *request){
     if(!handleFileRead(request, "/favicon.ico"))
     {
-      request->send_P(200, "image/x-icon", favicon, 156);
+      StaticAssetServer::get().sendProgmem(request, "image/x-icon", favicon, 156, favicon_etag, false);
     }
   });
   
@@ -77,15 +98,21 @@ void initServer()
   });
 
   AsyncCallbackJsonWebHandler* handler = new AsyncCallbackJsonWebHandler("/json", [](AsyncWebServerRequest *request) {
+    PROFILE_SCOPE(PROFILE_HTTP_JSON);
     bool verboseResponse = false;
-    { //scope JsonDocument so it releases its buffer
-      DynamicJsonDocument jsonBuffer(JSON_BUFFER_SIZE);
-      DeserializationError error = deserializeJson(jsonBuffer, (uint8_t*)(request->_tempObject));
-      JsonObject root = jsonBuffer.as<JsonObject>();
+    //slider and on/off requests are parsed into a small document, see StateRequestFilter
+    if (!StateRequestFilter::get().tryDeserializeState((const char*)(request->_tempObject), request->contentLength(), verboseResponse))
+    { //scope JsonDocumentLease so it returns its document to the pool
+      JsonDocumentLease jsonBuffer;
+      if (!jsonBuffer.isValid()) {
+        request->send(503, "application/json", F("{\"error\":\"busy\"}")); return;
+      }
+      DeserializationError error = deserializeJson(*jsonBuffer, (uint8_t*)(request->_tempObject));
+      JsonObject root = jsonBuffer->as<JsonObject>();
       if (error || root.isNull()) {
         request->send(400, "application/json", F("{\"error\":9}")); return;
       }
-      fileDoc = &jsonBuffer;
+      fileDoc = jsonBuffer.get();
       verboseResponse = deserializeState(root);
       fileDoc = nullptr;
     }
@@ -96,6 +123,29 @@ void initServer()
   });
   server.addHandler(handler);
 
+  //export and import of the light display, which is saved in a binary file
+  server.on("/lightDisplay.json", HTTP_GET, [](AsyncWebServerRequest *request){
+    serveLightDisplay(request);
+  });
+
+  AsyncCallbackJsonWebHandler* lightDisplayHandler = new AsyncCallbackJsonWebHandler("/lightDisplay.json", [](AsyncWebServerRequest *request) {
+    { //scope JsonDocumentLease so it returns its document to the pool
+      JsonDocumentLease jsonBuffer;
+      if (!jsonBuffer.isValid()) {
+        request->send(503, "application/json", F("{\"error\":\"busy\"}")); return;
+      }
+      DeserializationError error = deserializeJson(*jsonBuffer, (uint8_t*)(request->_tempObject));
+      JsonObject root = jsonBuffer->as<JsonObject>();
+      if (error || root.isNull()) {
+        request->send(400, "application/json", F("{\"error\":9}")); return;
+      }
+      lightDisplay.importFromJson(root);
+    }
+    JsonResponseCache::get().invalidate();
+    request->send(200, "application/json", F("{\"success\":true}"));
+  });
+  server.addHandler(lightDisplayHandler);
+
   server.on("/version", HTTP_GET, [](AsyncWebServerRequest *request){
     request->send(200, "text/plain", (String)VERSION);
     });
@@ -124,9 +174,9 @@ void initServer()
   if (!otaLock){
     #ifdef WLED_ENABLE_FS_EDITOR
      #ifdef ARDUINO_ARCH_ESP32
-      server.addHandler(new SPIFFSEditor(WLED_FS));//http_username,http_password));
+      server.addHandler(new PresetNotifyingEditor(new SPIFFSEditor(WLED_FS)));//http_username,http_password));
      #else
-      server.addHandler(new SPIFFSEditor("","",WLED_FS));//http_username,http_password));
+      server.addHandler(new PresetNotifyingEditor(new SPIFFSEditor("","",WLED_FS)));//http_username,http_password));
      #endif
     #else
     server.on("/edit", HTTP_GET, [](AsyncWebServerRequest *request){
@@ -234,11 +284,7 @@ void serveIndex(AsyncWebServerRequest* request)
 {
   if (handleFileRead(request, "/index.htm")) return;
 
-  AsyncWebServerResponse *response = request->beginResponse_P(200, "text/html", PAGE_index, PAGE_index_L);
-
-  response->addHeader(F("Content-Encoding"),"gzip");
-  
-  request->send(response);
+  StaticAssetServer::get().sendProgmem(request, "text/html", PAGE_index, PAGE_index_L, PAGE_index_etag, true);
 }
 
 
@@ -7,59 +7,84 @@
 
 uint16_t wsLiveClientId = 0;
 unsigned long wsLastLiveTime = 0;
-//uint8_t* wsFrameBuffer = nullptr;
 
 #define WS_LIVE_INTERVAL 40
 
+//handles a complete JSON text message, data is modified (ArduinoJson zero-copy)
+void handleWsText(AsyncWebSocketClient * client, uint8_t *data, size_t len)
+{
+  bool verboseResponse = false;
+  //slider and on/off requests are parsed into a small document, see StateRequestFilter
+  if (!StateRequestFilter::get().tryDeserializeState((const char*)data, len, verboseResponse))
+  { //scope JsonDocumentLease so it returns its document to the pool
+    JsonDocumentLease jsonBuffer;
+    if (!jsonBuffer.isValid()) {
+      client->text(F("{\"error\":\"busy\"}"));
+      return;
+    }
+    DeserializationError error = deserializeJson(*jsonBuffer, data, len);
+    JsonObject root = jsonBuffer->as<JsonObject>();
+    if (error || root.isNull()) return;
+
+    if (root.containsKey("lv"))
+    {
+      wsLiveClientId = root["lv"] ? client->id() : 0;
+    }
+
+    //binary stream of every LED, see LiveLedStream
+    if (root.containsKey("lvb"))
+    {
+      if (!root["lvb"]) LiveLedStream::get().stop(client->id());
+      else LiveLedStream::get().start(client->id()); //started from the loop, which answers if there is no memory
+    }
+
+    //opt in to (or out of) state deltas, {"resync":true} asks for the full state again
+    if (root.containsKey("delta")) WsDeltaSync::get().setDeltaMode(client->id(), root["delta"]);
+    if (root["resync"]) WsDeltaSync::get().requestResync(client->id());
+
+    fileDoc = jsonBuffer.get();
+    verboseResponse = deserializeState(root);
+    fileDoc = nullptr;
+  }
+  if (WsDeltaSync::get().isDeltaClient(client->id())) {
+    if (verboseResponse) WsDeltaSync::get().requestResync(client->id());
+    WsDeltaSync::get().requestBroadcast(); //deltas are small, the loop sends every delta client the change right away
+  } else if (verboseResponse || millis() - lastInterfaceUpdate < 1900) sendDataWs(client); //update if it takes longer than 100ms until next "broadcast"
+}
+
 void wsEvent(AsyncWebSocket * server, AsyncWebSocketClient * client, AwsEventType type, void * arg, uint8_t *data, size_t len)
 {
   if(type == WS_EVT_CONNECT){
     //client connected
+    WsDeltaSync::get().addClient(client->id());
     sendDataWs(client);
     //client->ping();
   } else if(type == WS_EVT_DISCONNECT){
     //client disconnected
     if (client->id() == wsLiveClientId) wsLiveClientId = 0;
+    WsDeltaSync::get().removeClient(client->id());
+    LiveLedStream::get().stop(client->id());
+    WsMessageAssembler::get().release(client->id());
   } else if(type == WS_EVT_DATA){
     //data packet
+    PROFILE_SCOPE(PROFILE_WS_EVENT);
     AwsFrameInfo * info = (AwsFrameInfo*)arg;
     if(info->final && info->index == 0 && info->len == len){
       //the whole message is in a single frame and we got all of it's data (max. 1450byte)
-      if(info->opcode == WS_TEXT)
-      {
-        bool verboseResponse = false;
-        { //scope JsonDocument so it releases its buffer
-          DynamicJsonDocument jsonBuffer(JSON_BUFFER_SIZE);
-          DeserializationError error = deserializeJson(jsonBuffer, data, len);
-          JsonObject root = jsonBuffer.as<JsonObject>();
-          if (error || root.isNull()) return;
-
-          if (root.containsKey("lv"))
-          {
-            wsLiveClientId = root["lv"] ? client->id() : 0;
-          }
-
-          verboseResponse = deserializeState(root);
-        }
-        if (verboseResponse || millis() - lastInterfaceUpdate < 1900) sendDataWs(client); //update if it takes longer than 100ms until next "broadcast"
-      }
-    } else {
-      //message is comprised of multiple frames or the frame is split into multiple packets
-      //if(info->index == 0){
-        //if (!wsFrameBuffer && len < 4096) wsFrameBuffer = new uint8_t[4096];
-      //}
-
-      //if (wsFrameBuffer && len < 4096 && info->index + info->)
-      //{
-
-      //}
-
-      if((info->index + len) == info->len){
-        if(info->final){
-          if(info->message_opcode == WS_TEXT) {
-            client->text(F("{\"error\":9}")); //we do not handle split packets right now
-          }
-        }
+      if(info->opcode == WS_TEXT) handleWsText(client, data, len);
+    } else if(info->message_opcode == WS_TEXT) {
+      //message is comprised of multiple frames or the frame is split into multiple packets, see WsMessageAssembler
+      WsMessageAssembler& assembler = WsMessageAssembler::get();
+      bool isStart = (info->num == 0 && info->index == 0);
+      bool isEnd = (info->final && (info->index + len) == info->len);
+      WsMessageAssembler::Result result = assembler.add(client->id(), data, len, isStart, isEnd);
+      if (result == WsMessageAssembler::COMPLETE) {
+        size_t messageLength;
+        uint8_t* message = assembler.getMessage(client->id(), messageLength);
+        handleWsText(client, message, messageLength);
+        assembler.release(client->id());
+      } else if (result == WsMessageAssembler::REJECTED && isEnd) {
+        client->text(F("{\"error\":9}")); //too long, no free slot or timed out
       }
     }
   } else if(type == WS_EVT_ERROR){
@@ -74,29 +99,44 @@ void wsEvent(AsyncWebSocket * server, AsyncWebSocketClient * client, AwsEventTyp
 void sendDataWs(AsyncWebSocketClient * client)
 {
   if (!ws.count()) return;
+  WsDeltaSync& deltaSync = WsDeltaSync::get();
+
+  //delta clients get a patch instead of the full state and info
+  if (!client) deltaSync.broadcast();
+  if (client && deltaSync.isDeltaClient(client->id())) return;
+  if (!client && !deltaSync.hasFullClients()) return;
+
   AsyncWebSocketMessageBuffer * buffer;
+  size_t len;
+
+  { //scope JsonDocumentLease so it returns its document to the pool
+    uint32_t startMicros = micros();
+    JsonDocumentLease doc;
+    if (!doc.isValid()) return; //pool exhausted, the next update sends the state
 
-  { //scope JsonDocument so it releases its buffer
-    DynamicJsonDocument doc(JSON_BUFFER_SIZE);
-    JsonObject state = doc.createNestedObject("state");
+    JsonObject state = doc->createNestedObject("state");
     serializeState(state);
-    JsonObject info  = doc.createNestedObject("info");
+    JsonObject info  = doc->createNestedObject("info");
     serializeInfo(info);
-    size_t len = measureJson(doc);
+    len = measureJson(*doc);
     buffer = ws.makeBuffer(len);
     if (!buffer) return; //out of memory
 
-    serializeJson(doc, (char *)buffer->get(), len +1);
+    serializeJson(*doc, (char *)buffer->get(), len +1);
+    deltaSync.countFullSerialization(len, micros() - startMicros);
   } 
   if (client) {
     client->text(buffer);
+    deltaSync.countFullMessage(client->id(), len);
   } else {
-    ws.textAll(buffer);
+    deltaSync.sendFull(buffer, len);
   }
 }
 
 void handleWs()
 {
+  LiveLedStream::get().handle(); //one message per loop at most
+  WsDeltaSync::get().handle(); //patches asked for by the WebSocket callbacks
   if (millis() - wsLastLiveTime > WS_LIVE_INTERVAL)
   {
     ws.cleanupClients();
@@ -0,0 +1,241 @@
+#include "wled.h"
+
+#ifdef WLED_ENABLE_WEBSOCKETS
+
+namespace
+{
+    const char* BYTES_ELEMENT = "bytes";
+    const char* PEAK_ELEMENT = "peak";
+    const char* ASSEMBLED_ELEMENT = "assembled";
+    const char* REJECTED_ELEMENT = "rejected";
+    const char* EVICTED_ELEMENT = "evicted";
+}
+
+/*
+** ============================================================================
+** Returns the one WebSocket message assembler
+** ============================================================================
+*/
+WsMessageAssembler& WsMessageAssembler::get()
+{
+    static WsMessageAssembler sWsMessageAssembler;
+    return sWsMessageAssembler;
+}
+
+/*
+** ============================================================================
+** Constructor
+** ============================================================================
+*/
+WsMessageAssembler::WsMessageAssembler()
+    : mTotalBytes( 0 )
+    , mPeakBytes( 0 )
+    , mNumAssembled( 0 )
+    , mNumRejected( 0 )
+    , mNumEvicted( 0 )
+{
+    memset(mSlots, 0, sizeof(mSlots));
+}
+
+/*
+** ============================================================================
+** Adds the next piece of a client's message.  The first piece takes a free
+** slot (dropping whatever the client had not finished), the others are
+** appended to the client's slot.
+**
+**  returns COMPLETE once the last piece is in, REJECTED if the message does
+**  not fit (or lost its slot) and PENDING otherwise
+** ============================================================================
+*/
+WsMessageAssembler::Result WsMessageAssembler::add(uint32_t clientId, const uint8_t* data, size_t length, bool isStart, bool isEnd)
+{
+    uint32_t now = millis();
+    evictExpired(now);
+
+    Slot* slot = findSlot(clientId);
+    if (isStart)
+    {
+        if (nullptr != slot)
+        {
+            freeSlot(*slot);
+        }
+        slot = findSlot(0);
+        if (nullptr != slot)
+        {
+            slot->clientId = clientId;
+            slot->startTimestamp = now;
+        }
+    }
+
+    if (nullptr == slot)
+    {
+        // No free slot, or the start of the message was dropped or evicted
+        if (isStart)
+        {
+            ++mNumRejected;
+        }
+        return REJECTED;
+    }
+
+    if (!reserve(*slot, slot->length + length))
+    {
+        ++mNumRejected;
+        freeSlot(*slot);
+        return REJECTED;
+    }
+
+    memcpy(slot->buffer + slot->length, data, length);
+    slot->length += length;
+
+    if (!isEnd)
+    {
+        return PENDING;
+    }
+
+    ++mNumAssembled;
+    return COMPLETE;
+}
+
+/*
+** ============================================================================
+** Returns the completed message of the given client
+** ============================================================================
+*/
+uint8_t* WsMessageAssembler::getMessage(uint32_t clientId, size_t& length)
+{
+    Slot* slot = findSlot(clientId);
+    if (nullptr == slot)
+    {
+        length = 0;
+        return nullptr;
+    }
+
+    length = slot->length;
+    return slot->buffer;
+}
+
+/*
+** ============================================================================
+** Frees the message of the given client, also used when it disconnects
+** ============================================================================
+*/
+void WsMessageAssembler::release(uint32_t clientId)
+{
+    Slot* slot = findSlot(clientId);
+    if (nullptr != slot)
+    {
+        freeSlot(*slot);
+    }
+}
+
+/*
+** ============================================================================
+** Evicts the messages whose client did not send the rest in time
+** ============================================================================
+*/
+void WsMessageAssembler::evictExpired(uint32_t currentMillis)
+{
+    for (Slot& slot : mSlots)
+    {
+        if (0 != slot.clientId && currentMillis - slot.startTimestamp > TIMEOUT_MS)
+        {
+            ++mNumEvicted;
+            freeSlot(slot);
+        }
+    }
+}
+
+/*
+** ============================================================================
+** Writes the memory used and what happened to the messages
+** ============================================================================
+*/
+void WsMessageAssembler::serializeToJson(JsonObject root) const
+{
+    root[BYTES_ELEMENT] = mTotalBytes;
+    root[PEAK_ELEMENT] = mPeakBytes;
+    root[ASSEMBLED_ELEMENT] = mNumAssembled;
+    root[REJECTED_ELEMENT] = mNumRejected;
+    root[EVICTED_ELEMENT] = mNumEvicted;
+}
+
+/*
+** ============================================================================
+** Returns the slot of the given client, or a free slot for a client id of 0
+** ============================================================================
+*/
+WsMessageAssembler::Slot* WsMessageAssembler::findSlot(uint32_t clientId)
+{
+    for (Slot& slot : mSlots)
+    {
+        if (slot.clientId == clientId)
+        {
+            return &slot;
+        }
+    }
+
+    return nullptr;
+}
+
+/*
+** ============================================================================
+** Grows the slot's buffer to hold at least the given length, in steps of
+** GROWTH_BYTES so a message arriving in small packets is not reallocated for
+** each of them
+**
+**  returns false if that would go over the limits or the heap ran out
+** ============================================================================
+*/
+bool WsMessageAssembler::reserve(Slot& slot, size_t length)
+{
+    if (length <= slot.capacity)
+    {
+        return true;
+    }
+
+    if (length > MAX_MESSAGE_BYTES)
+    {
+        return false;
+    }
+
+    size_t newCapacity = ((length + GROWTH_BYTES - 1) / GROWTH_BYTES) * GROWTH_BYTES;
+    if (newCapacity > MAX_MESSAGE_BYTES)
+    {
+        newCapacity = MAX_MESSAGE_BYTES;
+    }
+
+    if (mTotalBytes - slot.capacity + newCapacity > MAX_TOTAL_BYTES)
+    {
+        return false;
+    }
+
+    uint8_t* newBuffer = (uint8_t*)realloc(slot.buffer, newCapacity);
+    if (nullptr == newBuffer)
+    {
+        return false;
+    }
+
+    mTotalBytes = mTotalBytes - slot.capacity + newCapacity;
+    if (mTotalBytes > mPeakBytes)
+    {
+        mPeakBytes = mTotalBytes;
+    }
+
+    slot.buffer = newBuffer;
+    slot.capacity = newCapacity;
+    return true;
+}
+
+/*
+** ============================================================================
+** Frees the slot's buffer and makes it available again
+** ============================================================================
+*/
+void WsMessageAssembler::freeSlot(Slot& slot)
+{
+    free(slot.buffer);
+    mTotalBytes -= slot.capacity;
+    memset(&slot, 0, sizeof(Slot));
+}
+
+#endif
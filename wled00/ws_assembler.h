@@ -0,0 +1,87 @@
+#ifndef WS_ASSEMBLER_H
+#define WS_ASSEMBLER_H
+
+#include "Arduino.h"
+
+/*
+**-----------------------------------------------------------------------------
+** Puts WebSocket text messages that arrive in several frames (or a frame split
+** over several packets) back together so they can be handled like a message
+** that arrived in one piece, instead of being answered with {"error":9}.
+**
+** There are NUM_SLOTS messages being assembled at most, one per client.  A
+** slot's buffer grows as the message arrives, up to MAX_MESSAGE_BYTES, and all
+** slots together never hold more than MAX_TOTAL_BYTES.  A message that would
+** go over either limit, or that finds no free slot, is dropped and the client
+** is told so.  A message that has not been completed within TIMEOUT_MS (the
+** client went quiet half way through) is evicted when the next piece of any
+** message arrives, or when its client disconnects.
+**
+** Every call comes from the WebSocket event handler, so the slots are only
+** ever touched from the async TCP task (on the ESP32) and need no lock.
+**-----------------------------------------------------------------------------
+*/
+class WsMessageAssembler
+{
+    public:
+#ifdef ESP8266
+        static const uint8_t NUM_SLOTS = 2;
+        static const uint16_t MAX_MESSAGE_BYTES = 6144;
+        static const uint16_t MAX_TOTAL_BYTES = 8192;
+#else
+        static const uint8_t NUM_SLOTS = 4;
+        static const uint16_t MAX_MESSAGE_BYTES = 16384;
+        static const uint16_t MAX_TOTAL_BYTES = 32768;
+#endif
+        static const uint16_t TIMEOUT_MS = 3000;
+        static const uint16_t GROWTH_BYTES = 1024;
+
+        enum Result
+        {
+            PENDING,        // more data is needed
+            COMPLETE,       // the message can be taken with getMessage
+            REJECTED        // the message was dropped
+        };
+
+        static WsMessageAssembler& get();
+
+        // Adds the next piece of a message, isStart for the first piece and isEnd for the last
+        Result add(uint32_t clientId, const uint8_t* data, size_t length, bool isStart, bool isEnd);
+
+        // The completed message of the client, valid until release
+        uint8_t* getMessage(uint32_t clientId, size_t& length);
+        void release(uint32_t clientId);
+
+        void serializeToJson(JsonObject root) const;
+
+    private:
+        WsMessageAssembler();
+        WsMessageAssembler(const WsMessageAssembler&);
+        WsMessageAssembler& operator=(const WsMessageAssembler&);
+
+        struct Slot
+        {
+            uint32_t    clientId;
+            uint8_t*    buffer;
+            size_t      capacity;
+            size_t      length;
+            uint32_t    startTimestamp;
+        };
+
+        void evictExpired(uint32_t currentMillis);
+        Slot* findSlot(uint32_t clientId);
+        bool reserve(Slot& slot, size_t length);
+        void freeSlot(Slot& slot);
+
+    private:
+        Slot        mSlots[NUM_SLOTS];
+        size_t      mTotalBytes;
+
+        // Statistics
+        size_t      mPeakBytes;
+        uint32_t    mNumAssembled;
+        uint32_t    mNumRejected;
+        uint32_t    mNumEvicted;
+};
+
+#endif
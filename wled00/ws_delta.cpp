@@ -0,0 +1,814 @@
+#include "wled.h"
+
+#ifdef WLED_ENABLE_WEBSOCKETS
+
+#ifdef ARDUINO_ARCH_ESP32
+  // Clients come and go in the async TCP task, the diffs are sent from the loop task
+  static portMUX_TYPE sDeltaMux = portMUX_INITIALIZER_UNLOCKED;
+  #define DELTA_LOCK()   portENTER_CRITICAL(&sDeltaMux)
+  #define DELTA_UNLOCK() portEXIT_CRITICAL(&sDeltaMux)
+#else
+  // Everything runs in the same context on the ESP8266
+  #define DELTA_LOCK()
+  #define DELTA_UNLOCK()
+#endif
+
+namespace
+{
+    const char* SEQUENCE_ELEMENT = "seq";
+    const char* DELTA_ELEMENT = "delta";
+    const char* RESYNC_ELEMENT = "resync";
+    const char* STATE_ELEMENT = "state";
+    const char* INFO_ELEMENT = "info";
+    const char* LIGHTED_OBJECTS_ELEMENT = "lighted_objects";
+    const char* NUM_OBJECTS_ELEMENT = "num_objects";
+
+    const char* CLIENTS_ELEMENT = "clients";
+    const char* ID_ELEMENT = "id";
+    const char* BYTES_ELEMENT = "bytes";
+    const char* BYTES_PER_SECOND_ELEMENT = "bytes_per_s";
+    const char* MESSAGES_ELEMENT = "msgs";
+    const char* RESYNCS_ELEMENT = "resyncs";
+    const char* SKIPPED_ELEMENT = "skipped";
+    const char* FULL_ELEMENT = "full";
+    const char* COUNT_ELEMENT = "count";
+    const char* AVERAGE_BYTES_ELEMENT = "avg_bytes";
+    const char* AVERAGE_MICROS_ELEMENT = "avg_us";
+    const char* MAX_MICROS_ELEMENT = "max_us";
+
+    const uint32_t FNV_OFFSET_BASIS = 2166136261UL;
+    const uint32_t FNV_PRIME = 16777619UL;
+
+    /*
+    **-------------------------------------------------------------------------
+    ** Hashes whatever is printed to it (FNV-1a) so a JSON value can be compared
+    ** with the last one sent without keeping a copy of it
+    **-------------------------------------------------------------------------
+    */
+    class HashPrint : public Print
+    {
+        public:
+            HashPrint() : mHash(FNV_OFFSET_BASIS) {}
+
+            size_t write(uint8_t character) override
+            {
+                mHash = (mHash ^ character) * FNV_PRIME;
+                return 1;
+            }
+
+            uint32_t getHash() const { return mHash; }
+
+        private:
+            uint32_t mHash;
+    };
+
+    uint32_t hashJson(JsonVariantConst value)
+    {
+        HashPrint hashPrint;
+        serializeJson(value, hashPrint);
+        return hashPrint.getHash();
+    }
+
+    void appendMemberName(String& message, bool& firstMember, const char* name)
+    {
+        if (!firstMember)
+        {
+            message += ',';
+        }
+        firstMember = false;
+
+        message += '"';
+        message += name;
+        message += F("\":");
+    }
+}
+
+/*
+** ============================================================================
+** Returns the one WebSocket delta sync
+** ============================================================================
+*/
+WsDeltaSync& WsDeltaSync::get()
+{
+    static WsDeltaSync sWsDeltaSync;
+    return sWsDeltaSync;
+}
+
+/*
+** ============================================================================
+** Constructor
+** ============================================================================
+*/
+WsDeltaSync::WsDeltaSync()
+    : mSequence( 0 )
+    , mBroadcastPending( false )
+    , mHashesValid( false )
+    , mDiffGeneration( 0 )
+    , mNumStateHashes( 0 )
+{
+    memset(mClients, 0, sizeof(mClients));
+    memset(&mFullStatistics, 0, sizeof(mFullStatistics));
+    memset(&mDeltaStatistics, 0, sizeof(mDeltaStatistics));
+    memset(&mResyncStatistics, 0, sizeof(mResyncStatistics));
+}
+
+/*
+** ============================================================================
+** Starts tracking a newly connected client, it gets full updates until it asks
+** for deltas
+** ============================================================================
+*/
+void WsDeltaSync::addClient(uint32_t clientId)
+{
+    uint32_t now = millis();
+
+    DELTA_LOCK();
+    // A client that is not tracked (no free slot) simply keeps getting full updates
+    ClientState* clientState = (nullptr == findClient(clientId)) ? findClient(0) : nullptr;
+    if (nullptr != clientState)
+    {
+        memset(clientState, 0, sizeof(ClientState));
+        clientState->clientId = clientId;
+        clientState->connectTimestamp = now;
+    }
+    DELTA_UNLOCK();
+}
+
+/*
+** ============================================================================
+** Stops tracking a disconnected client
+** ============================================================================
+*/
+void WsDeltaSync::removeClient(uint32_t clientId)
+{
+    DELTA_LOCK();
+    ClientState* clientState = findClient(clientId);
+    if (nullptr != clientState)
+    {
+        clientState->clientId = 0;
+        clientState->deltaMode = false;
+    }
+    DELTA_UNLOCK();
+}
+
+/*
+** ============================================================================
+** Switches a client between deltas and full updates.  A client switching to
+** deltas first gets a resync to apply them to.
+** ============================================================================
+*/
+void WsDeltaSync::setDeltaMode(uint32_t clientId, bool enabled)
+{
+    addClient(clientId);
+
+    DELTA_LOCK();
+    ClientState* clientState = findClient(clientId);
+    if (nullptr != clientState && clientState->deltaMode != enabled)
+    {
+        clientState->deltaMode = enabled;
+        clientState->needsResync = enabled;
+    }
+    DELTA_UNLOCK();
+}
+
+/*
+** ============================================================================
+** Marks a delta client as needing the full state, sent from the loop
+** ============================================================================
+*/
+void WsDeltaSync::requestResync(uint32_t clientId)
+{
+    DELTA_LOCK();
+    ClientState* clientState = findClient(clientId);
+    if (nullptr != clientState && clientState->deltaMode)
+    {
+        clientState->needsResync = true;
+    }
+    DELTA_UNLOCK();
+}
+
+/*
+** ============================================================================
+** Asks the loop to diff the state and send the patch.  The WebSocket and web
+** server callbacks call this rather than broadcast(), the hashes and the
+** sequence number are only touched from the loop.
+** ============================================================================
+*/
+void WsDeltaSync::requestBroadcast()
+{
+    mBroadcastPending = true;
+}
+
+/*
+** ============================================================================
+** Returns true if any client asked for deltas
+** ============================================================================
+*/
+bool WsDeltaSync::hasDeltaClients() const
+{
+    bool hasDeltaClient = false;
+
+    DELTA_LOCK();
+    for (const ClientState& clientState : mClients)
+    {
+        if (0 != clientState.clientId && clientState.deltaMode)
+        {
+            hasDeltaClient = true;
+            break;
+        }
+    }
+    DELTA_UNLOCK();
+
+    return hasDeltaClient;
+}
+
+/*
+** ============================================================================
+** Returns true if any connected client still gets the full state and info
+** ============================================================================
+*/
+bool WsDeltaSync::hasFullClients() const
+{
+    uint8_t numDeltaClients = 0;
+
+    DELTA_LOCK();
+    for (const ClientState& clientState : mClients)
+    {
+        if (0 != clientState.clientId && clientState.deltaMode)
+        {
+            ++numDeltaClients;
+        }
+    }
+    DELTA_UNLOCK();
+
+    return ws.count() > numDeltaClients;
+}
+
+/*
+** ============================================================================
+** Returns true if the given client asked for deltas
+** ============================================================================
+*/
+bool WsDeltaSync::isDeltaClient(uint32_t clientId) const
+{
+    DELTA_LOCK();
+    const ClientState* clientState = findClient(clientId);
+    bool deltaMode = nullptr != clientState && clientState->deltaMode;
+    DELTA_UNLOCK();
+
+    return deltaMode;
+}
+
+/*
+** ============================================================================
+** Diffs the current state and lighted objects against what was last sent and
+** sends the patch to every delta client, or a resync to those that need one.
+** Only called from the loop.
+** ============================================================================
+*/
+void WsDeltaSync::broadcast()
+{
+    mBroadcastPending = false;
+
+    if (!hasDeltaClients())
+    {
+        // Nobody is following the hashes, they have to be rebuilt once someone does
+        mHashesValid = false;
+        return;
+    }
+
+    uint32_t startMicros = micros();
+    String patch;
+
+    { //scope JsonDocumentLease so it returns its document to the pool before a resync borrows one
+        JsonDocumentLease doc;
+        if (!doc.isValid())
+        {
+            // The change can not be diffed, everybody starts again from a resync
+            mHashesValid = false;
+            requestResyncAll();
+            return;
+        }
+
+        mDiffGeneration = JsonResponseCache::get().getGeneration();
+        JsonObject state = doc->createNestedObject(STATE_ELEMENT);
+        serializeState(state);
+
+        JsonArray lightedObjects = doc->createNestedArray(LIGHTED_OBJECTS_ELEMENT);
+        for (ILightedObject* lightedObject : lightDisplay.getLightedObjects())
+        {
+            JsonObject currentLightedObject = lightedObjects.createNestedObject();
+            lightedObject->serializeCurrentStateToJson(currentLightedObject);
+        }
+
+        if (!mHashesValid)
+        {
+            // There is nothing to diff against yet, so whatever the clients have
+            // may be out of date
+            buildPatch(state, lightedObjects, patch);
+            patch = String();
+            requestResyncAll();
+        }
+        else if (buildPatch(state, lightedObjects, patch))
+        {
+            countMessage(mDeltaStatistics, patch.length(), micros() - startMicros);
+        }
+    }
+
+    sendPending(patch);
+}
+
+/*
+** ============================================================================
+** Sends the patch asked for by requestBroadcast and the resyncs still waiting
+** for a client's queue to drain, called from the loop.  Nothing is built while
+** every such client's queue is still full.  The state is only diffed again if
+** it changed since the last diff, otherwise the hashes are still those of what
+** the resync will carry.
+** ============================================================================
+*/
+void WsDeltaSync::handle()
+{
+    if (mBroadcastPending)
+    {
+        broadcast();
+        return;
+    }
+
+    uint32_t resyncClientIds[MAX_CLIENTS];
+    uint8_t numResyncClients = 0;
+
+    DELTA_LOCK();
+    for (const ClientState& clientState : mClients)
+    {
+        if (0 != clientState.clientId && clientState.deltaMode && clientState.needsResync)
+        {
+            resyncClientIds[numResyncClients++] = clientState.clientId;
+        }
+    }
+    DELTA_UNLOCK();
+
+    bool canSend = false;
+    for (uint8_t index = 0; index < numResyncClients && !canSend; ++index)
+    {
+        AsyncWebSocketClient* client = ws.client(resyncClientIds[index]);
+        canSend = (nullptr != client && client->status() == WS_CONNECTED && client->queueLength() < MAX_QUEUED_MESSAGES);
+    }
+
+    if (!canSend)
+    {
+        return;
+    }
+
+    if (!mHashesValid || mDiffGeneration != JsonResponseCache::get().getGeneration())
+    {
+        // Diffing first also sets up the hashes the next patch is built on
+        broadcast();
+    }
+    else
+    {
+        sendPending(String());
+    }
+}
+
+/*
+** ============================================================================
+** Sends the full state and info to every client that did not ask for deltas
+** ============================================================================
+*/
+void WsDeltaSync::sendFull(AsyncWebSocketMessageBuffer* buffer, size_t numBytes)
+{
+    bool sendToAll = !hasDeltaClients();
+    if (sendToAll)
+    {
+        ws.textAll(buffer);
+    }
+
+    uint32_t fullClientIds[MAX_CLIENTS];
+    uint8_t numFullClients = 0;
+
+    DELTA_LOCK();
+    for (const ClientState& clientState : mClients)
+    {
+        if (0 != clientState.clientId && !clientState.deltaMode)
+        {
+            fullClientIds[numFullClients++] = clientState.clientId;
+        }
+    }
+    DELTA_UNLOCK();
+
+    for (uint8_t index = 0; index < numFullClients; ++index)
+    {
+        AsyncWebSocketClient* client = sendToAll ? nullptr : ws.client(fullClientIds[index]);
+        if (sendToAll || (nullptr != client && client->status() == WS_CONNECTED))
+        {
+            if (!sendToAll)
+            {
+                client->text(buffer);
+            }
+            countFullMessage(fullClientIds[index], numBytes);
+        }
+    }
+}
+
+/*
+** ============================================================================
+** Counts the building of one full state and info message
+** ============================================================================
+*/
+void WsDeltaSync::countFullSerialization(size_t numBytes, uint32_t micros)
+{
+    countMessage(mFullStatistics, numBytes, micros);
+}
+
+/*
+** ============================================================================
+** Counts one full state and info message sent to the given client
+** ============================================================================
+*/
+void WsDeltaSync::countFullMessage(uint32_t clientId, size_t numBytes)
+{
+    if (0 == clientId)
+    {
+        return;
+    }
+
+    DELTA_LOCK();
+    ClientState* clientState = findClient(clientId);
+    if (nullptr != clientState)
+    {
+        clientState->numBytes += numBytes;
+        ++clientState->numMessages;
+    }
+    DELTA_UNLOCK();
+}
+
+/*
+** ============================================================================
+** Writes the per client traffic and the cost of the full, delta and resync
+** messages
+** ============================================================================
+*/
+void WsDeltaSync::serializeToJson(JsonObject root) const
+{
+    // Copied so the lock is not held while building the JSON
+    ClientState clientStates[MAX_CLIENTS];
+    MessageStatistics fullStatistics;
+    MessageStatistics deltaStatistics;
+    MessageStatistics resyncStatistics;
+
+    DELTA_LOCK();
+    memcpy(clientStates, mClients, sizeof(clientStates));
+    fullStatistics = mFullStatistics;
+    deltaStatistics = mDeltaStatistics;
+    resyncStatistics = mResyncStatistics;
+    DELTA_UNLOCK();
+
+    root[SEQUENCE_ELEMENT] = mSequence;
+
+    JsonArray clients = root.createNestedArray(CLIENTS_ELEMENT);
+    uint32_t now = millis();
+    for (const ClientState& clientState : clientStates)
+    {
+        if (0 == clientState.clientId)
+        {
+            continue;
+        }
+
+        JsonObject client = clients.createNestedObject();
+        client[ID_ELEMENT] = clientState.clientId;
+        client[DELTA_ELEMENT] = clientState.deltaMode;
+        client[BYTES_ELEMENT] = clientState.numBytes;
+        uint32_t connectedMs = now - clientState.connectTimestamp;
+        client[BYTES_PER_SECOND_ELEMENT] = (connectedMs > 0) ? (uint32_t)((uint64_t)clientState.numBytes * 1000 / connectedMs) : 0;
+        client[MESSAGES_ELEMENT] = clientState.numMessages;
+        client[RESYNCS_ELEMENT] = clientState.numResyncs;
+        client[SKIPPED_ELEMENT] = clientState.numSkipped;
+    }
+
+    const char* names[] = { FULL_ELEMENT, DELTA_ELEMENT, RESYNC_ELEMENT };
+    const MessageStatistics* statistics[] = { &fullStatistics, &deltaStatistics, &resyncStatistics };
+    for (uint8_t index = 0; index < 3; ++index)
+    {
+        JsonObject messages = root.createNestedObject(names[index]);
+        uint32_t count = statistics[index]->count;
+        messages[COUNT_ELEMENT] = count;
+        messages[AVERAGE_BYTES_ELEMENT] = (count > 0) ? statistics[index]->totalBytes / count : 0;
+        messages[AVERAGE_MICROS_ELEMENT] = (count > 0) ? statistics[index]->totalMicros / count : 0;
+        messages[MAX_MICROS_ELEMENT] = statistics[index]->maxMicros;
+    }
+}
+
+/*
+** ============================================================================
+** Returns the state of the given client, or a free slot for a client id of 0.
+** The caller holds the lock.
+** ============================================================================
+*/
+WsDeltaSync::ClientState* WsDeltaSync::findClient(uint32_t clientId)
+{
+    for (ClientState& clientState : mClients)
+    {
+        if (clientState.clientId == clientId)
+        {
+            return &clientState;
+        }
+    }
+
+    return nullptr;
+}
+
+const WsDeltaSync::ClientState* WsDeltaSync::findClient(uint32_t clientId) const
+{
+    for (const ClientState& clientState : mClients)
+    {
+        if (clientState.clientId == clientId)
+        {
+            return &clientState;
+        }
+    }
+
+    return nullptr;
+}
+
+/*
+** ============================================================================
+** Hashes every state value and lighted object, writes the ones that changed
+** into the patch and keeps the new hashes for the next diff
+**
+**  returns true if anything changed
+** ============================================================================
+*/
+bool WsDeltaSync::buildPatch(JsonObject state, JsonArray lightedObjects, String& patch)
+{
+    ValueHash newStateHashes[MAX_STATE_VALUES];
+    uint8_t numNewStateHashes = 0;
+    bool firstState = true;
+
+    bool firstMember = true;
+    patch = String();
+    patch.reserve(128);
+    patch += '{';
+    appendMemberName(patch, firstMember, SEQUENCE_ELEMENT);
+    patch += mSequence + 1;
+    appendMemberName(patch, firstMember, DELTA_ELEMENT);
+    patch += '{';
+    firstMember = true;
+    appendMemberName(patch, firstMember, STATE_ELEMENT);
+    patch += '{';
+
+    // State values that are new or changed
+    for (JsonPair value : state)
+    {
+        if (numNewStateHashes >= MAX_STATE_VALUES)
+        {
+            break;
+        }
+
+        ValueHash& newHash = newStateHashes[numNewStateHashes++];
+        strlcpy(newHash.key, value.key().c_str(), MAX_KEY_LENGTH);
+        newHash.valueHash = hashJson(value.value());
+
+        bool changed = true;
+        for (uint8_t index = 0; index < mNumStateHashes; ++index)
+        {
+            if (0 == strcmp(mStateHashes[index].key, newHash.key))
+            {
+                changed = (mStateHashes[index].valueHash != newHash.valueHash);
+                break;
+            }
+        }
+
+        if (changed)
+        {
+            appendMemberName(patch, firstState, value.key().c_str());
+            serializeJson(value.value(), patch);
+        }
+    }
+
+    // State values that are gone
+    for (uint8_t index = 0; index < mNumStateHashes; ++index)
+    {
+        bool found = false;
+        for (uint8_t newIndex = 0; newIndex < numNewStateHashes && !found; ++newIndex)
+        {
+            found = (0 == strcmp(newStateHashes[newIndex].key, mStateHashes[index].key));
+        }
+
+        if (!found)
+        {
+            appendMemberName(patch, firstState, mStateHashes[index].key);
+            patch += F("null");
+        }
+    }
+    patch += '}';
+
+    // Lighted objects that are new or changed
+    bool firstObject = true;
+    size_t numObjects = lightedObjects.size();
+    size_t numOldObjects = mObjectHashes.size();
+    mObjectHashes.resize(numObjects);
+    for (size_t index = 0; index < numObjects; ++index)
+    {
+        uint32_t objectHash = hashJson(lightedObjects[index]);
+        if (index < numOldObjects && objectHash == mObjectHashes[index])
+        {
+            continue;
+        }
+        mObjectHashes[index] = objectHash;
+
+        if (firstObject)
+        {
+            appendMemberName(patch, firstMember, LIGHTED_OBJECTS_ELEMENT);
+            patch += '{';
+        }
+        char name[6];
+        snprintf(name, sizeof(name), "%u", (unsigned)index);
+        appendMemberName(patch, firstObject, name);
+        serializeJson(lightedObjects[index], patch);
+    }
+    if (!firstObject)
+    {
+        patch += '}';
+    }
+
+    if (numObjects != numOldObjects)
+    {
+        appendMemberName(patch, firstMember, NUM_OBJECTS_ELEMENT);
+        patch += (unsigned)numObjects;
+    }
+    patch += F("}}");
+
+    bool changed = !firstState || !firstObject || numObjects != numOldObjects;
+
+    memcpy(mStateHashes, newStateHashes, sizeof(ValueHash) * numNewStateHashes);
+    mNumStateHashes = numNewStateHashes;
+    mHashesValid = true;
+
+    if (changed)
+    {
+        ++mSequence;
+    }
+    else
+    {
+        patch = String();
+    }
+
+    return changed;
+}
+
+/*
+** ============================================================================
+** Sends the patch to the delta clients that are keeping up and a resync to
+** those that need one and have room for it in their queue.  The client table
+** is only read and updated under the lock, never while sending; a client that
+** is gone is left for the disconnect event to remove.
+** ============================================================================
+*/
+void WsDeltaSync::sendPending(const String& patch)
+{
+    for (uint8_t index = 0; index < MAX_CLIENTS; ++index)
+    {
+        DELTA_LOCK();
+        ClientState clientState = mClients[index];
+        DELTA_UNLOCK();
+
+        if (0 == clientState.clientId || !clientState.deltaMode)
+        {
+            continue;
+        }
+
+        AsyncWebSocketClient* client = ws.client(clientState.clientId);
+        if (nullptr == client || client->status() != WS_CONNECTED)
+        {
+            continue;
+        }
+
+        size_t numBytes = 0;
+        bool skipped = false;
+        bool resyncSent = false;
+        if (client->queueLength() >= MAX_QUEUED_MESSAGES)
+        {
+            // A patch would only pile up behind the others, send the full state once the queue drains
+            skipped = (patch.length() > 0);
+        }
+        else if (clientState.needsResync)
+        {
+            resyncSent = sendResync(client, numBytes);
+        }
+        else if (patch.length() > 0)
+        {
+            client->text(patch.c_str(), patch.length());
+            numBytes = patch.length();
+        }
+
+        DELTA_LOCK();
+        ClientState& currentState = mClients[index];
+        if (currentState.clientId == clientState.clientId)
+        {
+            if (skipped)
+            {
+                ++currentState.numSkipped;
+                currentState.needsResync = true;
+            }
+            if (resyncSent)
+            {
+                currentState.needsResync = false;
+                ++currentState.numResyncs;
+            }
+            if (numBytes > 0)
+            {
+                currentState.numBytes += numBytes;
+                ++currentState.numMessages;
+            }
+        }
+        DELTA_UNLOCK();
+    }
+}
+
+/*
+** ============================================================================
+** Sends the full state, info and lighted objects with the current sequence
+** number
+**
+**  param   client - client to send the resync to
+**  param   numBytes - set to the length of the resync that was sent
+**  returns false if it could not be built, it is tried again from the loop
+** ============================================================================
+*/
+bool WsDeltaSync::sendResync(AsyncWebSocketClient* client, size_t& numBytes)
+{
+    uint32_t startMicros = micros();
+    AsyncWebSocketMessageBuffer* buffer;
+    size_t length;
+
+    { //scope JsonDocumentLease so it returns its document to the pool
+        JsonDocumentLease doc;
+        if (!doc.isValid())
+        {
+            return false;
+        }
+
+        (*doc)[SEQUENCE_ELEMENT] = mSequence;
+        (*doc)[RESYNC_ELEMENT] = true;
+        JsonObject state = doc->createNestedObject(STATE_ELEMENT);
+        serializeState(state);
+        JsonObject info = doc->createNestedObject(INFO_ELEMENT);
+        serializeInfo(info);
+        JsonArray lightedObjects = doc->createNestedArray(LIGHTED_OBJECTS_ELEMENT);
+        for (ILightedObject* lightedObject : lightDisplay.getLightedObjects())
+        {
+            JsonObject currentLightedObject = lightedObjects.createNestedObject();
+            lightedObject->serializeCurrentStateToJson(currentLightedObject);
+        }
+
+        length = measureJson(*doc);
+        buffer = ws.makeBuffer(length);
+        if (!buffer)
+        {
+            return false; //out of memory
+        }
+
+        serializeJson(*doc, (char *)buffer->get(), length + 1);
+    }
+
+    client->text(buffer);
+    countMessage(mResyncStatistics, length, micros() - startMicros);
+    numBytes = length;
+    return true;
+}
+
+/*
+** ============================================================================
+** Marks every delta client as needing the full state
+** ============================================================================
+*/
+void WsDeltaSync::requestResyncAll()
+{
+    DELTA_LOCK();
+    for (ClientState& clientState : mClients)
+    {
+        clientState.needsResync = clientState.deltaMode;
+    }
+    DELTA_UNLOCK();
+}
+
+/*
+** ============================================================================
+** Adds one message to the given statistics
+** ============================================================================
+*/
+void WsDeltaSync::countMessage(MessageStatistics& statistics, size_t numBytes, uint32_t micros)
+{
+    DELTA_LOCK();
+    ++statistics.count;
+    statistics.totalBytes += numBytes;
+    statistics.totalMicros += micros;
+    if (micros > statistics.maxMicros)
+    {
+        statistics.maxMicros = micros;
+    }
+    DELTA_UNLOCK();
+}
+
+#endif
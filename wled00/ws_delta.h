@@ -0,0 +1,138 @@
+#ifndef WS_DELTA_H
+#define WS_DELTA_H
+
+#include "Arduino.h"
+
+#include <vector>
+
+/*
+**-----------------------------------------------------------------------------
+** Sends WebSocket clients that ask for it ({"delta":true}) only what changed
+** since the last update instead of the full state and info on every change.
+**
+** Each update is diffed against the previous one: every top level state value
+** and every lighted object is hashed and only the values whose hash changed
+** go into the patch,
+**
+**   {"seq":42,"delta":{"state":{"bri":80},"lighted_objects":{"3":{...}}}}
+**
+** A removed state value is sent as null, a change in the number of lighted
+** objects adds "num_objects".  The sequence number goes up by one with every
+** patch.  A client that sees a gap, or that just switched to deltas, gets a
+** resync: the full state, info and lighted objects with the current sequence
+** number.  A client can ask for one at any time with {"resync":true}.
+**
+** A client whose send queue is backing up is not sent patches it can not keep
+** up with, it is marked and sent one resync once its queue has drained.  The
+** state is not rebuilt while waiting for that.
+**
+** The diff, the hashes and the sequence number belong to the loop task, the
+** WebSocket callbacks only ask for a broadcast.  The client table is shared
+** with the async TCP task on the ESP32 so it is guarded by a spinlock.
+**
+** Clients that never ask for deltas keep getting the full state and info.  The
+** bytes sent to each client and the time spent building full and delta
+** messages are reported in /json/perf ("ws_delta") so both can be compared.
+**-----------------------------------------------------------------------------
+*/
+class WsDeltaSync
+{
+    public:
+#ifdef ESP8266
+        static const uint8_t MAX_CLIENTS = 4;
+#else
+        static const uint8_t MAX_CLIENTS = 8;
+#endif
+        static const uint8_t MAX_STATE_VALUES = 24;
+        static const uint8_t MAX_KEY_LENGTH = 16;
+        static const uint8_t MAX_QUEUED_MESSAGES = 3;
+
+        static WsDeltaSync& get();
+
+        void addClient(uint32_t clientId);
+        void removeClient(uint32_t clientId);
+        void setDeltaMode(uint32_t clientId, bool enabled);
+        void requestResync(uint32_t clientId);
+
+        bool hasDeltaClients() const;
+        bool hasFullClients() const;
+        bool isDeltaClient(uint32_t clientId) const;
+
+        // Asks the loop to send the next patch, safe from the WebSocket callbacks
+        void requestBroadcast();
+
+        // Sends the next patch (or a resync) to every delta client, loop only
+        void broadcast();
+
+        // Sends the requested patch and the resyncs still pending, called from the loop
+        void handle();
+
+        // Sends the full state and info built by sendDataWs to the other clients
+        void sendFull(AsyncWebSocketMessageBuffer* buffer, size_t numBytes);
+
+        // Statistics of the full messages sent by sendDataWs
+        void countFullSerialization(size_t numBytes, uint32_t micros);
+        void countFullMessage(uint32_t clientId, size_t numBytes);
+
+        void serializeToJson(JsonObject root) const;
+
+    private:
+        WsDeltaSync();
+        WsDeltaSync(const WsDeltaSync&);
+        WsDeltaSync& operator=(const WsDeltaSync&);
+
+        struct ClientState
+        {
+            uint32_t    clientId;
+            bool        deltaMode;
+            bool        needsResync;
+            uint32_t    connectTimestamp;
+            uint32_t    numBytes;
+            uint32_t    numMessages;
+            uint16_t    numResyncs;
+            uint16_t    numSkipped;
+        };
+
+        struct ValueHash
+        {
+            char        key[MAX_KEY_LENGTH];
+            uint32_t    valueHash;
+        };
+
+        struct MessageStatistics
+        {
+            uint32_t    count;
+            uint32_t    totalBytes;
+            uint32_t    totalMicros;
+            uint32_t    maxMicros;
+        };
+
+        ClientState* findClient(uint32_t clientId);
+        const ClientState* findClient(uint32_t clientId) const;
+
+        bool buildPatch(JsonObject state, JsonArray lightedObjects, String& patch);
+        void sendPending(const String& patch);
+        bool sendResync(AsyncWebSocketClient* client, size_t& numBytes);
+        void requestResyncAll();
+
+        static void countMessage(MessageStatistics& statistics, size_t numBytes, uint32_t micros);
+
+    private:
+        ClientState             mClients[MAX_CLIENTS];
+        uint32_t                mSequence;
+        volatile bool           mBroadcastPending;
+
+        // Hashes of what the delta clients were last sent
+        bool                    mHashesValid;
+        uint32_t                mDiffGeneration;    // JsonResponseCache generation of the last diff
+        ValueHash               mStateHashes[MAX_STATE_VALUES];
+        uint8_t                 mNumStateHashes;
+        std::vector<uint32_t>   mObjectHashes;
+
+        // Statistics
+        MessageStatistics       mFullStatistics;
+        MessageStatistics       mDeltaStatistics;
+        MessageStatistics       mResyncStatistics;
+};
+
+#endif